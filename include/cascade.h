@@ -66,7 +66,14 @@ class Cascade : public std::iostream {
     Cascade& set_open_loop_target(size_t n);
     Cascade& set_quartus_server(const std::string& host, size_t port);
     Cascade& set_vivado_server(const std::string& host, size_t port, size_t fpga);
+    Cascade& set_verilator_threads(size_t n);
+    Cascade& set_verilator_bursts(bool enable);
     Cascade& set_profile_interval(size_t n);
+    Cascade& set_enable_text_checkpoints(bool enable);
+    Cascade& set_checkpoint_interval(size_t n);
+    Cascade& set_checkpoint_path(const std::string& path);
+    Cascade& set_partition_locs(const std::string& locs);
+    Cascade& set_partition_interval(size_t n);
     Cascade& set_stdin(std::streambuf* sb);
     Cascade& set_stdout(std::streambuf* sb);
     Cascade& set_stderr(std::streambuf* sb);
@@ -85,6 +92,13 @@ class Cascade : public std::iostream {
     Cascade& wait_for_stop();
     Cascade& stop_now();
 
+    // Migration Methods:
+    //
+    // Moves every logic module to a new location (a path or host:port of a
+    // running cascade_slave, or local) without stopping the simulation.
+    // This method returns immediately; the move completes in the background.
+    Cascade& migrate(const std::string& loc);
+
     // Execution State:
     bool is_running() const;
     bool is_finished() const;
@@ -31,7 +31,9 @@
 #ifndef INCLUDE_CASCADE_CASCADE_SLAVE_H
 #define INCLUDE_CASCADE_CASCADE_SLAVE_H
 
+#include <mutex>
 #include <string>
+#include "common/bits.h"
 #include "target/compiler/remote_compiler.h"
 
 namespace cascade {
@@ -56,6 +58,8 @@ class CascadeSlave {
     CascadeSlave& set_listeners(const std::string& path, size_t port);
     CascadeSlave& set_quartus_server(const std::string& host, size_t port);
     CascadeSlave& set_vivado_server(const std::string& host, size_t port, size_t fpga);
+    CascadeSlave& set_num_workers(size_t n);
+    CascadeSlave& set_num_dispatchers(size_t n);
 
     // Start/Stop Methods:
     CascadeSlave& run();
@@ -63,7 +67,20 @@ class CascadeSlave {
     CascadeSlave& wait_for_stop();
     CascadeSlave& stop_now();
 
+    // Statistics Methods:
+    //
+    // Returns counters describing how quickly remote engines were brought up.
+    // This method is thread safe and may be called while the slave is running.
+    RemoteCompiler::Stats get_stats();
+
   private:
+    // Software Leds:
+    //
+    // Leds which are compiled for the sw target write their values here. This
+    // is declared first so that it outlives any leds that refer to it.
+    Bits led_;
+    std::mutex led_lock_;
+
     RemoteCompiler remote_compiler_;
 };
 
@@ -0,0 +1,11 @@
+`ifndef __SHARE_CASCADE_MARCH_REGRESSION_CONCURRENT_AVALON32_V
+`define __SHARE_CASCADE_MARCH_REGRESSION_CONCURRENT_AVALON32_V
+
+`include "share/cascade/stdlib/stdlib.v"
+
+(*__target="sw;avalon32", __loc="local;/tmp/fpga_socket", __delay=1, __state_safe_int*)
+Root root();
+
+Clock clock();
+
+`endif
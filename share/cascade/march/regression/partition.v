@@ -0,0 +1,11 @@
+`ifndef __SHARE_CASCADE_MARCH_REGRESSION_PARTITION_V
+`define __SHARE_CASCADE_MARCH_REGRESSION_PARTITION_V
+
+`include "share/cascade/stdlib/stdlib.v"
+
+(*__loc="/tmp/fpga_socket", __no_inline="true"*)
+Root root();
+
+Clock clock();
+
+`endif
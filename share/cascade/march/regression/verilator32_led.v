@@ -0,0 +1,14 @@
+`ifndef __SHARE_CASCADE_MARCH_REGRESSION_VERILATOR32_LED_V
+`define __SHARE_CASCADE_MARCH_REGRESSION_VERILATOR32_LED_V
+
+`include "share/cascade/stdlib/stdlib.v"
+
+(*__target="sw;verilator32"*)
+Root root();
+
+Clock clock();
+
+(*__loc="/tmp/fpga_socket"*)
+Led#(8) led();
+
+`endif
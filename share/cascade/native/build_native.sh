@@ -0,0 +1,28 @@
+#!/bin/sh
+
+# $1 = build directory, containing program_logic.v and program_logic.inc
+# $2 = cxx compiler path
+
+# Check whether cxx compiler maps to clang or g++
+$2 --version | grep clang 
+if [ $? -eq 0 ] ; then
+  VER_INSTALL=/usr/local/share/verilator/
+  ARGS="-fbracket-depth=4096 -Qunused-arguments"
+else 
+  VER_INSTALL=/usr/share/verilator/
+  ARGS="-ftemplate-depth=4096 -fconstexpr-depth=4096"
+fi
+
+# Share the machine with any other builds that are running
+. ../verilator/jobs.sh
+
+# Objects which can be reused between builds are keyed on the compiler and the
+# verilator version. Native models are always single-threaded, so they share
+# a cache with single-threaded verilator builds.
+CACHE=/tmp/verilator/cache/`($2 --version; verilator --version; echo 1) | cksum | cut -d' ' -f1`
+
+# Invoke verilator: Every signal is made public so that the harness can read and write it directly
+verilator -Mdir $1 --prefix Vprogram_logic -Wno-lint -Wno-fatal -cc -O3 --x-assign fast --x-initial fast --noassert --public-flat-rw --output-split 20000 $1/program_logic.v || exit 1
+
+# Compile the model, the harness (which wraps the model in extern "C" functions), and wrap everything up in a dll
+make $MAKE_JOBS -f ../verilator/build.mk DIR=$1 LIB=libnative.so CXX=$2 VER_INSTALL=$VER_INSTALL ARGS="$ARGS" CACHE=$CACHE HARNESS=harness.cpp THREADS=1
@@ -0,0 +1,102 @@
+#include "verilated.h"
+#include "Vprogram_logic.h"
+
+// Signals which aren't ports live in the root module of verilator's model.
+// Newer versions of verilator moved the root module out of the top-level
+// class.
+#if defined(VERILATOR_VERSION_INTEGER) && (VERILATOR_VERSION_INTEGER >= 4210000)
+#include "Vprogram_logic___024root.h"
+#define ROOT (pl_->rootp)
+#else
+#define ROOT (pl_)
+#endif
+
+using namespace std;
+
+namespace {
+
+Vprogram_logic* pl_;
+
+// Generated accessors: Defines NATIVE_TASKS (the width of the task mask),
+// NATIVE_CLOCK (the name of the open loop clock, if there is one), and the
+// read_var(), write_var(), and read_put() methods.
+#include "program_logic.inc"
+
+bool any_tasks() {
+#if NATIVE_TASKS == 0
+  return false;
+#else
+  return ROOT->program_logic__DOT__ntasks != 0;
+#endif
+}
+
+} // namespace
+
+extern "C" void native_init() {
+  pl_ = new Vprogram_logic();
+  // Evaluate once so that initial blocks don't run after the runtime has
+  // had a chance to set this module's state.
+  pl_->eval();
+}
+
+extern "C" void native_final() {
+  pl_->final();
+  delete pl_;
+}
+
+extern "C" void native_read(size_t v, size_t e, uint32_t* w) {
+  read_var(v, e, w);
+}
+
+extern "C" void native_write(size_t v, size_t e, const uint32_t* w) {
+  write_var(v, e, w);
+}
+
+extern "C" void native_put(size_t t, size_t e, uint32_t* w) {
+  read_put(t, e, w);
+}
+
+extern "C" bool native_eval() {
+  pl_->eval();
+  return any_tasks();
+}
+
+extern "C" size_t native_tasks() {
+#if NATIVE_TASKS == 0
+  return 0;
+#else
+  // Returns the number of tasks which fired and resets the log. Entries are
+  // left in place until the next call, so they can still be read back.
+  const size_t n = ROOT->program_logic__DOT__ntasks;
+  ROOT->program_logic__DOT__ntasks = 0;
+  return n;
+#endif
+}
+
+extern "C" size_t native_task(size_t e) {
+#if NATIVE_TASKS == 0
+  (void) e;
+  return 0;
+#else
+  return ROOT->program_logic__DOT__tasks[e];
+#endif
+}
+
+extern "C" size_t native_open_loop(bool val, size_t itr) {
+#ifdef NATIVE_CLOCK
+  pl_->NATIVE_CLOCK = val;
+  for (size_t i = 0; i < itr; ) {
+    pl_->NATIVE_CLOCK = !pl_->NATIVE_CLOCK;
+    pl_->eval();
+    ++i;
+    if (any_tasks()) {
+      return i;
+    }
+  }
+  return itr;
+#else
+  (void) val;
+  (void) itr;
+  return 0;
+#endif
+}
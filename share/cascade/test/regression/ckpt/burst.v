@@ -0,0 +1,21 @@
+// A memory which is filled in software and then checked, one word per tick,
+// once this module has moved to a hardware backend. Every word that's checked
+// is also inverted. The contents move to hardware by set_state(), and back by
+// the $save() in burst_save.v. Both programs declare this first so that it's
+// assigned the same ids in each.
+reg[31:0] mem[255:0];
+reg[8:0] FILL = 0;
+reg[8:0] CHECK = 0;
+reg OK = 1;
+always @(posedge clock.val) begin
+  if (FILL != 256) begin
+    mem[FILL] <= {FILL[7:0], ~FILL[7:0], FILL[7:0], ~FILL[7:0]};
+    FILL <= FILL + 1;
+  end else if (($target() != "sw") && (CHECK != 256)) begin
+    if (mem[CHECK] != {CHECK[7:0], ~CHECK[7:0], CHECK[7:0], ~CHECK[7:0]}) begin
+      OK <= 0;
+    end
+    mem[CHECK] <= ~mem[CHECK];
+    CHECK <= CHECK + 1;
+  end
+end
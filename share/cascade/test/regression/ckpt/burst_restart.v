@@ -0,0 +1,21 @@
+`include "share/cascade/test/regression/ckpt/burst.v"
+
+initial $restart("/tmp/cascade_burst.ckpt");
+
+// Prints 1 if every word of memory was restored in its inverted form.
+reg[31:0] TICKS = 0;
+reg[8:0] I = 0;
+reg RESTORED = 1;
+always @(posedge clock.val) begin
+  TICKS <= TICKS + 1;
+  if ((TICKS >= 10) && (I != 256)) begin
+    if (mem[I] != ~{I[7:0], ~I[7:0], I[7:0], ~I[7:0]}) begin
+      RESTORED <= 0;
+    end
+    I <= I + 1;
+  end
+  if (I == 256) begin
+    $write("%d", OK && RESTORED && (CHECK == 256));
+    $finish;
+  end
+end
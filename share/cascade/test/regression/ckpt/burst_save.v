@@ -0,0 +1,11 @@
+`include "share/cascade/test/regression/ckpt/burst.v"
+
+// Prints 1 if hardware received the memory intact, and saves what it left
+// behind for burst_restart.v.
+always @(posedge clock.val) begin
+  if (CHECK == 256) begin
+    $write("%d", OK);
+    $save("/tmp/cascade_burst.ckpt");
+    $finish;
+  end
+end
@@ -0,0 +1,6 @@
+// A counter which is saved by count_save.v and restored by count_restart.v.
+// Both programs declare it first so that it's assigned the same id in each.
+reg[31:0] a = 0;
+always @(posedge clock.val) begin
+  a <= a + 1;
+end
@@ -0,0 +1,13 @@
+`include "share/cascade/test/regression/ckpt/count.v"
+
+initial $restart("/tmp/cascade_count.ckpt");
+
+// The counter only passes 1000 if it was restored from the save file
+reg[31:0] TICKS = 0;
+always @(posedge clock.val) begin
+  TICKS <= TICKS + 1;
+  if (TICKS == 10) begin
+    $write("%d", a > 1000);
+    $finish;
+  end
+end
@@ -0,0 +1,8 @@
+`include "share/cascade/test/regression/ckpt/count.v"
+
+always @(posedge clock.val) begin
+  if (a == 1000) begin
+    $save("/tmp/cascade_count.ckpt");
+    $finish;
+  end
+end
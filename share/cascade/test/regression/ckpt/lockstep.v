@@ -0,0 +1,15 @@
+// Two registers which must agree at all times. a changes on every tick, but b
+// only changes once every 4096 ticks, so an incremental checkpoint which
+// misses a change to b is restored in an inconsistent state.
+reg[31:0] a = 0;
+reg[31:0] b = 0;
+always @(posedge clock.val) begin
+  a <= a + 1;
+  if (a[11:0] == 12'hfff) begin
+    b <= a + 1;
+  end
+  if (b != {a[31:12], 12'h000}) begin
+    $write("inconsistent");
+    $finish;
+  end
+end
@@ -0,0 +1,9 @@
+// Runs lockstep.v for a fixed amount of logical time. A test which waits on
+// events from this program is guaranteed to return once it finishes.
+`include "share/cascade/test/regression/ckpt/lockstep.v"
+
+always @(posedge clock.val) begin
+  if (a == 67108864) begin
+    $finish;
+  end
+end
@@ -0,0 +1,14 @@
+// Restores lockstep.v from the checkpoint chain that it left behind, and runs
+// for a while longer. Prints 1 if the program resumed from where it stopped.
+`include "share/cascade/test/regression/ckpt/lockstep.v"
+
+initial $restart("/tmp/cascade_lockstep.ckpt");
+
+reg[31:0] TICKS = 0;
+always @(posedge clock.val) begin
+  TICKS <= TICKS + 1;
+  if (TICKS == 10000) begin
+    $write("%d", a > 10000);
+    $finish;
+  end
+end
@@ -0,0 +1,38 @@
+// Idles in software until this module is moved to a hardware backend. go is
+// raised on a falling edge so that the rest of the program starts on the next
+// rising edge, exactly as it would from the beginning of a simulation.
+reg go = 0;
+reg[31:0] IDLE = 0;
+always @(negedge clock.val) begin
+  if ($target() != "sw") begin
+    go <= 1;
+  end else if (IDLE == 32'hffffffff) begin
+    $write("timeout");
+    $finish;
+  end else begin
+    IDLE <= IDLE + 1;
+  end
+end
+
+// An implied latch. q depends on d, which doesn't appear in the trigger list,
+// so q only samples d when en changes.
+reg[31:0] d = 0;
+reg en = 0;
+reg[31:0] q;
+always @(en) begin
+  if (en)
+    q = d;
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  if (go) begin
+    COUNT <= COUNT + 1;
+    d <= d + 1;
+    en <= (COUNT[3:0] == 4'h7);
+    if (COUNT == 99) begin
+      $write("%d", q);
+      $finish;
+    end
+  end
+end
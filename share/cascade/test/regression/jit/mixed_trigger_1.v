@@ -0,0 +1,37 @@
+// Idles in software until this module is moved to a hardware backend. go is
+// raised on a falling edge so that the rest of the program starts on the next
+// rising edge, exactly as it would from the beginning of a simulation.
+reg go = 0;
+reg[31:0] IDLE = 0;
+always @(negedge clock.val) begin
+  if ($target() != "sw") begin
+    go <= 1;
+  end else if (IDLE == 32'hffffffff) begin
+    $write("timeout");
+    $finish;
+  end else begin
+    IDLE <= IDLE + 1;
+  end
+end
+
+// A block which is sensitive to both an edge and a level. x changes on every
+// rising edge, so sum advances twice per clock.
+reg[7:0] x = 0;
+reg[31:0] sum = 0;
+always @(negedge clock.val or x) begin
+  if (go) begin
+    sum <= sum + 1;
+  end
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  if (go) begin
+    x <= x + 1;
+    COUNT <= COUNT + 1;
+    if (COUNT == 99999) begin
+      $write("%d", sum);
+      $finish;
+    end
+  end
+end
@@ -0,0 +1,40 @@
+// Idles in software until this module is moved to a hardware backend. go is
+// raised on a falling edge so that the rest of the program starts on the next
+// rising edge, exactly as it would from the beginning of a simulation.
+reg go = 0;
+reg[31:0] IDLE = 0;
+always @(negedge clock.val) begin
+  if ($target() != "sw") begin
+    go <= 1;
+  end else if (IDLE == 32'hffffffff) begin
+    $write("timeout");
+    $finish;
+  end else begin
+    IDLE <= IDLE + 1;
+  end
+end
+
+// A divided clock drives a second counter, which advances once for every
+// two ticks of the main clock.
+reg div = 0;
+always @(posedge clock.val) begin
+  if (go) begin
+    div <= ~div;
+  end
+end
+
+reg[31:0] slow = 0;
+always @(posedge div) begin
+  slow <= slow + 1;
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  if (go) begin
+    COUNT <= COUNT + 1;
+    if (COUNT == 99999) begin
+      $write("%d", slow);
+      $finish;
+    end
+  end
+end
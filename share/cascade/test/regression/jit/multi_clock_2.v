@@ -0,0 +1,39 @@
+// Idles in software until this module is moved to a hardware backend. go is
+// raised on a falling edge so that the rest of the program starts on the next
+// rising edge, exactly as it would from the beginning of a simulation.
+reg go = 0;
+reg[31:0] IDLE = 0;
+always @(negedge clock.val) begin
+  if ($target() != "sw") begin
+    go <= 1;
+  end else if (IDLE == 32'hffffffff) begin
+    $write("timeout");
+    $finish;
+  end else begin
+    IDLE <= IDLE + 1;
+  end
+end
+
+// An asynchronous active-low reset, which is pulsed once every sixteen ticks
+// of the main clock.
+reg[31:0] COUNT = 0;
+reg rst = 1;
+reg[31:0] cnt = 0;
+
+always @(posedge clock.val or negedge rst) begin
+  if (!rst)
+    cnt <= 0;
+  else if (go)
+    cnt <= cnt + 1;
+end
+
+always @(posedge clock.val) begin
+  if (go) begin
+    COUNT <= COUNT + 1;
+    rst <= (COUNT[3:0] != 4'hf);
+    if (COUNT == 99999) begin
+      $write("%d", cnt);
+      $finish;
+    end
+  end
+end
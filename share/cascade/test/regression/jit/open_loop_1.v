@@ -0,0 +1,31 @@
+// Idles in software until this module is moved to a hardware backend. go is
+// raised on a falling edge so that the rest of the program starts on the next
+// rising edge, exactly as it would from the beginning of a simulation.
+reg go = 0;
+reg[31:0] IDLE = 0;
+always @(negedge clock.val) begin
+  if ($target() != "sw") begin
+    go <= 1;
+  end else if (IDLE == 32'hffffffff) begin
+    $write("timeout");
+    $finish;
+  end else begin
+    IDLE <= IDLE + 1;
+  end
+end
+
+// A counter which drives the leds. Once this module is moved to a hardware
+// backend it runs in open loop, and the leds change on every iteration. Those
+// changes shouldn't stop the loop.
+reg[31:0] COUNT = 0;
+assign led.val = COUNT[7:0];
+
+always @(posedge clock.val) begin
+  if (go) begin
+    COUNT <= COUNT + 1;
+    if (COUNT == 999999) begin
+      $write("%d", COUNT);
+      $finish;
+    end
+  end
+end
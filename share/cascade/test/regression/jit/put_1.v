@@ -0,0 +1,22 @@
+// Idles in software until this module is moved to a hardware backend, and
+// only then writes on every tick of the clock. Values are written before the
+// non-blocking updates which follow them take effect.
+reg[31:0] IDLE = 0;
+reg[31:0] COUNT = 0;
+reg[3:0] digit = 0;
+always @(posedge clock.val) begin
+  if ($target() == "sw") begin
+    IDLE <= IDLE + 1;
+    if (IDLE == 32'hffffffff) begin
+      $write("timeout");
+      $finish;
+    end
+  end else begin
+    COUNT <= COUNT + 1;
+    digit <= (digit == 9) ? 0 : (digit + 1);
+    $write("%d", digit);
+    if (COUNT == 99) begin
+      $finish;
+    end
+  end
+end
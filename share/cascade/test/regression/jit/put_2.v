@@ -0,0 +1,29 @@
+// Idles in software until this module is moved to a hardware backend, and
+// only then writes on every tick of the clock. Each tick fires the same two
+// writes several times, in an order which differs from the order in which
+// they appear in the source. The loop bound isn't constant, so the loop can't
+// be unrolled before it reaches the backend.
+reg[31:0] IDLE = 0;
+reg[31:0] COUNT = 0;
+integer i;
+always @(posedge clock.val) begin
+  if ($target() == "sw") begin
+    IDLE <= IDLE + 1;
+    if (IDLE == 32'hffffffff) begin
+      $write("timeout");
+      $finish;
+    end
+  end else begin
+    COUNT <= COUNT + 1;
+    for (i = 0; i <= COUNT; i = i+1) begin
+      if (i == COUNT) begin
+        $write("|");
+      end else begin
+        $write("%d", i);
+      end
+    end
+    if (COUNT == 4) begin
+      $finish;
+    end
+  end
+end
@@ -0,0 +1,53 @@
+// Two pairs of modules which talk to each other on every tick. Each pair
+// starts out split between localhost:8801 and the location of the root
+// module, so that all of the traffic crosses between them. Repartitioning
+// should move at least one module to bring a pair together.
+module Producer(clk, out);
+  input wire clk;
+  output wire[31:0] out;
+
+  reg[31:0] count = 0;
+  assign out = count;
+  always @(posedge clk) begin
+    count <= count + 1;
+  end
+endmodule
+
+module Consumer(clk, in, done, result);
+  input wire clk;
+  input wire[31:0] in;
+  output reg done;
+  output reg[63:0] result;
+
+  reg[31:0] count = 0;
+  reg[63:0] sum = 0;
+  always @(posedge clk) begin
+    count <= count + 1;
+    sum <= sum + in;
+    if (count == 200000) begin
+      done <= 1;
+      result <= sum;
+    end
+  end
+endmodule
+
+wire[31:0] a;
+wire[31:0] b;
+wire done_a;
+wire done_b;
+wire[63:0] result_a;
+wire[63:0] result_b;
+
+Producer pa(clock.val, a);
+(*__loc="localhost:8801"*)
+Consumer ca(clock.val, a, done_a, result_a);
+(*__loc="localhost:8801"*)
+Producer pb(clock.val, b);
+Consumer cb(clock.val, b, done_b, result_b);
+
+always @(posedge clock.val) begin
+  if (done_a && done_b) begin
+    $write("%d %d", result_a, result_b);
+    $finish;
+  end
+end
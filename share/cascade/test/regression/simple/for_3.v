@@ -0,0 +1,17 @@
+reg[31:0] mem[1023:0];
+integer i = 0;
+integer j = 0;
+integer sum = 0;
+
+initial begin
+  for (i = 0; i < 1024; i = i+1) begin
+    mem[i] = i;
+  end
+  for (i = 0; i < 32; i = i+1) begin
+    for (j = 0; j < 32; j = j+1) begin
+      sum = sum + mem[32*i+j];
+    end
+  end
+  $write(sum);
+  $finish;
+end
@@ -0,0 +1,20 @@
+// An implied latch. q depends on d, which doesn't appear in the trigger list,
+// so q only samples d when en changes.
+reg[31:0] d = 0;
+reg en = 0;
+reg[31:0] q;
+always @(en) begin
+  if (en)
+    q = d;
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  d <= d + 1;
+  en <= (COUNT[3:0] == 4'h7);
+  if (COUNT == 99) begin
+    $write("%d", q);
+    $finish;
+  end
+end
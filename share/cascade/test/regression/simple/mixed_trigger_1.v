@@ -0,0 +1,17 @@
+// A block which is sensitive to both an edge and a level. x changes on every
+// rising edge, so sum advances twice per clock.
+reg[7:0] x = 0;
+reg[31:0] sum = 0;
+always @(negedge clock.val or x) begin
+  sum <= sum + 1;
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  x <= x + 1;
+  COUNT <= COUNT + 1;
+  if (COUNT == 99999) begin
+    $write("%d", sum);
+    $finish;
+  end
+end
@@ -0,0 +1,20 @@
+// A divided clock drives a second counter, which advances once for every
+// two ticks of the main clock.
+reg div = 0;
+always @(posedge clock.val) begin
+  div <= ~div;
+end
+
+reg[31:0] slow = 0;
+always @(posedge div) begin
+  slow <= slow + 1;
+end
+
+reg[31:0] COUNT = 0;
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  if (COUNT == 99999) begin
+    $write("%d", slow);
+    $finish;
+  end
+end
@@ -0,0 +1,21 @@
+// An asynchronous active-low reset, which is pulsed once every sixteen ticks
+// of the main clock.
+reg[31:0] COUNT = 0;
+reg rst = 1;
+reg[31:0] cnt = 0;
+
+always @(posedge clock.val or negedge rst) begin
+  if (!rst)
+    cnt <= 0;
+  else
+    cnt <= cnt + 1;
+end
+
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  rst <= (COUNT[3:0] != 4'hf);
+  if (COUNT == 99999) begin
+    $write("%d", cnt);
+    $finish;
+  end
+end
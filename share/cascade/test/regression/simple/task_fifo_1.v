@@ -0,0 +1,13 @@
+// Writes on every tick of the clock. On avmm backends, these writes are
+// logged to the task fifo, which fills and drains several times before the
+// program finishes.
+reg[31:0] COUNT = 0;
+reg[3:0] digit = 0;
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  digit <= (digit == 9) ? 0 : (digit + 1);
+  $write("%d", digit);
+  if (COUNT == 99) begin
+    $finish;
+  end
+end
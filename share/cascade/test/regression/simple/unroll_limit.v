@@ -0,0 +1,27 @@
+integer i;
+integer j;
+integer n = 0;
+integer sum = 0;
+
+initial begin
+  // This loop is just short enough to be unrolled in software
+  for (i = 0; i < 256; i = i+1) begin
+    sum = sum + 1;
+  end
+  // These loops are too long and should be left in place
+  for (i = 0; i < 257; i = i+1) begin
+    sum = sum + 1;
+  end
+  for (i = 0; i < 16; i = i+1) begin
+    for (j = 0; j < 17; j = j+1) begin
+      sum = sum + i;
+    end
+  end
+  repeat (300) n = n + 1;
+  while (n < 1000) n = n + 1;
+
+  $write(sum);
+  $write(":");
+  $write(n);
+  $finish;
+end
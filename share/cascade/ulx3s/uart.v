@@ -7,7 +7,8 @@
 module Uart#(
   parameter DIVIDER = 25000000/115200,
   parameter RSIZE = 4, 
-  parameter WSIZE = 4  
+  parameter WSIZE = 4,
+  parameter RLOG = 8
 )(
   input wire clk,
 
@@ -32,6 +33,19 @@ module Uart#(
     .valid(rx_valid)
   );
 
+  // Receive fifo: Bytes which arrive during the write phase are buffered
+  // rather than dropped, which allows the host to pipeline requests.
+  reg[7:0] fifo[(1<<RLOG)-1:0];
+  reg[RLOG-1:0] fifo_head = 0;
+  reg[RLOG-1:0] fifo_tail = 0;
+  wire fifo_empty = (fifo_head == fifo_tail);
+  always @(posedge clk) begin
+    if (rx_valid) begin
+      fifo[fifo_tail] <= rx_data;
+      fifo_tail <= fifo_tail + 1;
+    end
+  end
+
   reg[7:0] tx_data = 0;
   reg tx_enable = 0;
   wire tx_ready;
@@ -51,9 +65,10 @@ module Uart#(
 
     // Read phase
     if (state < RSIZE) begin
-      if (rx_valid) begin
+      if (!fifo_empty) begin
         state <= state + 1;
-        rdata[8*state+:8] <= rx_data;
+        rdata[8*state+:8] <= fifo[fifo_head];
+        fifo_head <= fifo_head + 1;
       end
     end
 
@@ -0,0 +1,62 @@
+# Builds a verilated model and the harness which wraps it into a shared
+# library. This file is invoked by build_verilator_*.sh and build_native.sh,
+# which set the following variables:
+#
+# DIR         = directory containing the output of verilator
+# LIB         = name of the shared library (optional, defaults to libverilator.so)
+# CXX         = cxx compiler path
+# VER_INSTALL = verilator install directory
+# ARGS        = compiler-specific arguments
+# CACHE       = directory for objects which are shared between builds
+# HARNESS     = harness source file
+# THREADS     = number of threads used by the model
+#
+# Objects which don't depend on the program being compiled (verilator's
+# runtime and a precompiled header for verilated.h) are built once into CACHE
+# and reused by every subsequent build.
+
+FLAGS = -I$(VER_INSTALL)/include -I$(VER_INSTALL)/include/vltstd -DVL_PRINTF=printf -DVM_COVERAGE=0 -DVM_SC=0 -DVM_TRACE=0 -faligned-new $(ARGS) -Wno-parentheses-equality -Wno-sign-compare -Wno-uninitialized -Wno-unused-parameter -Wno-unused-variable -Wno-shadow -O3 -fno-stack-protector -DNDEBUG -flto -DVL_INLINE_OPT=inline
+HARNESS_FLAGS = --std=c++17 -fno-stack-protector -DNDEBUG -flto
+RUNTIME = $(CACHE)/verilated.o
+LIBS =
+LIB ?= libverilator.so
+
+ifneq ($(THREADS),1)
+  FLAGS += -DVL_THREADED=1 -pthread
+  HARNESS_FLAGS += -DVL_THREADED=1 -pthread
+  RUNTIME += $(CACHE)/verilated_threads.o
+  LIBS += -pthread
+endif
+
+# Clang only uses precompiled headers when asked to. Gcc only uses them for
+# the first header in a translation unit, and verilator's sources begin with
+# their own headers, so verilated.h is forced in ahead of them. Gcc finds the
+# precompiled version in the first include directory which contains one.
+ifneq ($(findstring clang,$(shell $(CXX) --version)),)
+  PCH = $(CACHE)/verilated.h.pch
+  USE_PCH = -include-pch $(PCH)
+else
+  PCH = $(CACHE)/verilated.h.gch
+  USE_PCH = -I$(CACHE) -include verilated.h
+endif
+
+MODEL = $(patsubst %.cpp,%.o,$(wildcard $(DIR)/Vprogram_logic*.cpp))
+
+$(DIR)/$(LIB): $(DIR)/harness.o $(MODEL) $(RUNTIME)
+	$(CXX) -fPIC -shared -flto $(LIBS) -o $@ $^
+
+$(DIR)/harness.o: $(HARNESS)
+	$(CXX) $(HARNESS_FLAGS) -I$(VER_INSTALL)/include/ -I$(DIR) -c -o $@ $<
+
+$(DIR)/%.o: $(DIR)/%.cpp $(PCH)
+	$(CXX) $(USE_PCH) $(FLAGS) -c -o $@ $<
+
+# Shared objects are built under a temporary name and moved into place, since
+# concurrent builds may be racing to create them.
+$(CACHE)/%.o: $(VER_INSTALL)/include/%.cpp
+	@mkdir -p $(CACHE)
+	$(CXX) $(FLAGS) -c -o $@.$$$$ $< && mv $@.$$$$ $@
+
+$(PCH): 
+	@mkdir -p $(CACHE)
+	$(CXX) $(FLAGS) -x c++-header -o $@.$$$$ $(VER_INSTALL)/include/verilated.h && mv $@.$$$$ $@
@@ -1,6 +0,0 @@
-#include "Vprogram_logic.h"
-#include "verilated.h"
-
-int main() {
-  return 0;
-}
@@ -4,78 +4,87 @@
 using namespace std;
 
 namespace {
-  
-enum Request {
-  READY = 0,
-  READ,
-  WRITE,
-  WAIT,
-  DONE_1,
-  DONE_2
-};
 
 Vprogram_logic* pl_;
-bool running_;
-Request req_;
-uint32_t addr_;
-uint64_t val_;
+
+// Advances the model by one full clock cycle. The clock is held low between
+// calls so that the next rising edge takes place on the next call to tick().
+void tick() {
+  pl_->clk = 1;
+  pl_->eval();
+  pl_->clk = 0;
+  pl_->eval();
+}
+
+// Drives an Avalon transaction to completion from the calling thread. The
+// request is held until the slave lowers waitrequest, and then released for
+// one additional cycle so that the slave can observe the falling edge before
+// the next request.
+void transact() {
+  pl_->eval();
+  while (pl_->s0_waitrequest) {
+    tick();
+  }
+}
+
+void release() {
+  pl_->s0_read = 0;
+  pl_->s0_write = 0;
+  tick();
+}
 
 } // namespace
 
 extern "C" void verilator_init() {
   pl_ = new Vprogram_logic();
-  req_ = READY;
+  pl_->clk = 0;
+  pl_->s0_read = 0;
+  pl_->s0_write = 0;
+  pl_->eval();
 }
 
-extern "C" void verilator_start() {
-  for (running_ = true; running_; ) {
-    switch (req_) {
-      case READY:
-        break;
-      case READ:
-        pl_->s0_address = addr_;
-        pl_->s0_read = 1;
-        req_ = WAIT;
-        break;
-      case WRITE:
-        pl_->s0_address = addr_;
-        pl_->s0_writedata = val_;
-        pl_->s0_write = 1;
-        req_ = WAIT;
-        break;
-      case WAIT:
-        if (!pl_->s0_waitrequest) {
-          pl_->s0_read = 0;
-          pl_->s0_write = 0;
-          req_ = DONE_1;
-        }
-        break;
-      case DONE_1:
-        req_ = DONE_2;
-        break;
-      case DONE_2:
-        req_ = READY;
-        break;
-    }
-    pl_->eval();
-    pl_->clk = !pl_->clk;
-  }
+extern "C" void verilator_stop() {
   pl_->final();
   delete pl_;
 }
 
-extern "C" void verilator_stop() {
-  running_ = false;
-}
-
 extern "C" void verilator_write(uint32_t addr, uint64_t val) {
-  addr_ = addr;
-  val_ = val;
-  for (req_ = WRITE; req_ != READY;);
+  pl_->s0_address = addr;
+  pl_->s0_writedata = val;
+  pl_->s0_write = 1;
+  transact();
+  release();
 }
 
 extern "C" uint64_t verilator_read(uint32_t addr) {
-  addr_ = addr;
-  for (req_ = READ; req_ != READY;);
-  return pl_->s0_readdata;
+  pl_->s0_address = addr;
+  pl_->s0_read = 1;
+  transact();
+  const uint64_t res = pl_->s0_readdata;
+  release();
+  return res;
+}
+
+// Bursts hold the request for their entire length and present each address
+// as soon as the slave lowers waitrequest for the one before it. The slave
+// treats a change of address as a new request, so the bus is only released
+// once, at the end of the burst, rather than after every word.
+extern "C" void verilator_write_burst(uint32_t addr, const uint64_t* vals, size_t n) {
+  pl_->s0_write = 1;
+  for (size_t i = 0; i < n; ++i) {
+    pl_->s0_address = addr+i;
+    pl_->s0_writedata = vals[i];
+    transact();
+  }
+  release();
+}
+
+extern "C" void verilator_read_burst(uint32_t addr, uint64_t* vals, size_t n) {
+  pl_->s0_read = 1;
+  for (size_t i = 0; i < n; ++i) {
+    pl_->s0_address = addr+i;
+    transact();
+    vals[i] = pl_->s0_readdata;
+  }
+  release();
 }
@@ -0,0 +1,36 @@
+# Computes a share of the machine for a build, and stores the flags which
+# make needs to stay within it in MAKE_JOBS. This file is sourced by the
+# build_*.sh scripts.
+#
+# Builds run concurrently with each other and with the runtime, which keeps
+# running while we build. Every build registers itself in BUILDS for as long
+# as it runs, and takes an equal share of the cores which remain after leaving
+# one free for the runtime. Tokens left behind by builds which were killed
+# are pruned here. Builds which start later take smaller shares, and make's
+# load limit keeps earlier builds from oversubscribing the machine while they
+# overlap.
+
+BUILDS=/tmp/cascade/builds
+mkdir -p $BUILDS
+touch $BUILDS/$$
+trap "rm -f $BUILDS/$$" EXIT
+
+CORES=$((`getconf _NPROCESSORS_ONLN` - 1))
+if [ $CORES -lt 1 ] ; then
+  CORES=1
+fi
+
+ACTIVE=0
+for TOKEN in $BUILDS/* ; do
+  if kill -0 `basename $TOKEN` 2> /dev/null ; then
+    ACTIVE=$((ACTIVE + 1))
+  else
+    rm -f $TOKEN
+  fi
+done
+
+JOBS=$((CORES / ACTIVE))
+if [ $JOBS -lt 1 ] ; then
+  JOBS=1
+fi
+MAKE_JOBS="-j$JOBS -l$CORES"
@@ -36,6 +36,7 @@
 #include "target/core/avmm/de10/de10_compiler.h"
 #include "target/core/aos/amorphos/amorphos_compiler.h"
 #include "target/core/aos/f1/f1_compiler.h"
+#include "target/core/native/native_compiler.h"
 #include "target/core/avmm/ulx3s/ulx3s_compiler.h"
 #include "target/core/avmm/verilator/verilator_compiler.h"
 #include "target/core/sw/sw_compiler.h"
@@ -55,6 +56,7 @@ Cascade::Cascade() : eval_(this), iostream(&sb_), sb_() {
   runtime_.get_compiler()->set("de10", new avmm::De10Compiler());
   runtime_.get_compiler()->set("amorphos", new aos::AmorphosCompiler());
   runtime_.get_compiler()->set("f1", new aos::F1Compiler());
+  runtime_.get_compiler()->set("native", new native::NativeCompiler());
   runtime_.get_compiler()->set("proxy", new proxy::ProxyCompiler());
   runtime_.get_compiler()->set("sw", new sw::SwCompiler());
   runtime_.get_compiler()->set("ulx3s32", new avmm::Ulx3s32Compiler());
@@ -115,12 +117,68 @@ Cascade& Cascade::set_vivado_server(const string& host, size_t port, size_t fpga
   return *this;
 }
 
+Cascade& Cascade::set_verilator_threads(size_t n) {
+  assert(!is_running_);
+  auto* vc32 = runtime_.get_compiler()->get("verilator32");
+  assert(vc32 != nullptr);
+  static_cast<avmm::Verilator32Compiler*>(vc32)->set_threads(n);
+  #if __x86_64__ || __ppc64__
+  auto* vc64 = runtime_.get_compiler()->get("verilator64");
+  assert(vc64 != nullptr);
+  static_cast<avmm::Verilator64Compiler*>(vc64)->set_threads(n);
+  #endif
+  return *this;
+}
+
+Cascade& Cascade::set_verilator_bursts(bool enable) {
+  assert(!is_running_);
+  auto* vc32 = runtime_.get_compiler()->get("verilator32");
+  assert(vc32 != nullptr);
+  static_cast<avmm::Verilator32Compiler*>(vc32)->set_bursts(enable);
+  #if __x86_64__ || __ppc64__
+  auto* vc64 = runtime_.get_compiler()->get("verilator64");
+  assert(vc64 != nullptr);
+  static_cast<avmm::Verilator64Compiler*>(vc64)->set_bursts(enable);
+  #endif
+  return *this;
+}
+
 Cascade& Cascade::set_profile_interval(size_t n) {
   assert(!is_running_);
   runtime_.set_profile_interval(n);
   return *this;
 }
 
+Cascade& Cascade::set_enable_text_checkpoints(bool enable) {
+  assert(!is_running_);
+  runtime_.set_enable_text_checkpoints(enable);
+  return *this;
+}
+
+Cascade& Cascade::set_checkpoint_interval(size_t n) {
+  assert(!is_running_);
+  runtime_.set_checkpoint_interval(n);
+  return *this;
+}
+
+Cascade& Cascade::set_checkpoint_path(const string& path) {
+  assert(!is_running_);
+  runtime_.set_checkpoint_path(path);
+  return *this;
+}
+
+Cascade& Cascade::set_partition_locs(const string& locs) {
+  assert(!is_running_);
+  runtime_.set_partition_locs(locs);
+  return *this;
+}
+
+Cascade& Cascade::set_partition_interval(size_t n) {
+  assert(!is_running_);
+  runtime_.set_partition_interval(n);
+  return *this;
+}
+
 Cascade& Cascade::set_stdin(streambuf* sb) {
   assert(!is_running_);
   runtime_.rdbuf(0, sb);
@@ -204,6 +262,11 @@ Cascade& Cascade::stop_now() {
   return *this;
 }
 
+Cascade& Cascade::migrate(const string& loc) {
+  runtime_.migrate(loc);
+  return *this;
+}
+
 bool Cascade::is_running() const {
   return is_running();
 }
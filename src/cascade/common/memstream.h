@@ -0,0 +1,88 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_COMMON_MEMSTREAM_H
+#define CASCADE_SRC_COMMON_MEMSTREAM_H
+
+#include <iostream>
+#include <streambuf>
+
+namespace cascade {
+
+// This class provides a read-only c++ stream interface to a region of memory
+// which is owned by someone else, such as a memory-mapped file. Unlike
+// std::istringstream, the contents of the region are not copied.
+
+class membuf : public std::streambuf {
+  public:
+    membuf(const char* begin, const char* end);
+    ~membuf() override = default;
+
+  private:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override;
+};
+
+class imemstream : public std::istream {
+  public:
+    imemstream(const char* begin, const char* end);
+    ~imemstream() override = default;
+
+  private:
+    membuf buf_;
+};
+
+inline membuf::membuf(const char* begin, const char* end) : std::streambuf() {
+  auto* b = const_cast<char*>(begin);
+  setg(b, b, b + (end - begin));
+}
+
+inline membuf::pos_type membuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if ((which & std::ios_base::in) == 0) {
+    return pos_type(off_type(-1));
+  }
+  auto* p = (dir == std::ios_base::beg) ? eback() : (dir == std::ios_base::end) ? egptr() : gptr();
+  p += off;
+  if ((p < eback()) || (p > egptr())) {
+    return pos_type(off_type(-1));
+  }
+  setg(eback(), p, egptr());
+  return pos_type(p - eback());
+}
+
+inline membuf::pos_type membuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+inline imemstream::imemstream(const char* begin, const char* end) : std::istream(&buf_), buf_(begin, end) { }
+
+} // namespace cascade
+
+#endif
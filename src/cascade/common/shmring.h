@@ -0,0 +1,246 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_COMMON_SHMRING_H
+#define CASCADE_SRC_COMMON_SHMRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cascade {
+
+// This class is a single-producer single-consumer ring buffer which is meant
+// to be placed in a region of memory shared by two processes. A zero-filled
+// region of memory is a valid empty ring.
+
+class shmring {
+  public:
+    // The number of bytes this ring can hold
+    static constexpr size_t capacity = 1 << 20;
+
+    // Copies n bytes into the ring. Returns false without copying anything if
+    // there isn't enough space.
+    bool push(const char* c, size_t n);
+    // Copies a four-byte header followed by n bytes into the ring as a single
+    // unit. Returns false without copying anything if there isn't enough space.
+    bool push(uint32_t header, const char* c, size_t n);
+    // Copies n bytes out of the ring. The caller is responsible for ensuring
+    // that at least n bytes have been pushed.
+    void pop(char* c, size_t n);
+    // Returns the number of bytes which have been pushed but not popped
+    size_t size() const;
+
+    // Consumer State:
+    //
+    // A consumer which polls this ring sets polled before any messages are
+    // pushed. A polling consumer sets sleeping before it blocks on some other
+    // channel, and clears it when it wakes up. The producer is responsible for
+    // waking the consumer if it pushes while sleeping is set.
+    void set_polled(bool p);
+    bool polled() const;
+    void set_sleeping(bool s);
+    bool sleeping() const;
+
+  private:
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    std::atomic<uint32_t> polled_;
+    std::atomic<uint32_t> sleeping_;
+    char data_[capacity];
+
+    // Copies n bytes to or from the ring, starting from absolute position pos
+    void copy_in(uint64_t pos, const char* c, size_t n);
+    void copy_out(uint64_t pos, char* c, size_t n) const;
+};
+
+// This class encapsulates a named POSIX shared memory segment containing a
+// pair of shmrings. The process which creates the segment sends on the first
+// ring and receives on the second; the process which attaches to it does the
+// opposite.
+
+class shmsegment {
+  public:
+    // Creates a new segment. Returns nullptr on failure.
+    static shmsegment* create(const std::string& name);
+    // Attaches to an existing segment. Returns nullptr on failure.
+    static shmsegment* attach(const std::string& name);
+    ~shmsegment();
+
+    // Removes the name of this segment from the system. The segment persists
+    // until both processes have unmapped it.
+    void unlink();
+
+    // Returns the ring this process reads from
+    shmring* get();
+    // Returns the ring this process writes to
+    shmring* put();
+
+  private:
+    shmsegment(const std::string& name, void* addr, bool creator);
+
+    std::string name_;
+    shmring* rings_;
+    bool creator_;
+
+    static shmsegment* open(const std::string& name, bool creator);
+};
+
+inline bool shmring::push(const char* c, size_t n) {
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  const auto head = head_.load(std::memory_order_acquire);
+  if ((capacity - (tail - head)) < n) {
+    return false;
+  }
+  copy_in(tail, c, n);
+  tail_.store(tail + n, std::memory_order_release);
+  return true;
+}
+
+inline bool shmring::push(uint32_t header, const char* c, size_t n) {
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  const auto head = head_.load(std::memory_order_acquire);
+  if ((capacity - (tail - head)) < (sizeof(header) + n)) {
+    return false;
+  }
+  copy_in(tail, (const char*)&header, sizeof(header));
+  copy_in(tail + sizeof(header), c, n);
+  tail_.store(tail + sizeof(header) + n, std::memory_order_release);
+  return true;
+}
+
+inline void shmring::pop(char* c, size_t n) {
+  const auto head = head_.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  copy_out(head, c, n);
+  head_.store(head + n, std::memory_order_release);
+}
+
+inline size_t shmring::size() const {
+  return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+inline void shmring::set_polled(bool p) {
+  polled_.store(p ? 1 : 0);
+}
+
+inline bool shmring::polled() const {
+  return polled_.load() != 0;
+}
+
+inline void shmring::set_sleeping(bool s) {
+  // Together with the fence in sleeping(), this guarantees that either the
+  // consumer sees a push which raced with this store or the producer sees
+  // this store and wakes the consumer up.
+  sleeping_.store(s ? 1 : 0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+inline bool shmring::sleeping() const {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return sleeping_.load(std::memory_order_relaxed) != 0;
+}
+
+inline void shmring::copy_in(uint64_t pos, const char* c, size_t n) {
+  const auto idx = pos % capacity;
+  const auto chunk = std::min(n, capacity - idx);
+  memcpy(data_ + idx, c, chunk);
+  memcpy(data_, c + chunk, n - chunk);
+}
+
+inline void shmring::copy_out(uint64_t pos, char* c, size_t n) const {
+  const auto idx = pos % capacity;
+  const auto chunk = std::min(n, capacity - idx);
+  memcpy(c, data_ + idx, chunk);
+  memcpy(c + chunk, data_, n - chunk);
+}
+
+inline shmsegment* shmsegment::create(const std::string& name) {
+  return open(name, true);
+}
+
+inline shmsegment* shmsegment::attach(const std::string& name) {
+  return open(name, false);
+}
+
+inline shmsegment::~shmsegment() {
+  ::munmap(rings_, 2*sizeof(shmring));
+}
+
+inline void shmsegment::unlink() {
+  ::shm_unlink(name_.c_str());
+}
+
+inline shmring* shmsegment::get() {
+  return creator_ ? (rings_ + 1) : rings_;
+}
+
+inline shmring* shmsegment::put() {
+  return creator_ ? rings_ : (rings_ + 1);
+}
+
+inline shmsegment::shmsegment(const std::string& name, void* addr, bool creator) {
+  name_ = name;
+  rings_ = static_cast<shmring*>(addr);
+  creator_ = creator;
+}
+
+inline shmsegment* shmsegment::open(const std::string& name, bool creator) {
+  const auto fd = creator ?
+    ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR) :
+    ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) {
+    return nullptr;
+  }
+  if (creator && (::ftruncate(fd, 2*sizeof(shmring)) != 0)) {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return nullptr;
+  }
+  auto* addr = ::mmap(nullptr, 2*sizeof(shmring), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    if (creator) {
+      ::shm_unlink(name.c_str());
+    }
+    return nullptr;
+  }
+  return new shmsegment(name, addr, creator);
+}
+
+} // namespace cascade
+
+#endif
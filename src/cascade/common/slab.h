@@ -0,0 +1,222 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_COMMON_SLAB_H
+#define CASCADE_SRC_COMMON_SLAB_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+namespace cascade {
+
+// This class is a size-segregated free list allocator for classes which
+// allocate and free large numbers of small objects (ie: AST nodes). Requests
+// are rounded up to a multiple of the platform's maximum alignment and carved
+// out of large slabs. Freed blocks are placed on a free list for their size
+// class and recycled by subsequent requests rather than being returned to the
+// system allocator. Requests for more than Max bytes are forwarded to ::new.
+//
+// Each thread caches up to 2*Batch free blocks per size class, so allocation
+// usually doesn't require synchronization. Blocks in excess of that, along
+// with everything a thread has cached when it exits, are moved in batches to a
+// shared depot, where they can be reused by any thread. This matters when
+// objects are allocated on one thread and freed on another (ie: modules which
+// are compiled on a thread pool and torn down by the runtime). Slabs are never
+// returned to the system, so the memory footprint of this class is bounded by
+// the largest number of live objects that have ever existed at one time, plus
+// the contents of the per-thread caches.
+
+template <size_t Max = 256, size_t SlabSize = 64*1024, size_t Batch = 64>
+class Slab {
+  public:
+    static void* allocate(size_t n);
+    static void deallocate(void* p, size_t n);
+
+    // Returns the number of calls to allocate() made on this thread.
+    static size_t allocations();
+    // Returns the number of calls to deallocate() made on this thread.
+    static size_t deallocations();
+
+  private:
+    static constexpr size_t align_ = alignof(std::max_align_t);
+    static constexpr size_t classes_ = (Max + align_ - 1) / align_;
+    static_assert(SlabSize >= Max, "Slabs must be able to hold at least one allocation!");
+    static_assert(Batch > 0, "Batches must contain at least one block!");
+
+    struct Block {
+      Block* next;
+    };
+    // Shared state. Unused slab space is handed back along with free blocks
+    // when a thread exits, so that it isn't lost.
+    struct Depot {
+      std::mutex lock;
+      Block* free[classes_] = {};
+      std::vector<std::pair<char*, char*>> spare;
+    };
+    // Per-thread state. Returns its contents to the depot on thread exit.
+    struct Lists {
+      Block* free[classes_] = {};
+      size_t count[classes_] = {};
+      char* begin = nullptr;
+      char* end = nullptr;
+      size_t allocs = 0;
+      size_t deallocs = 0;
+      ~Lists();
+    };
+    static Depot& depot();
+    static Lists& lists();
+
+    // Moves up to Batch blocks from the front of a list onto another. Returns
+    // the number of blocks which were moved.
+    static size_t move(Block*& from, Block*& to);
+};
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline void* Slab<Max, SlabSize, Batch>::allocate(size_t n) {
+  auto& ls = lists();
+  ++ls.allocs;
+  if ((n == 0) || (n > Max)) {
+    return ::operator new(n);
+  }
+  const auto idx = (n - 1) / align_;
+  if (ls.free[idx] == nullptr) {
+    auto& d = depot();
+    std::lock_guard<std::mutex> lg(d.lock);
+    ls.count[idx] += move(d.free[idx], ls.free[idx]);
+  }
+  if (ls.free[idx] != nullptr) {
+    auto* b = ls.free[idx];
+    ls.free[idx] = b->next;
+    --ls.count[idx];
+    return b;
+  }
+
+  const auto size = (idx + 1) * align_;
+  if (static_cast<size_t>(ls.end - ls.begin) < size) {
+    auto& d = depot();
+    std::lock_guard<std::mutex> lg(d.lock);
+    if (!d.spare.empty() && (static_cast<size_t>(d.spare.back().second - d.spare.back().first) >= size)) {
+      ls.begin = d.spare.back().first;
+      ls.end = d.spare.back().second;
+      d.spare.pop_back();
+    } else {
+      ls.begin = static_cast<char*>(::operator new(SlabSize));
+      ls.end = ls.begin + SlabSize;
+    }
+  }
+  auto* res = ls.begin;
+  ls.begin += size;
+  return res;
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline void Slab<Max, SlabSize, Batch>::deallocate(void* p, size_t n) {
+  if (p == nullptr) {
+    return;
+  }
+  auto& ls = lists();
+  ++ls.deallocs;
+  if ((n == 0) || (n > Max)) {
+    return ::operator delete(p);
+  }
+  const auto idx = (n - 1) / align_;
+  auto* b = static_cast<Block*>(p);
+  b->next = ls.free[idx];
+  ls.free[idx] = b;
+
+  if (++ls.count[idx] >= 2*Batch) {
+    auto& d = depot();
+    std::lock_guard<std::mutex> lg(d.lock);
+    ls.count[idx] -= move(ls.free[idx], d.free[idx]);
+  }
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline size_t Slab<Max, SlabSize, Batch>::allocations() {
+  return lists().allocs;
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline size_t Slab<Max, SlabSize, Batch>::deallocations() {
+  return lists().deallocs;
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline Slab<Max, SlabSize, Batch>::Lists::~Lists() {
+  auto& d = depot();
+  std::lock_guard<std::mutex> lg(d.lock);
+  for (size_t i = 0; i < classes_; ++i) {
+    while (free[i] != nullptr) {
+      move(free[i], d.free[i]);
+    }
+  }
+  if (begin != end) {
+    d.spare.push_back(std::make_pair(begin, end));
+  }
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline typename Slab<Max, SlabSize, Batch>::Depot& Slab<Max, SlabSize, Batch>::depot() {
+  // The depot is never destroyed, as threads may still exit (and return their
+  // blocks to it) during static destruction.
+  static auto* d = new Depot();
+  return *d;
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline typename Slab<Max, SlabSize, Batch>::Lists& Slab<Max, SlabSize, Batch>::lists() {
+  static thread_local Lists ls;
+  return ls;
+}
+
+template <size_t Max, size_t SlabSize, size_t Batch>
+inline size_t Slab<Max, SlabSize, Batch>::move(Block*& from, Block*& to) {
+  if (from == nullptr) {
+    return 0;
+  }
+  auto* first = from;
+  auto* last = from;
+  size_t res = 1;
+  for (; (res < Batch) && (last->next != nullptr); ++res) {
+    last = last->next;
+  }
+  from = last->next;
+  last->next = to;
+  to = first;
+  return res;
+}
+
+} // namespace cascade
+
+#endif
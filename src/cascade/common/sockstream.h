@@ -39,6 +39,7 @@
 #include <sys/un.h>
 #include <unistd.h>
 #include "common/fdstream.h"
+#include "common/shmring.h"
 
 namespace cascade {
 
@@ -59,11 +60,17 @@ class sockstream : public fdstream {
     // Returns the file descriptor underlying this socket
     int descriptor() const;
 
+    // Takes ownership of a shared memory segment and begins using it to send
+    // and receive message payloads. Both ends of the socket must call this
+    // method at the same message boundary. See fdbuf::attach() for poll.
+    void share(shmsegment* seg, bool poll = false);
+
   private:
     int raw_fd(int fd);
     int unix_sock(const char* path);
     int inet_sock(const char* host, uint32_t port);
     int fd_;
+    shmsegment* shm_;
 };
 
 inline sockstream::sockstream(int fd) : fdstream(raw_fd(fd)) { }
@@ -77,6 +84,9 @@ inline sockstream::~sockstream() {
     flush();
     ::close(fd_);
   }
+  if (shm_ != nullptr) {
+    delete shm_;
+  }
 }
 
 inline bool sockstream::error() const {
@@ -92,12 +102,23 @@ inline int sockstream::descriptor() const {
   return fd_;
 }
 
+inline void sockstream::share(shmsegment* seg, bool poll) {
+  flush();
+  attach(seg->get(), seg->put(), poll);
+  if (shm_ != nullptr) {
+    delete shm_;
+  }
+  shm_ = seg;
+}
+
 inline int sockstream::raw_fd(int fd) {
+  shm_ = nullptr;
   fd_ = fd;
   return fd_;
 }
 
 inline int sockstream::unix_sock(const char* path) {
+  shm_ = nullptr;
   struct sockaddr_un dest;
   bzero(&dest, sizeof(dest));
   dest.sun_family = AF_UNIX;
@@ -112,6 +133,7 @@ inline int sockstream::unix_sock(const char* path) {
 }
 
 inline int sockstream::inet_sock(const char* host, uint32_t port) {
+  shm_ = nullptr;
   struct sockaddr_in dest;
   bzero(&dest, sizeof(dest));
   dest.sin_family = AF_INET;
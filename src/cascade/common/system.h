@@ -57,8 +57,10 @@ struct System {
   static int execute(const std::string& cmd);
   // Forks a process and returns its pid, setting verbose to false will
   // redirect all output to /dev/null. Unlike execute(), this method will not
-  // prevent sigint and sigkill from reaching the main thread
-  static pid_t no_block_begin_execute(const std::string& cmd, bool verbose);
+  // prevent sigint and sigkill from reaching the main thread. Setting
+  // new_group to true places the process in a process group of its own, so
+  // that it can be killed along with everything that it spawns.
+  static pid_t no_block_begin_execute(const std::string& cmd, bool verbose, bool new_group = false);
   // Blocks until a pid completes execution
   static int no_block_wait_finish(pid_t pid);
   // Convenience method, invokes no_block_begin_execute and then blocks on
@@ -100,15 +102,23 @@ inline int System::execute(const std::string& cmd) {
   return std::system(cmd.c_str());
 }
 
-inline pid_t System::no_block_begin_execute(const std::string& cmd, bool verbose) {
+inline pid_t System::no_block_begin_execute(const std::string& cmd, bool verbose, bool new_group) {
   const auto pid = fork();
   if (pid == 0) {
+    if (new_group) {
+      setpgid(0, 0);
+    }
     if (!verbose) {
       fclose(stdout);
       fclose(stderr); 
     }
     return execl("/bin/sh", "sh", "-c", cmd.c_str(), nullptr);
   } else {
+    // Both parent and child set the group, so that it's in place no matter
+    // which of them runs first.
+    if (new_group && (pid > 0)) {
+      setpgid(pid, pid);
+    }
     return pid;
   }
 }
@@ -49,6 +49,9 @@ void DataPlane::register_id(const VId id) {
   if (id >= write_buf_.size()) {
     write_buf_.resize(id+1); 
   }
+  if (id >= toggles_.size()) {
+    toggles_.resize(id+1, 0);
+  }
 }
 
 void DataPlane::register_reader(Engine* e, VId id) {
@@ -122,6 +125,7 @@ void DataPlane::write(VId id, const Bits* bits) {
     return;
   } 
   write_buf_[id] = *bits;
+  ++toggles_[id];
   for (auto* e : readers_[id]) {
     e->read(id, &write_buf_[id]);
   } 
@@ -135,9 +139,23 @@ void DataPlane::write(VId id, bool b) {
     return;
   } 
   write_buf_[id].flip(0);
+  ++toggles_[id];
   for (auto* e : readers_[id]) {
     e->read(id, &write_buf_[id]);
   } 
 }
 
+size_t DataPlane::size() const {
+  return toggles_.size();
+}
+
+uint64_t DataPlane::get_toggles(VId id) const {
+  assert(id < toggles_.size());
+  return toggles_[id];
+}
+
+void DataPlane::clear_toggles() {
+  fill(toggles_.begin(), toggles_.end(), 0);
+}
+
 } // namespace cascade
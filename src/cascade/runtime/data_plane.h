@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_RUNTIME_DATA_PLANE_H
 #define CASCADE_SRC_RUNTIME_DATA_PLANE_H
 
+#include <cstdint>
 #include <vector>
 #include "common/bits.h"
 #include "runtime/ids.h"
@@ -71,12 +72,23 @@ class DataPlane {
     void write(VId id, const Bits* bits);
     void write(VId id, bool b);
 
+    // Profiling Interface:
+    //
+    // Returns one more than the largest id which has been registered.
+    size_t size() const;
+    // Returns the number of times that the value of id has changed since the
+    // previous call to clear_toggles().
+    uint64_t get_toggles(VId id) const;
+    void clear_toggles();
+
   private:
     // Registries:
     std::vector<std::vector<Engine*>> readers_;
     std::vector<std::vector<Engine*>> writers_;
     // Buffers:
     std::vector<Bits> write_buf_;
+    // Profiling State:
+    std::vector<uint64_t> toggles_;
 };
 
 } // namespace cascade
@@ -31,16 +31,21 @@
 #include "runtime/module.h"
 
 #include <cassert>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+#include "common/memstream.h"
 #include "runtime/data_plane.h"
 #include "runtime/isolate.h"
 #include "runtime/runtime.h"
 #include "target/compiler.h"
 #include "target/engine.h"
+#include "target/input.h"
 #include "target/state.h"
 #include "verilog/analyze/module_info.h"
 #include "verilog/analyze/resolve.h"
@@ -58,6 +63,7 @@
 #include "verilog/transform/event_expand.h"
 #include "verilog/transform/index_normalize.h"
 #include "verilog/transform/loop_unroll.h"
+#include "verilog/transform/pass_manager.h"
 #include "verilog/transform/replace_introspection_exprs.h"
 
 using namespace std;
@@ -71,6 +77,70 @@ namespace {
 
 mutex alt_lock_;
 
+// Software engines can execute loop statements natively. Loops which run for
+// more than this many iterations are left in place rather than being unrolled
+// when compiling for software.
+
+constexpr size_t sw_max_unroll_ = 256;
+
+// Binary checkpoints begin with a magic string and a format version, followed
+// by the serialized input and state of each module. They end with an index of
+// those sections and a trailer which locates the index.
+
+constexpr char ckpt_magic_[8] = {'C', 'A', 'S', 'C', 'K', 'P', 'T', '\0'};
+constexpr uint32_t ckpt_version_ = 1;
+constexpr size_t ckpt_header_size_ = 16;
+
+struct CkptEntry {
+  uint32_t mid;
+  uint32_t reserved;
+  uint64_t input_off;
+  uint64_t input_len;
+  uint64_t state_off;
+  uint64_t state_len;
+};
+
+struct CkptTrailer {
+  uint64_t index_off;
+  uint32_t count;
+  uint32_t version;
+};
+
+// Incremental checkpoints set this flag in the header and follow it with the
+// path to the checkpoint which they are relative to. Sections in incremental
+// checkpoints only contain the state which changed since that checkpoint.
+
+constexpr uint32_t ckpt_delta_ = 0x1;
+
+uint64_t write_ckpt_header(ostream& os, const string* base) {
+  const uint32_t header[2] = {ckpt_version_, (base != nullptr) ? ckpt_delta_ : 0};
+  os.write(ckpt_magic_, sizeof(ckpt_magic_));
+  os.write(reinterpret_cast<const char*>(header), sizeof(header));
+  if (base == nullptr) {
+    return ckpt_header_size_;
+  }
+  const uint32_t len = base->length();
+  os.write(reinterpret_cast<const char*>(&len), sizeof(len));
+  os.write(base->data(), len);
+  return ckpt_header_size_ + sizeof(len) + len;
+}
+
+void write_ckpt_index(ostream& os, const vector<CkptEntry>& index, uint64_t off) {
+  CkptTrailer t;
+  t.index_off = off;
+  t.count = index.size();
+  t.version = ckpt_version_;
+  os.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(CkptEntry));
+  os.write(reinterpret_cast<const char*>(&t), sizeof(t));
+}
+
+// Returns true if the section [off, off+len) lies within the first n bytes of
+// a checkpoint. The comparison is arranged so that it can't overflow.
+
+bool ckpt_in_bounds(uint64_t off, uint64_t len, uint64_t n) {
+  return (off <= n) && (len <= (n - off));
+}
+
 } // namespace
 
 namespace cascade {
@@ -144,6 +214,10 @@ Engine* Module::engine() {
   return engine_;
 }
 
+const ModuleDeclaration* Module::source() const {
+  return psrc_;
+}
+
 size_t Module::size() const {
   size_t res = 0;
   for (auto i = iterator(const_cast<Module*>(this)), ie = const_cast<Module*>(this)->end(); i != ie; ++i) {
@@ -191,6 +265,33 @@ void Module::rebuild() {
   }
 }
 
+void Module::migrate() {
+  // Generate new isolate code and bump the sequence number for this module.
+  // This will cause any jit passes which are still in flight to abort.
+  auto* md = rt_->get_isolate()->isolate(psrc_, psrc_->size_items());
+  const auto this_version = ++version_;
+
+  // Record human readable name for this module
+  const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
+  const auto fid = Resolve().get_readable_full_id(iid);
+
+  // A running engine has already made its way through its jit passes, so we
+  // only need to compile for the last of them. Initial blocks have already
+  // run and must not run again.
+  for (const auto* a : {"__target", "__loc"}) {
+    const auto val = md->get_attrs()->get<String>(a)->get_readable_val();
+    const auto sep = val.find_last_of(';');
+    if (sep != string::npos) {
+      md->get_attrs()->set_or_replace(a, new String(val.substr(sep+1)));
+    }
+  }
+  DeleteInitial().run(md);
+
+  // Compilation takes place asynchronously while this module continues to run
+  rt_->schedule_asynchronous(Runtime::Asynchronous([this, md, this_version, fid]{
+    compile_and_replace(md, this_version, fid, 0, false, true);
+  }));
+}
 void Module::save(ostream& os) {
   os << size() << endl;
 
@@ -263,6 +364,156 @@ void Module::restart(std::istream& is) {
   }
 }
 
+void Module::save_binary(ostream& os) {
+  save_checkpoint(os, nullptr, false);
+}
+
+void Module::save_binary_base(ostream& os) {
+  save_checkpoint(os, nullptr, true);
+}
+
+void Module::save_binary_delta(ostream& os, const string& base) {
+  save_checkpoint(os, &base, true);
+}
+
+void Module::save_binary_link(ostream& os, const string& base) {
+  const auto off = write_ckpt_header(os, &base);
+  write_ckpt_index(os, vector<CkptEntry>(), off);
+}
+
+void Module::restart_binary(const char* data, size_t n) {
+  assert(is_binary_checkpoint(data, n));
+
+  // Locate the index. The mapping may not be suitably aligned for these
+  // structs, so they're copied out rather than cast in place.
+  CkptTrailer t;
+  memcpy(&t, data + n - sizeof(t), sizeof(t));
+  if ((t.version != ckpt_version_) || !ckpt_in_bounds(t.index_off, static_cast<uint64_t>(t.count) * sizeof(CkptEntry), n - sizeof(t))) {
+    ostream(rt_->rdbuf(Runtime::stderr_)) << "Save file is corrupt!" << endl;
+    return;
+  }
+  // Every section has to lie between the header and the index. This is
+  // checked for the entire index before any engine is touched so that a
+  // corrupt file can't leave the hierarchy partially restored.
+  unordered_map<MId, CkptEntry> index;
+  for (size_t i = 0; i < t.count; ++i) {
+    CkptEntry e;
+    memcpy(&e, data + t.index_off + i * sizeof(e), sizeof(e));
+    if (!ckpt_in_bounds(e.input_off, e.input_len, t.index_off) || !ckpt_in_bounds(e.state_off, e.state_len, t.index_off)) {
+      ostream(rt_->rdbuf(Runtime::stderr_)) << "Save file is corrupt!" << endl;
+      return;
+    }
+    index[e.mid] = e;
+  }
+
+  // Update module hierarchy. Sections for modules which aren't part of the
+  // hierarchy are never touched.
+  for (auto i = iterator(this), ie = end(); i != ie; ++i) {
+    const auto* p = (*i)->psrc_->get_parent();
+    assert(p != nullptr);
+    assert(p->is(Node::Tag::module_instantiation));
+
+    const auto fid = Resolve().get_readable_full_id(static_cast<const ModuleInstantiation*>(p)->get_iid());
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "<restart> " << fid << endl;
+
+    const auto id = rt_->get_isolate()->isolate(static_cast<const ModuleInstantiation*>(p));
+    const auto itr = index.find(id);
+    if (itr == index.end()) {
+      continue;
+    }
+    const auto& e = itr->second;
+
+    // Sections are decoded here rather than on an engine's first use. The
+    // caller unmaps the file once this returns, and an incremental checkpoint
+    // has to be applied on top of its base before the next one is read.
+    // Engines also resume as soon as the restart finishes, so deferring the
+    // decode wouldn't save anything for modules that are still running.
+    Input input;
+    imemstream iis(data + e.input_off, data + e.input_off + e.input_len);
+    input.deserialize(iis);
+    (*i)->engine_->set_input(&input);
+
+    State state;
+    imemstream sis(data + e.state_off, data + e.state_off + e.state_len);
+    state.deserialize(sis);
+    (*i)->engine_->set_state(&state);
+  }
+}
+
+PassManager& Module::add_transforms(PassManager& pm, bool is_sw) {
+  const auto max_unroll = is_sw ? sw_max_unroll_ : 0;
+  return pm
+    .add_local("ReplaceIntrospectionExprs", new ReplaceIntrospectionExprs(), PassManager::NONE, PassManager::ALL)
+    .add_local("AssignUnpack", new AssignUnpack(), PassManager::RESOLVE, PassManager::NONE)
+    .add("IndexNormalize", [](ModuleDeclaration* md){IndexNormalize().run(md);}, PassManager::NAVIGATE | PassManager::MODULE_INFO)
+    .add("LoopUnroll", [max_unroll](ModuleDeclaration* md){LoopUnroll().set_max_unroll(max_unroll).run(md);}, PassManager::NAVIGATE | PassManager::RESOLVE)
+    .add("DeAlias", [](ModuleDeclaration* md){DeAlias().run(md);}, PassManager::NAVIGATE)
+    .add("ConstantProp", [](ModuleDeclaration* md){ConstantProp().run(md);}, PassManager::NAVIGATE)
+    .add("EventExpand", [](ModuleDeclaration* md){EventExpand().run(md);}, PassManager::ALL)
+    .add("ControlMerge", [](ModuleDeclaration* md){ControlMerge().run(md);}, PassManager::NONE)
+    // Flattening blocks can remove the last use of a variable, so we iterate
+    // until neither of these passes has anything left to remove.
+    .begin_fixed_point(4)
+      .add("DeadCodeEliminate", [](ModuleDeclaration* md){DeadCodeEliminate().run(md);}, PassManager::NAVIGATE | PassManager::RESOLVE)
+      .add("BlockFlatten", [](ModuleDeclaration* md){BlockFlatten().run(md);}, PassManager::ALL)
+    .end_fixed_point();
+}
+
+bool Module::is_binary_checkpoint(const char* data, size_t n) {
+  return (n >= (ckpt_header_size_ + sizeof(CkptTrailer))) && (memcmp(data, ckpt_magic_, sizeof(ckpt_magic_)) == 0);
+}
+
+string Module::get_binary_checkpoint_base(const char* data, size_t n) {
+  assert(is_binary_checkpoint(data, n));
+  uint32_t header[2];
+  memcpy(header, data + sizeof(ckpt_magic_), sizeof(header));
+  if ((header[1] & ckpt_delta_) == 0) {
+    return "";
+  }
+  uint32_t len = 0;
+  memcpy(&len, data + ckpt_header_size_, sizeof(len));
+  if ((ckpt_header_size_ + sizeof(len) + len) > n) {
+    return "";
+  }
+  return string(data + ckpt_header_size_ + sizeof(len), len);
+}
+
+void Module::save_checkpoint(ostream& os, const string* base, bool track) {
+  auto off = write_ckpt_header(os, base);
+
+  vector<CkptEntry> index;
+  for (auto i = iterator(this), ie = end(); i != ie; ++i) {
+    const auto* p = (*i)->psrc_->get_parent();
+    assert(p != nullptr);
+    assert(p->is(Node::Tag::module_instantiation));
+
+    const auto fid = Resolve().get_readable_full_id(static_cast<const ModuleInstantiation*>(p)->get_iid());
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "<save> " << fid << endl;
+
+    CkptEntry e;
+    e.mid = rt_->get_isolate()->isolate(static_cast<const ModuleInstantiation*>(p));
+    e.reserved = 0;
+
+    auto* input = (*i)->engine_->get_input();
+    e.input_off = off;
+    e.input_len = input->serialize(os);
+    off += e.input_len;
+    delete input;
+
+    auto* state = (base != nullptr) ? (*i)->engine_->get_state_delta(Core::Delta::CHECKPOINT) : (*i)->engine_->get_state();
+    e.state_off = off;
+    e.state_len = state->serialize(os);
+    off += e.state_len;
+    delete state;
+    if (track) {
+      (*i)->engine_->clear_state_delta(Core::Delta::CHECKPOINT);
+    }
+
+    index.push_back(e);
+  }
+  write_ckpt_index(os, index, off);
+}
+
 Module::Instantiator::Instantiator(Module* ptr) {
   ptr_ = ptr;
   instances_.push_back(ptr_);
@@ -321,10 +572,10 @@ void Module::compile_and_replace(size_t ignore) {
   const auto fid = Resolve().get_readable_full_id(iid);
 
   // Invoke compilations until all jit passes are scheduled
-  compile_and_replace(md, this_version, fid, 1);
+  compile_and_replace(md, this_version, fid, 1, false, false);
 }
 
-void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const string& id, size_t pass) {
+void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const string& id, size_t pass, bool transformed, bool migrate) {
   // Lookup annotations 
   const auto* std = md->get_attrs()->get<String>("__std");
   const auto* t = md->get_attrs()->get<String>("__target");
@@ -334,19 +585,35 @@ void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const st
   const auto tsep = t->get_readable_val().find_first_of(';');
   const auto lsep = l->get_readable_val().find_first_of(';');
   const auto jit = std->eq("logic") && ((tsep != string::npos) || (lsep != string::npos));
-
-  // If we're jit compiling, we'll need a second copy of the source.
+  const auto is_logic = (std != nullptr) && (std->get_readable_val() == "logic");
+  const auto is_sw = t->get_readable_val().substr(0, tsep) == "sw";
+
+  // If we're jit compiling, we'll need a second copy of the source. Unless the
+  // transforms below depend on the target we're compiling for (this is the
+  // case for modules with introspection expressions, or loops which may not
+  // be unrolled in software), we defer making this copy until after they've
+  // run. This allows every later pass to share their results rather than
+  // recomputing them from scratch.
+  const auto share = jit && is_logic && 
+    !ReplaceIntrospectionExprs().uses_introspection(md) && 
+    !(is_sw && LoopUnroll().uses_loops(md));
   ModuleDeclaration* md2 = nullptr;
+  Attributes* attrs2 = nullptr;
   if (jit) {
-    md2 = md->clone();
+    attrs2 = md->get_attrs()->clone();
     if (tsep != string::npos) {
-      md2->get_attrs()->set_or_replace("__target", new String(t->get_readable_val().substr(tsep+1)));
+      attrs2->set_or_replace("__target", new String(t->get_readable_val().substr(tsep+1)));
       md->get_attrs()->set_or_replace("__target", new String(t->get_readable_val().substr(0, tsep)));
     }
     if (lsep != string::npos) {
-      md2->get_attrs()->set_or_replace("__loc", new String(l->get_readable_val().substr(lsep+1)));
+      attrs2->set_or_replace("__loc", new String(l->get_readable_val().substr(lsep+1)));
       md->get_attrs()->set_or_replace("__loc", new String(l->get_readable_val().substr(0, lsep)));
     }
+    if (!share) {
+      md2 = md->clone();
+      md2->replace_attrs(attrs2);
+      attrs2 = nullptr;
+    }
     md->get_attrs()->erase("__delay");
     md->get_attrs()->erase("__state_safe_int");
   } else {
@@ -358,33 +625,54 @@ void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const st
     rt_->get_compiler()->fatal("Pass 1 compilation for logic must target software!");
     delete md;
     delete md2;
+    delete attrs2;
     return;
   }
+  // Remaining passes follow. These are skipped if this module was copied from
+  // the result of a previous pass. Otherwise, we do extra work here by doing
+  // this for every jit pass, but that's the price we pay for having
+  // introspection variables. Since this is an experimental feature, we may end
+  // up relocating this logic back to compile_and_replace(size_t).
+  if (is_logic && !transformed) {
+    const auto profile = rt_->is_profiling();
+    PassManager pm;
+    add_transforms(pm.set_profile(profile), is_sw);
+
+    ModuleInfo(md).invalidate();
+    pm.run(md);
+
+    if (profile) {
+      stringstream ps;
+      ps << "<profile> pass " << pass << " transforms of " << id << ":";
+      for (const auto& st : pm.get_stats()) {
+        ps << endl << "  " << st.name << ": " << fixed << setprecision(3) << st.ms << "ms, " 
+           << st.visited << " nodes visited, " << st.rewritten << " nodes rewritten, "
+           << st.created << " nodes created, " << st.deleted << " nodes deleted";
+      }
+      const auto s = ps.str();
+      const auto event = [this, s]{
+        ostream(rt_->rdbuf(Runtime::stdinfo_)) << s << endl;
+      };
+      rt_->schedule_interrupt(event, event);
+    }
+  }
+  // Now that transforms are complete, we can make our deferred copy.
+  if (share) {
+    md2 = md->clone();
+    md2->replace_attrs(attrs2);
+  }
   // Invariant: Initial blocks are removed from pass n compilations. 
   if (pass == 1) {
     DeleteInitial().run(md2);
   }
-  // Remaining passes follow. We do extra work here by doing this for every jit pass, but that's
-  // the price we pay for having introspection variables. Since this is an experimental feature,
-  // we may end up relocating this logic back to compile_and_replace(size_t).
-  const auto is_logic = (std != nullptr) && (std->get_readable_val() == "logic");
-  if (is_logic) {
-    ModuleInfo(md).invalidate();
-    ReplaceIntrospectionExprs().run(md);
-    AssignUnpack().run(md);
-    IndexNormalize().run(md);
-    LoopUnroll().run(md);
-    DeAlias().run(md);
-    ConstantProp().run(md);
-    EventExpand().run(md);
-    ControlMerge().run(md);
-    DeadCodeEliminate().run(md);
-    BlockFlatten().run(md);
-  }
 
   // Compile code
   stringstream ss;
-  ss << "pass " << pass << " compilation of " << id << " with attributes " << md->get_attrs();
+  if (migrate) {
+    ss << "migration of " << id << " with attributes " << md->get_attrs();
+  } else {
+    ss << "pass " << pass << " compilation of " << id << " with attributes " << md->get_attrs();
+  }
   const auto info = ss.str();
   auto* e = rt_->get_compiler()->compile(engine_->get_id(), md);
 
@@ -403,6 +691,37 @@ void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const st
     }
     rt_->reset_open_loop_itrs();
   }
+  // Migration takes place in two phases. The first copies the entire state of
+  // this module into the new engine. The second takes place on a later step
+  // and only moves the state which has changed in the meantime.
+  else if (migrate) {
+    const auto abort = [e] {
+      lock_guard<mutex> lg(alt_lock_);
+      if (e != nullptr) {
+        delete e;
+      }
+    };
+    rt_->schedule_interrupt([this, version, e, info, abort]{
+      if ((version < version_) || (e == nullptr)) {
+        ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << info << endl;
+        abort();
+        return;
+      }
+      engine_->precopy_to(e);
+      rt_->schedule_asynchronous(Runtime::Asynchronous([this, version, e, info, abort]{
+        rt_->schedule_interrupt([this, version, e, info, abort]{
+          if (version < version_) {
+            ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << info << endl;
+            abort();
+            return;
+          }
+          engine_->migrate_to(e);
+          ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << info << endl;
+          rt_->reset_open_loop_itrs();
+        }, abort);
+      }));
+    }, abort);
+  }
   // Pass n compilation takes place asynchronously
   else {
     rt_->schedule_interrupt([this, version, e, info]{
@@ -424,8 +743,8 @@ void Module::compile_and_replace(ModuleDeclaration* md, size_t version, const st
 
   // Run jit compilation asynchronously
   if (jit && !engine_->is_stub() && (e != nullptr)) {
-    rt_->schedule_asynchronous(Runtime::Asynchronous([this, md2, version, id, pass, info]{
-      compile_and_replace(md2, version, id, pass+1);
+    rt_->schedule_asynchronous(Runtime::Asynchronous([this, md2, version, id, pass, info, share]{
+      compile_and_replace(md2, version, id, pass+1, share, false);
     }));
   } else {
     delete md2;
@@ -41,6 +41,7 @@
 namespace cascade {
 
 class Engine;
+class PassManager;
 class Runtime;
 
 class Module {
@@ -69,6 +70,8 @@ class Module {
 
     // Returns the engine associated with this module:
     Engine* engine();
+    // Returns the elaborated source code associated with this module:
+    const ModuleDeclaration* source() const;
     // Returns the number of modules in this hierarchy:
     size_t size() const;
 
@@ -78,10 +81,42 @@ class Module {
     void synchronize(size_t n);
     // Forces a recompilation of the entire module hierarchy.
     void rebuild();
-    // Dumps the state of the module hierarchy to an ostream. 
+    // Recompiles this module (but not its children) for the location given
+    // by its annotations. Compilation takes place in the background, and the
+    // module's state is migrated to the result once it completes.
+    void migrate();
+    // Dumps the state of the module hierarchy to an ostream in a
+    // human-readable format.
     void save(std::ostream& os);
-    // Reads the state of the module hierarchy from an istream. 
+    // Reads the state of the module hierarchy from an istream in the format
+    // produced by save().
     void restart(std::istream& is);
+    // Dumps the state of the module hierarchy to an ostream in a binary
+    // checkpoint format.
+    void save_binary(std::ostream& os);
+    // Identical to save_binary(), but also begins tracking changes to the
+    // state of the module hierarchy for save_binary_delta().
+    void save_binary_base(std::ostream& os);
+    // Dumps only the state which has changed since the previous call to
+    // either save_binary_base() or this method. The resulting checkpoint
+    // refers to base, the path of the checkpoint that it is relative to.
+    void save_binary_delta(std::ostream& os, const std::string& base);
+    // Dumps an empty checkpoint which refers to base.
+    static void save_binary_link(std::ostream& os, const std::string& base);
+    // Reads the state of the module hierarchy from a binary checkpoint which
+    // is resident in memory (typically a memory-mapped file). Only the
+    // sections which correspond to modules in this hierarchy are decoded.
+    void restart_binary(const char* data, size_t n);
+    // Returns true if a region of memory begins with a binary checkpoint.
+    static bool is_binary_checkpoint(const char* data, size_t n);
+    // Returns the path of the checkpoint which a binary checkpoint is relative
+    // to, or the empty string if it is self-contained.
+    static std::string get_binary_checkpoint_base(const char* data, size_t n);
+
+    // Appends the transforms which are run over the isolated source of a
+    // logic module before it's compiled. is_sw should be true if the module
+    // is being compiled for software.
+    static PassManager& add_transforms(PassManager& pm, bool is_sw);
 
   private:
     // Instantiate modules based on source code
@@ -112,7 +147,8 @@ class Module {
 
     // Helper Methods:
     void compile_and_replace(size_t ignore);
-    void compile_and_replace(ModuleDeclaration* md, size_t version, const std::string& id, size_t pass);
+    void compile_and_replace(ModuleDeclaration* md, size_t version, const std::string& id, size_t pass, bool transformed, bool migrate);
+    void save_checkpoint(std::ostream& os, const std::string* base, bool track);
 };
 
 } // namespace cascade
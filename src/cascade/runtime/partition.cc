@@ -0,0 +1,260 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "runtime/partition.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace std;
+
+namespace cascade {
+
+Partition::Partition(size_t parts) {
+  assert(parts > 0);
+  parts_ = parts;
+  imbalance_ = 0.1;
+}
+
+Partition& Partition::set_imbalance(double imbalance) {
+  imbalance_ = imbalance;
+  return *this;
+}
+
+size_t Partition::add_node(size_t w, int pin, bool fixed) {
+  assert((pin == none_) || (static_cast<size_t>(pin) < parts_));
+  nodes_.push_back({w, pin, fixed, {}});
+  return nodes_.size() - 1;
+}
+
+void Partition::add_edge(size_t u, size_t v, uint64_t w) {
+  assert(u < nodes_.size());
+  assert(v < nodes_.size());
+  if ((u == v) || (w == 0)) {
+    return;
+  }
+  nodes_[u].edges[v] += w;
+  nodes_[v].edges[u] += w;
+}
+
+vector<int> Partition::run(const vector<int>& initial) {
+  vector<int> placement(nodes_.size(), none_);
+  vector<size_t> load(parts_, 0);
+
+  // Start from the initial placement if we were given a valid one. Fixed and
+  // pinned nodes always go where they're told.
+  const auto use_initial = (initial.size() == nodes_.size()) && is_balanced(initial);
+  for (size_t i = 0, ie = nodes_.size(); i < ie; ++i) {
+    if (nodes_[i].fixed || (nodes_[i].pin != none_)) {
+      placement[i] = nodes_[i].pin;
+    } else if (use_initial) {
+      placement[i] = initial[i];
+    }
+    if (placement[i] != none_) {
+      load[placement[i]] += nodes_[i].weight;
+    }
+  }
+  place(placement, load);
+
+  // Refine the result until it stops improving. The bound on the number of
+  // rounds is just a safeguard; in practice this converges quickly.
+  for (size_t i = 0; (i < 16) && refine(placement, load); ++i);
+  return placement;
+}
+
+uint64_t Partition::cost(const vector<int>& placement) const {
+  assert(placement.size() == nodes_.size());
+  uint64_t res = 0;
+  for (size_t u = 0, ue = nodes_.size(); u < ue; ++u) {
+    for (const auto& e : nodes_[u].edges) {
+      if (e.first < u) {
+        continue;
+      }
+      if ((placement[u] == none_) || (placement[u] != placement[e.first])) {
+        res += e.second;
+      }
+    }
+  }
+  return res;
+}
+
+size_t Partition::capacity() const {
+  size_t total = 0;
+  size_t largest = 0;
+  for (const auto& n : nodes_) {
+    if (!n.fixed || (n.pin != none_)) {
+      total += n.weight;
+      largest = max(largest, n.weight);
+    }
+  }
+  const auto cap = static_cast<size_t>(ceil((1.0 + imbalance_) * total / parts_));
+  return max(cap, largest);
+}
+
+bool Partition::is_balanced(const vector<int>& placement) const {
+  vector<size_t> load(parts_, 0);
+  for (size_t i = 0, ie = nodes_.size(); i < ie; ++i) {
+    if (placement[i] == none_) {
+      if (!nodes_[i].fixed) {
+        return false;
+      }
+      continue;
+    }
+    if ((placement[i] < 0) || (static_cast<size_t>(placement[i]) >= parts_)) {
+      return false;
+    }
+    load[placement[i]] += nodes_[i].weight;
+  }
+  const auto cap = capacity();
+  return all_of(load.begin(), load.end(), [cap](auto l) {return l <= cap;});
+}
+
+vector<uint64_t> Partition::connectivity(size_t n, const vector<int>& placement) const {
+  vector<uint64_t> res(parts_, 0);
+  for (const auto& e : nodes_[n].edges) {
+    if (placement[e.first] != none_) {
+      res[placement[e.first]] += e.second;
+    }
+  }
+  return res;
+}
+
+void Partition::place(vector<int>& placement, vector<size_t>& load) const {
+  // Place the most heavily connected nodes first. These are the ones where a
+  // bad decision is most expensive.
+  vector<pair<uint64_t, size_t>> order;
+  for (size_t i = 0, ie = nodes_.size(); i < ie; ++i) {
+    if ((placement[i] == none_) && !nodes_[i].fixed) {
+      uint64_t total = 0;
+      for (const auto& e : nodes_[i].edges) {
+        total += e.second;
+      }
+      order.push_back(make_pair(total, i));
+    }
+  }
+  sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+    return (a.first > b.first) || ((a.first == b.first) && (a.second < b.second));
+  });
+
+  // Put each node in the partition that it's most connected to, breaking ties
+  // in favor of the least loaded partition. If nothing fits, fall back on
+  // the least loaded partition.
+  const auto cap = capacity();
+  for (const auto& o : order) {
+    const auto n = o.second;
+    const auto conn = connectivity(n, placement);
+    auto best = none_;
+    for (size_t p = 0; p < parts_; ++p) {
+      if ((load[p] + nodes_[n].weight) > cap) {
+        continue;
+      }
+      if ((best == none_) || (conn[p] > conn[best]) || ((conn[p] == conn[best]) && (load[p] < load[best]))) {
+        best = p;
+      }
+    }
+    if (best == none_) {
+      best = min_element(load.begin(), load.end()) - load.begin();
+    }
+    placement[n] = best;
+    load[best] += nodes_[n].weight;
+  }
+}
+
+bool Partition::refine(vector<int>& placement, vector<size_t>& load) const {
+  const auto cap = capacity();
+  auto improved = false;
+
+  // Single node moves
+  vector<size_t> movable;
+  for (size_t n = 0, ne = nodes_.size(); n < ne; ++n) {
+    if (nodes_[n].fixed || (nodes_[n].pin != none_)) {
+      continue;
+    }
+    movable.push_back(n);
+
+    const auto conn = connectivity(n, placement);
+    const auto cur = placement[n];
+    auto best = cur;
+    for (size_t p = 0; p < parts_; ++p) {
+      if ((load[p] + nodes_[n].weight) > cap) {
+        continue;
+      }
+      if (conn[p] > conn[best]) {
+        best = p;
+      }
+    }
+    if (best != cur) {
+      load[cur] -= nodes_[n].weight;
+      load[best] += nodes_[n].weight;
+      placement[n] = best;
+      improved = true;
+    }
+  }
+
+  // Pairwise swaps. These are what allow us to make progress when the
+  // balance constraint prevents single node moves.
+  for (size_t i = 0, ie = movable.size(); i < ie; ++i) {
+    for (size_t j = i+1; j < ie; ++j) {
+      const auto a = movable[i];
+      const auto b = movable[j];
+      const auto pa = placement[a];
+      const auto pb = placement[b];
+      if (pa == pb) {
+        continue;
+      }
+      const auto wa = nodes_[a].weight;
+      const auto wb = nodes_[b].weight;
+      if (((load[pa] - wa + wb) > cap) || ((load[pb] - wb + wa) > cap)) {
+        continue;
+      }
+
+      const auto ca = connectivity(a, placement);
+      const auto cb = connectivity(b, placement);
+      const auto itr = nodes_[a].edges.find(b);
+      const auto wab = static_cast<int64_t>((itr == nodes_[a].edges.end()) ? 0 : itr->second);
+      const auto gain =
+        (static_cast<int64_t>(ca[pb]) - static_cast<int64_t>(ca[pa])) +
+        (static_cast<int64_t>(cb[pa]) - static_cast<int64_t>(cb[pb])) -
+        2 * wab;
+      if (gain > 0) {
+        load[pa] = load[pa] - wa + wb;
+        load[pb] = load[pb] - wb + wa;
+        placement[a] = pb;
+        placement[b] = pa;
+        improved = true;
+      }
+    }
+  }
+
+  return improved;
+}
+
+} // namespace cascade
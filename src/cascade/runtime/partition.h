@@ -0,0 +1,108 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_RUNTIME_PARTITION_H
+#define CASCADE_SRC_RUNTIME_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace cascade {
+
+// This class assigns the nodes of a weighted graph to a fixed number of
+// partitions. The goal is to minimize the total weight of the edges which
+// cross between partitions, subject to the constraint that no partition
+// contains more than its share of total node weight. Nodes may be pinned to a
+// partition, or pinned outside of every partition, in which case they can't
+// be moved, but their edges still contribute to the cost of a placement.
+//
+// The implementation is a greedy initial placement followed by rounds of
+// single-node moves and pairwise swaps which reduce the cost of the cut. It
+// isn't optimal, but it's fast, and the graphs we see (one node per module
+// instance) are small.
+
+class Partition {
+  public:
+    // Constants:
+    static constexpr int none_ = -1;
+
+    // Constructors:
+    explicit Partition(size_t parts);
+
+    // Configuration Interface:
+    //
+    // Sets the fraction by which a partition may exceed its share of node
+    // weight. The default is 0.1.
+    Partition& set_imbalance(double imbalance);
+
+    // Graph Interface:
+    //
+    // Adds a node with weight w and returns its index. If pin is not none_,
+    // the node may only be placed in partition pin. If fixed is true, the
+    // node is never moved (a fixed node with pin none_ is placed outside of
+    // every partition).
+    size_t add_node(size_t w, int pin = none_, bool fixed = false);
+    // Adds w to the weight of the edge between u and v.
+    void add_edge(size_t u, size_t v, uint64_t w);
+
+    // Partitioning Interface:
+    //
+    // Computes a placement. The result contains one entry per node. Initial
+    // is used as a starting point if it is non-empty and satisfies the
+    // balance constraint.
+    std::vector<int> run(const std::vector<int>& initial = std::vector<int>());
+    // Returns the total weight of the edges which cross between partitions
+    // in a placement.
+    uint64_t cost(const std::vector<int>& placement) const;
+
+  private:
+    size_t parts_;
+    double imbalance_;
+
+    struct Node {
+      size_t weight;
+      int pin;
+      bool fixed;
+      std::unordered_map<size_t, uint64_t> edges;
+    };
+    std::vector<Node> nodes_;
+
+    size_t capacity() const;
+    bool is_balanced(const std::vector<int>& placement) const;
+    std::vector<uint64_t> connectivity(size_t n, const std::vector<int>& placement) const;
+    void place(std::vector<int>& placement, std::vector<size_t>& load) const;
+    bool refine(std::vector<int>& placement, std::vector<size_t>& load) const;
+};
+
+} // namespace cascade
+
+#endif
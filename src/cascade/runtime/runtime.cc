@@ -30,19 +30,27 @@
 
 #include "runtime/runtime.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
 #include "common/incstream.h"
 #include "common/indstream.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "runtime/data_plane.h"
 #include "runtime/isolate.h"
 #include "runtime/module.h"
 #include "runtime/nullbuf.h"
+#include "runtime/partition.h"
 #include "target/compiler/local_compiler.h"
 #include "target/engine.h"
 #include "verilog/analyze/evaluate.h"
@@ -57,6 +65,29 @@
 
 using namespace std;
 
+namespace {
+
+// The number of periodic checkpoints in each chain; the first is a full
+// checkpoint and the remainder are incremental.
+constexpr size_t checkpoint_chain_ = 8;
+
+// Repartitioning only takes place if it would reduce cross-partition traffic
+// by at least this fraction.
+constexpr double partition_threshold_ = 0.1;
+
+// Replaces every jit pass in a __loc annotation with loc.
+string replace_locs(const string& locs, const string& loc) {
+  auto res = loc;
+  for (auto c : locs) {
+    if (c == ';') {
+      res += ";" + loc;
+    }
+  }
+  return res;
+}
+
+} // namespace
+
 namespace cascade {
 
 Runtime::Runtime() : Thread() {
@@ -67,9 +98,20 @@ Runtime::Runtime() : Thread() {
   open_loop_itrs_ = 2;
   open_loop_target_ = 1;
   profile_interval_ = 0;
+  enable_text_checkpoints_ = false;
+  checkpoint_interval_ = 0;
+  checkpoint_path_ = "cascade.ckpt";
+  partition_interval_ = 10;
+  last_checkpoint_ = ::time(nullptr);
+  checkpoint_seq_ = 0;
+  checkpoint_prev_ = "";
+  pending_checkpoints_ = 0;
+  last_partition_ = 0;
 
   pool_.set_num_threads(4);
   pool_.run();
+  checkpoint_pool_.set_num_threads(1);
+  checkpoint_pool_.run();
 
   log_ = new Log();
   parser_ = new Parser(log_);
@@ -121,6 +163,7 @@ Runtime::~Runtime() {
   ostream(rdbuf(stdinfo_)) << "Requesting stop for all outstanding compilation jobs... "; ostream(rdbuf(stdinfo_)).flush();
   compiler_->stop_compile();
   pool_.stop_now();
+  checkpoint_pool_.stop_now();
   ostream(rdbuf(stdinfo_)) << "OK" << endl;
   ostream(rdbuf(stdinfo_)) << "Requesting stop for all asynchronous compilation tasks... "; ostream(rdbuf(stdinfo_)).flush();
   compiler_->stop_async();
@@ -181,6 +224,38 @@ Runtime& Runtime::set_profile_interval(size_t n) {
   return *this;
 }
 
+Runtime& Runtime::set_enable_text_checkpoints(bool etc) {
+  enable_text_checkpoints_ = etc;
+  return *this;
+}
+
+Runtime& Runtime::set_checkpoint_interval(size_t n) {
+  checkpoint_interval_ = n;
+  last_checkpoint_ = ::time(nullptr);
+  return *this;
+}
+
+Runtime& Runtime::set_checkpoint_path(const string& path) {
+  checkpoint_path_ = path;
+  return *this;
+}
+
+Runtime& Runtime::set_partition_locs(const string& locs) {
+  partition_locs_.clear();
+  stringstream ss(locs);
+  for (string loc; getline(ss, loc, ','); ) {
+    if (!loc.empty()) {
+      partition_locs_.push_back(loc);
+    }
+  }
+  return *this;
+}
+
+Runtime& Runtime::set_partition_interval(size_t n) {
+  partition_interval_ = n;
+  return *this;
+}
+
 DataPlane* Runtime::get_data_plane() {
   return dp_;
 }
@@ -197,6 +272,10 @@ Engine::Id Runtime::get_next_id() {
   return next_id_++;
 }
 
+bool Runtime::is_profiling() const {
+  return profile_interval_ > 0;
+}
+
 pair<bool, bool> Runtime::eval(istream& is) {
   log_->clear();
   const auto eof = parser_->parse(is);
@@ -306,9 +385,10 @@ void Runtime::schedule_state_safe_interrupt(Interrupt int__) {
   schedule_blocking_volatile_interrupt(
     [this, int__]{
       stringstream ss;
-      root_->save(ss);
+      root_->save_binary(ss);
       int__();
-      root_->restart(ss);
+      const auto s = ss.str();
+      root_->restart_binary(s.data(), s.length());
     },
     int__
   );
@@ -374,13 +454,11 @@ void Runtime::restart(const string& path) {
   // Scheduling this method as a volatile interrupt guarantees that its run in a state
   // where the program is in a consistent state and there are no outstanding evals.
   schedule_volatile_interrupt([this, path]{
-    ifstream ifs(path);
-    if (!ifs.is_open()) {
+    wait_for_checkpoints();
+    if (!restart_checkpoint(path)) {
       ostream(rdbuf(stderr_)) << "Unable to open save file '" << path << "'\"!" << endl;
       finish(0);
-      return;
     }
-    root_->restart(ifs);
   },
   []{
     // Do nothing.
@@ -457,12 +535,44 @@ void Runtime::retarget(const string& s) {
   });
 }
 
+void Runtime::migrate(const string& loc) {
+  schedule_volatile_interrupt([this, loc]{
+    // Replace the location annotations for every elaborated logic module.
+    // Every jit pass is moved to the new location, so that any future
+    // recompilations (due to eval) will take place there as well.
+    for (auto i = program_->elab_begin(), ie = program_->elab_end(); i != ie; ++i) {
+      const auto* std = i->second->get_attrs()->get<String>("__std");
+      const auto* l = i->second->get_attrs()->get<String>("__loc");
+      if ((std == nullptr) || !std->eq("logic") || (l == nullptr)) {
+        continue;
+      }
+      i->second->get_attrs()->set_or_replace("__loc", new String(replace_locs(l->get_readable_val(), loc)));
+    }
+    for (auto i = root_->begin(), ie = root_->end(); i != ie; ++i) {
+      const auto* std = (*i)->source()->get_attrs()->get<String>("__std");
+      if ((std != nullptr) && std->eq("logic")) {
+        (*i)->migrate();
+      }
+    }
+  },
+  []{
+    // Does nothing.
+  });
+}
+
 void Runtime::save(const string& path) {
   // Scheduling this method as a volatile interrupt guarantees that its run in a state
   // where the program is in a consistent state and there are no outstanding evals.
+  // Only the in-memory snapshot takes place here. The file is written in
+  // the background.
   auto lambda = [this, path] {
-    ofstream ofs(path);
-    root_->save(ofs);
+    stringstream ss;
+    if (enable_text_checkpoints_) {
+      root_->save(ss);
+    } else {
+      root_->save_binary(ss);
+    }
+    write_checkpoint(path, "", ss.str());
   };
   schedule_volatile_interrupt(lambda, lambda);
 }
@@ -598,6 +708,8 @@ void Runtime::run_logic() {
       reference_scheduler();
     }
     log_freq();
+    schedule_checkpoint();
+    schedule_partition();
   }
   if (finished_) {
     done_simulation();
@@ -716,8 +828,16 @@ void Runtime::resync() {
   }
   schedule_all_ = true;
 
-  // Determine whether we can reenter open loop in this state. 
-  enable_open_loop_ = (logic_.size() == 2) && (clock_ != nullptr) && (inlined_logic_ != nullptr);
+  // Determine whether we can reenter open loop in this state. Besides the
+  // clock and the inlined logic, the only engines we allow are leds, which
+  // never feed values back into the logic.
+  size_t leds = 0;
+  for (auto* m : logic_) {
+    if (m->engine()->is_led()) {
+      ++leds;
+    }
+  }
+  enable_open_loop_ = (logic_.size() == (2 + leds)) && (clock_ != nullptr) && (inlined_logic_ != nullptr);
 }
 
 void Runtime::drain_active() {
@@ -941,6 +1061,213 @@ void Runtime::log_freq() {
   schedule_interrupt(event, event);
 }
 
+void Runtime::schedule_checkpoint() {
+  if (checkpoint_interval_ == 0) {
+    return;
+  }
+  if ((::time(nullptr) - last_checkpoint_) < static_cast<time_t>(checkpoint_interval_)) {
+    return;
+  }
+  last_checkpoint_ = ::time(nullptr);
+
+  // Checkpoints are written to files named <path>.0 through <path>.2n-1, where
+  // n is the length of a chain. Alternating between two sets of files
+  // guarantees that the chain referred to by <path> is never overwritten.
+  schedule_volatile_interrupt([this]{
+    const auto path = checkpoint_path_ + "." + to_string(checkpoint_seq_ % (2*checkpoint_chain_));
+    stringstream ss;
+    if ((checkpoint_seq_ % checkpoint_chain_) == 0) {
+      root_->save_binary_base(ss);
+    } else {
+      root_->save_binary_delta(ss, checkpoint_prev_);
+    }
+    ++checkpoint_seq_;
+    checkpoint_prev_ = path;
+    write_checkpoint(path, checkpoint_path_, ss.str());
+  },
+  []{
+    // Does nothing.
+  });
+}
+
+void Runtime::write_checkpoint(const string& path, const string& link, const string& data) {
+  { lock_guard<mutex> lg(checkpoint_lock_);
+    checkpoints_.push_back(make_tuple(path, link, data));
+    ++pending_checkpoints_;
+  }
+  // Each job writes the oldest checkpoint in the queue. The writer pool has a
+  // single thread, which guarantees that checkpoints are written in order.
+  checkpoint_pool_.insert([this]{
+    tuple<string, string, string> c;
+    { lock_guard<mutex> lg(checkpoint_lock_);
+      c = move(checkpoints_.front());
+      checkpoints_.pop_front();
+    }
+    const auto& path = get<0>(c);
+    const auto& link = get<1>(c);
+    const auto& data = get<2>(c);
+
+    { ofstream ofs(path, ios::binary);
+      ofs.write(data.data(), data.length());
+    }
+    if (!link.empty()) {
+      const auto tmp = link + ".tmp";
+      { ofstream ofs(tmp, ios::binary);
+        Module::save_binary_link(ofs, path);
+      }
+      ::rename(tmp.c_str(), link.c_str());
+    }
+
+    lock_guard<mutex> lg(checkpoint_lock_);
+    --pending_checkpoints_;
+    checkpoint_cv_.notify_all();
+  });
+}
+
+void Runtime::wait_for_checkpoints() {
+  unique_lock<mutex> ul(checkpoint_lock_);
+  while (pending_checkpoints_ > 0) {
+    checkpoint_cv_.wait(ul);
+  }
+}
+
+bool Runtime::restart_checkpoint(const string& path) {
+  // Map the save file into memory. Binary checkpoints are read directly from
+  // the mapping. Text checkpoints are parsed from it.
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if ((fd == -1) || (::fstat(fd, &st) != 0)) {
+    if (fd != -1) {
+      ::close(fd);
+    }
+    return false;
+  }
+  const size_t n = st.st_size;
+  auto* data = (n > 0) ? ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  // Incremental checkpoints are applied on top of the checkpoints that they
+  // are relative to.
+  auto res = true;
+  const auto* c = static_cast<const char*>(data);
+  if (Module::is_binary_checkpoint(c, n)) {
+    const auto base = Module::get_binary_checkpoint_base(c, n);
+    if (!base.empty() && (base != path)) {
+      res = restart_checkpoint(base);
+    }
+    if (res) {
+      root_->restart_binary(c, n);
+    }
+  } else {
+    imemstream is(c, c+n);
+    root_->restart(is);
+  }
+  ::munmap(data, n);
+  return res;
+}
+
+void Runtime::schedule_partition() {
+  if (partition_locs_.empty()) {
+    return;
+  }
+  if ((::time(nullptr) - last_partition_) < static_cast<time_t>(partition_interval_)) {
+    return;
+  }
+  last_partition_ = ::time(nullptr);
+
+  // Scheduling this method as a volatile interrupt guarantees that it runs in
+  // a state where the module hierarchy is in sync with the program.
+  schedule_volatile_interrupt([this]{
+    partition();
+  },
+  []{
+    // Does nothing.
+  });
+}
+
+void Runtime::partition() {
+  if (root_ == nullptr) {
+    return;
+  }
+
+  // Modules hold const pointers to their source; these are the same
+  // declarations which are owned by the program.
+  unordered_map<const ModuleDeclaration*, ModuleDeclaration*> decls;
+  for (auto i = program_->elab_begin(), ie = program_->elab_end(); i != ie; ++i) {
+    decls[i->second] = i->second;
+  }
+
+  // Create one node per module. Logic modules are free to move and weighted
+  // by their size. Everything else stays where it is. We record the current
+  // placement as we go; a module's location is the one used by its last jit
+  // pass.
+  Partition p(partition_locs_.size());
+  vector<Module*> modules;
+  vector<int> current;
+  unordered_map<Engine*, size_t> nodes;
+  for (auto i = root_->begin(), ie = root_->end(); i != ie; ++i) {
+    const auto* md = (*i)->source();
+    const auto* std = md->get_attrs()->get<String>("__std");
+    const auto* l = md->get_attrs()->get<String>("__loc");
+    const auto loc = (l == nullptr) ? "" : l->get_readable_val().substr(l->get_readable_val().find_last_of(';')+1);
+    const auto itr = find(partition_locs_.begin(), partition_locs_.end(), loc);
+    const auto at = (itr == partition_locs_.end()) ? Partition::none_ : static_cast<int>(itr - partition_locs_.begin());
+
+    const auto is_logic = (std != nullptr) && std->eq("logic") && (l != nullptr);
+    nodes[(*i)->engine()] = is_logic ? p.add_node(1 + md->size_items()) : p.add_node(0, at, true);
+    modules.push_back(*i);
+    current.push_back(at);
+  }
+
+  // Connect the modules which write each variable to those which read it.
+  // Edges are weighted by the number of times the variable has changed
+  // value since the last time we did this.
+  for (VId id = 0, ide = dp_->size(); id < ide; ++id) {
+    const auto w = 1 + dp_->get_toggles(id);
+    for (auto i = dp_->writer_begin(id), ie = dp_->writer_end(id); i != ie; ++i) {
+      const auto u = nodes.find(*i);
+      if (u == nodes.end()) {
+        continue;
+      }
+      for (auto j = dp_->reader_begin(id), je = dp_->reader_end(id); j != je; ++j) {
+        const auto v = nodes.find(*j);
+        if (v != nodes.end()) {
+          p.add_edge(u->second, v->second, w);
+        }
+      }
+    }
+  }
+  dp_->clear_toggles();
+
+  // Nothing to do unless the new placement is a significant improvement.
+  const auto placement = p.run(current);
+  const auto before = p.cost(current);
+  const auto after = p.cost(placement);
+  if ((placement == current) || (after >= (1.0 - partition_threshold_) * before)) {
+    return;
+  }
+
+  // Migrate the modules whose placement has changed. Their new location is
+  // recorded in the program so that later recompilations take place there
+  // as well.
+  size_t moved = 0;
+  for (size_t i = 0, ie = modules.size(); i < ie; ++i) {
+    if ((placement[i] == current[i]) || (placement[i] == Partition::none_)) {
+      continue;
+    }
+    auto* md = decls[modules[i]->source()];
+    assert(md != nullptr);
+    const auto* l = md->get_attrs()->get<String>("__loc");
+    md->get_attrs()->set_or_replace("__loc", new String(replace_locs(l->get_readable_val(), partition_locs_[placement[i]])));
+    modules[i]->migrate();
+    ++moved;
+  }
+  ostream(rdbuf(stdinfo_)) << "Repartitioned logic across " << partition_locs_.size() << " locations: migrating " << moved << " modules, cross-partition traffic " << before << " -> " << after << endl;
+}
+
 const Node* Runtime::resolve(const string& arg) {
   // Create a new navigation object and point it at the root
   Navigate nav(program_->root_elab()->second);
@@ -33,10 +33,12 @@
 
 #include <condition_variable>
 #include <ctime>
+#include <deque>
 #include <functional>
 #include <iosfwd>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "common/bits.h"
 #include "common/log.h"
@@ -83,6 +85,11 @@ class Runtime : public Thread {
     Runtime& set_open_loop_target(size_t olt);
     Runtime& set_disable_inlining(bool di);
     Runtime& set_profile_interval(size_t n);
+    Runtime& set_enable_text_checkpoints(bool etc);
+    Runtime& set_checkpoint_interval(size_t n);
+    Runtime& set_checkpoint_path(const std::string& path);
+    Runtime& set_partition_locs(const std::string& locs);
+    Runtime& set_partition_interval(size_t n);
 
     // Major Component Accessors and Helpers:
     //
@@ -93,6 +100,8 @@ class Runtime : public Thread {
     DataPlane* get_data_plane();
     Isolate* get_isolate();
     Engine::Id get_next_id();
+    // Returns true if profiling was enabled with set_profile_interval().
+    bool is_profiling() const;
 
     // Eval Interface:
     //
@@ -157,6 +166,15 @@ class Runtime : public Thread {
     // Yields control back to the runtime for performing volatile operations.
     void yield();
 
+    // Migration Interface:
+    //
+    // Relocates every logic module to a new __loc without stopping the
+    // simulation, and returns immediately. The modules are recompiled in the
+    // background, and their state is moved to the new location in two phases:
+    // a full copy as soon as compilation completes, followed by a copy of
+    // whatever has changed since then on a later step.
+    void migrate(const std::string& loc);
+
     // Stream I/O Interface:
     //
     // Appends a new entry to the stream table and returns its fd
@@ -187,9 +205,15 @@ class Runtime : public Thread {
     size_t open_loop_itrs_;
     size_t open_loop_target_;
     size_t profile_interval_;
+    bool enable_text_checkpoints_;
+    size_t checkpoint_interval_;
+    std::string checkpoint_path_;
+    std::vector<std::string> partition_locs_;
+    size_t partition_interval_;
 
-    // Thread Pool:
+    // Thread Pools:
     ThreadPool pool_;
+    ThreadPool checkpoint_pool_;
 
     // Major Components:
     Log* log_;
@@ -222,6 +246,25 @@ class Runtime : public Thread {
     Module* clock_;
     Module* inlined_logic_;
 
+    // Checkpointing State:
+    //
+    // Periodic checkpoints are written to a rotating set of files. Every
+    // chain begins with a full checkpoint, and is followed by incremental
+    // checkpoints which are relative to their predecessors. Checkpoints are
+    // queued and written in order by a dedicated writer thread, so that slow
+    // disks don't hold up compilation; restarts wait until these writes
+    // complete.
+    time_t last_checkpoint_;
+    size_t checkpoint_seq_;
+    std::string checkpoint_prev_;
+    std::deque<std::tuple<std::string, std::string, std::string>> checkpoints_;
+    size_t pending_checkpoints_;
+    std::mutex checkpoint_lock_;
+    std::condition_variable checkpoint_cv_;
+
+    // Partitioning State:
+    time_t last_partition_;
+
     // Time Keeping:
     time_t begin_time_;
     time_t last_time_;
@@ -295,6 +338,28 @@ class Runtime : public Thread {
     // Dumps the current virtual clock frequency to stdlog
     void log_freq();
 
+    // Checkpoint Helpers:
+    //
+    // Schedules a periodic checkpoint if one is due
+    void schedule_checkpoint();
+    // Writes a checkpoint to path on the writer thread. If link is non-empty,
+    // also points the checkpoint at that path at the new checkpoint.
+    void write_checkpoint(const std::string& path, const std::string& link, const std::string& data);
+    // Blocks until all outstanding checkpoint writes have completed
+    void wait_for_checkpoints();
+    // Restores the program from the checkpoint at path, and any checkpoints
+    // that it is relative to. Returns false on failure.
+    bool restart_checkpoint(const std::string& path);
+
+    // Partitioning Helpers:
+    //
+    // Schedules a repartitioning of the program if one is due
+    void schedule_partition();
+    // Assigns logic modules to the locations in partition_locs_ so as to
+    // minimize the traffic between them, and migrates any modules whose
+    // location changes as a result.
+    void partition();
+
     // Debug Helpers:
     //
     // Resolves an id in the program. Returns nullptr on failure.
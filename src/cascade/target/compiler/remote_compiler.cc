@@ -30,9 +30,18 @@
 
 #include "target/compiler/remote_compiler.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 #include <unordered_map>
 #include "common/log.h"
+#include "common/shmring.h"
 #include "common/sockserver.h"
 #include "common/sockstream.h"
 #include "target/compiler/remote_interface.h"
@@ -48,8 +57,19 @@ namespace cascade {
 RemoteCompiler::RemoteCompiler() : Compiler(), Thread() { 
   set_path("/tmp/fpga_socket");
   set_port(8800);
+  set_num_workers(8);
+  set_num_dispatchers(4);
 
   sock_ = nullptr;
+  caps_ = 0;
+  total_queue_ms_ = 0.0;
+  num_dequeued_ = 0;
+  total_first_cycle_ms_ = 0.0;
+  num_first_cycles_ = 0;
+  stats_ = {0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0};
+  epoll_ = -1;
+  wakeup_[0] = -1;
+  wakeup_[1] = -1;
 }
 
 RemoteCompiler::~RemoteCompiler() {
@@ -95,7 +115,7 @@ Interface* RemoteCompiler::get_interface(const std::string& loc) {
   if (sock_ == nullptr) {
     return nullptr;
   }
-  return new RemoteInterface(sock_);
+  return new RemoteInterface(sock_, (caps_ & Rpc::BATCHED_WRITES) != 0);
 }
 
 RemoteCompiler& RemoteCompiler::set_path(const string& p) {
@@ -108,182 +128,125 @@ RemoteCompiler& RemoteCompiler::set_port(uint32_t p) {
   return *this;
 }
 
+RemoteCompiler& RemoteCompiler::set_num_workers(size_t n) {
+  num_workers_ = (n == 0) ? 1 : n;
+  return *this;
+}
+
+RemoteCompiler& RemoteCompiler::set_num_dispatchers(size_t n) {
+  num_dispatchers_ = (n == 0) ? 1 : n;
+  return *this;
+}
+
+RemoteCompiler::Stats RemoteCompiler::get_stats() {
+  size_t pooled = 0;
+  { lock_guard<mutex> lg(slock_);
+    pooled = count(pooled_.begin(), pooled_.end(), true);
+  }
+  lock_guard<mutex> lg(tlock_);
+  auto res = stats_;
+  res.pooled_sockets = pooled;
+  return res;
+}
+
 void RemoteCompiler::run_logic() {
   sockserver tl(port_, 8);
   sockserver ul(path_.c_str(), 8);
   if (tl.error() || ul.error()) {
     return;
   }
+  // Both ends of the wakeup pipe are non-blocking. Otherwise draining the
+  // pipe would block whenever it held an exact multiple of the buffer size.
+  if (::pipe(wakeup_) != 0) {
+    return;
+  }
+  for (auto fd : wakeup_) {
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+#ifdef __linux__
+  epoll_ = ::epoll_create1(0);
+  if (epoll_ < 0) {
+    ::close(wakeup_[0]);
+    ::close(wakeup_[1]);
+    return;
+  }
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeup_[0];
+  ::epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeup_[0], &ev);
+#endif
 
   mlock_.lock();
-  FD_ZERO(&master_set);
-  FD_SET(tl.descriptor(), &master_set);
-  FD_SET(ul.descriptor(), &master_set);
+  active_.clear();
   mlock_.unlock();
+  enable(tl.descriptor());
+  enable(ul.descriptor());
 
-  fd_set read_set;
-  FD_ZERO(&read_set);
-
-  struct timeval timeout = {0, 10000};
-  auto max_fd = max(tl.descriptor(), ul.descriptor());
-
-  pool_.set_num_threads(8);
+  // Start the worker pool and dispatchers before accepting any connections so
+  // that the cost of spinning up threads isn't paid by the first clients to
+  // connect.
+  pool_.set_num_threads(num_workers_);
   pool_.run();
+  for (size_t i = 0; i < num_dispatchers_; ++i) {
+    auto* d = new ThreadPool();
+    d->set_num_threads(1);
+    d->run();
+    dispatchers_.push_back(d);
+  }
 
+  // Wait for requests. The timeout here only bounds how long it takes for us
+  // to notice a request to stop. 
+  vector<int> fds;
   while (!stop_requested()) {
-    mlock_.lock();
-    read_set = master_set;
-    mlock_.unlock();
-    select(max_fd+1, &read_set, nullptr, nullptr, &timeout);
-    for (auto i = 0; i <= max_fd; ++i) {
-      
-      // Not ready; nothing to do
-      if (!FD_ISSET(i, &read_set)) {
-        continue;
-      }
-
-      // Listener logic: New connections are added to the read set Note that
+    wait_for_requests(fds);
+    for (auto i : fds) {
+      // Listener logic: New connections are added to the active set. Note that
       // this is a write critical section for sockets so it is guarded against
       // race conditions with the state safe interrupt handler.
       if ((i == tl.descriptor()) || (i == ul.descriptor())) {
-        lock_guard<mutex> lg(slock_);
-        auto* sock = (i == tl.descriptor()) ? tl.accept() : ul.accept();
-        const auto fd = sock->descriptor();
-        mlock_.lock();
-        FD_SET(fd, &master_set);
-        mlock_.unlock();
-        if (fd > max_fd) {
-          max_fd = fd;
-          socks_.resize(max_fd+1, nullptr);
+        { lock_guard<mutex> lg(slock_);
+          auto* sock = (i == tl.descriptor()) ? tl.accept() : ul.accept();
+          const auto fd = sock->descriptor();
+          if (fd < 0) {
+            delete sock;
+          } else {
+            if (static_cast<size_t>(fd) >= socks_.size()) {
+              socks_.resize(fd+1, nullptr);
+            }
+            socks_[fd] = sock;
+            enable(fd);
+          }
         }
-        socks_[fd] = sock;
+        enable(i);
         continue;
       }
 
-      // Client: Grab the socket associated with this fd and handle the request
-      // Note that this is a read, which can't interfere with the state safe
-      // interrupt handler and thus doesn't need to be guarded.
-      auto* sock = socks_[i];
-      do {
-        Rpc rpc;
-        rpc.deserialize(*sock);
-        switch (rpc.type_) {
-
-          // Compiler ABI: Note that these methods remove elements from the
-          // sock index which aren't used anywhere else and thus don't need to
-          // be guarded.
-          case Rpc::Type::COMPILE: {
-            compile(sock, rpc);
-            sock = nullptr;
-            socks_[i] = nullptr;
-            mlock_.lock();
-            FD_CLR(i, &master_set);
-            mlock_.unlock();
-            break;
-          }
-          case Rpc::Type::STOP_COMPILE: {
-            stop_compile(sock, rpc);
-            sock = nullptr;
-            socks_[i] = nullptr;
-            mlock_.lock();
-            FD_CLR(i, &master_set);
-            mlock_.unlock();
-            break;
-          }
-
-          // Core ABI:
-          case Rpc::Type::GET_STATE:
-            get_state(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::SET_STATE:
-            set_state(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::GET_INPUT:
-            get_input(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::SET_INPUT:
-            set_input(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::FINALIZE:
-            finalize(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::OVERRIDES_DONE_STEP:
-            overrides_done_step(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::DONE_STEP:
-            done_step(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::OVERRIDES_DONE_SIMULATION:
-            overrides_done_simulation(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::DONE_SIMULATION:
-            done_simulation(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::READ:
-            read(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::EVALUATE:
-            evaluate(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::THERE_ARE_UPDATES:
-            there_are_updates(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::UPDATE:
-            update(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::THERE_WERE_TASKS:
-            there_were_tasks(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::CONDITIONAL_UPDATE:
-            conditional_update(sock, get_engine(rpc));
-            break;
-          case Rpc::Type::OPEN_LOOP:
-            open_loop(sock, get_engine(rpc), i);
-            break;
-
-          // Proxy Compiler Codes:
-          case Rpc::Type::OPEN_CONN_1: {
-            lock_guard<mutex> lg(slock_);
-            open_conn_1(sock, rpc);
-            mlock_.lock();
-            FD_CLR(sock->descriptor(), &master_set);
-            mlock_.unlock();
-            break;
-          }
-          case Rpc::Type::OPEN_CONN_2: {
-            lock_guard<mutex> lg(slock_);
-            open_conn_2(sock, rpc);
-            break;
-          }
-          case Rpc::Type::CLOSE_CONN: {
-            lock_guard<mutex> lg(slock_);
-            sock = nullptr;
-            delete socks_[sock_index_[rpc.pid_].first];
-            delete socks_[sock_index_[rpc.pid_].second];
-            socks_[sock_index_[rpc.pid_].first] = nullptr;
-            socks_[sock_index_[rpc.pid_].second] = nullptr;
-            mlock_.lock();
-            FD_CLR(sock_index_[rpc.pid_].second, &master_set);
-            mlock_.unlock();
-            sock_index_[rpc.pid_] = make_pair(-1,-1);
-            break;
-          }
-
-          // Proxy Core Codes:
-          case Rpc::Type::TEARDOWN_ENGINE:
-            teardown_engine(sock, rpc);
-            break;
-
-          // Control reaches here innocuosly when fds are closed remotely
-          default:
-            break;
+      // Client: Grab the socket associated with this fd and hand it off to
+      // the dispatcher which owns it. 
+      sockstream* sock = nullptr;
+      { lock_guard<mutex> lg(slock_);
+        if (static_cast<size_t>(i) < socks_.size()) {
+          sock = socks_[i];
+        }
+      }
+      if (sock == nullptr) {
+        continue;
+      }
+      dispatchers_[i % dispatchers_.size()]->insert([this, i, sock]{
+        if (handle(i, sock)) {
+          enable(i);
         }
-      } while ((sock != nullptr) && (sock->rdbuf()->in_avail() > 0));
+      });
     }
   }
 
-  // Stop all asynchronous compilation threads. 
+  // Stop all asynchronous compilation threads and dispatchers. 
   Compiler::stop_compile();
+  for (auto* d : dispatchers_) {
+    d->stop_now();
+    delete d;
+  }
+  dispatchers_.clear();
   pool_.stop_now();
 
   // We have exclusive access to the indices. Delete their contents.
@@ -301,6 +264,148 @@ void RemoteCompiler::run_logic() {
     }
   }
   socks_.clear();
+  pooled_.clear();
+#ifdef __linux__
+  ::close(epoll_);
+  epoll_ = -1;
+#endif
+  ::close(wakeup_[0]);
+  ::close(wakeup_[1]);
+}
+
+bool RemoteCompiler::handle(int i, sockstream* sock) {
+  do {
+    Rpc rpc;
+    rpc.deserialize(*sock);
+    // Pooled sockets stay open until their proxy compiler is torn down
+    if (sock->eof()) {
+      release(i);
+      return false;
+    }
+    switch (rpc.type_) {
+
+      // Compiler ABI: The socket is handed off along with the request and
+      // isn't re-enabled here, since pooled sockets may be recycled as soon as
+      // a reply is sent.
+      case Rpc::Type::COMPILE: {
+        { lock_guard<mutex> lg(slock_);
+          socks_[i] = nullptr;
+        }
+        compile(sock, rpc);
+        return false;
+      }
+      case Rpc::Type::STOP_COMPILE: {
+        { lock_guard<mutex> lg(slock_);
+          socks_[i] = nullptr;
+        }
+        stop_compile(sock, rpc);
+        return false;
+      }
+
+      // Core ABI:
+      case Rpc::Type::GET_STATE:
+        get_state(sock, get_engine(rpc), (get_caps(rpc) & Rpc::TAGGED_STATE) != 0);
+        break;
+      case Rpc::Type::SET_STATE:
+        set_state(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::GET_INPUT:
+        get_input(sock, get_engine(rpc), (get_caps(rpc) & Rpc::TAGGED_STATE) != 0);
+        break;
+      case Rpc::Type::SET_INPUT:
+        set_input(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::FINALIZE:
+        finalize(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::OVERRIDES_DONE_STEP:
+        overrides_done_step(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::DONE_STEP:
+        done_step(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::OVERRIDES_DONE_SIMULATION:
+        overrides_done_simulation(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::DONE_SIMULATION:
+        done_simulation(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::READ:
+        read(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::EVALUATE:
+        first_cycle(rpc);
+        evaluate(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::THERE_ARE_UPDATES:
+        there_are_updates(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::UPDATE:
+        update(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::THERE_WERE_TASKS:
+        there_were_tasks(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::CONDITIONAL_UPDATE:
+        conditional_update(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::OPEN_LOOP:
+        // The socket is re-enabled by the worker which runs this request
+        first_cycle(rpc);
+        open_loop(sock, get_engine(rpc), i);
+        return false;
+      case Rpc::Type::BATCH_EVALUATE:
+        first_cycle(rpc);
+        batch_evaluate(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::BATCH_UPDATE:
+        batch_update(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::BATCH_CONDITIONAL_UPDATE:
+        batch_conditional_update(sock, get_engine(rpc));
+        break;
+      case Rpc::Type::GET_STATE_DELTA:
+        get_state_delta(sock, get_engine(rpc), (get_caps(rpc) & Rpc::TAGGED_STATE) != 0);
+        break;
+      case Rpc::Type::CLEAR_STATE_DELTA:
+        clear_state_delta(sock, get_engine(rpc));
+        break;
+
+      // Proxy Compiler Codes: The asynchronous socket established by
+      // OPEN_CONN_1 is only ever written to, so it's never re-enabled.
+      case Rpc::Type::OPEN_CONN_1: {
+        lock_guard<mutex> lg(slock_);
+        open_conn_1(sock, rpc);
+        return false;
+      }
+      case Rpc::Type::OPEN_CONN_2: {
+        lock_guard<mutex> lg(slock_);
+        open_conn_2(sock, rpc);
+        break;
+      }
+      case Rpc::Type::CLOSE_CONN: {
+        lock_guard<mutex> lg(slock_);
+        delete socks_[sock_index_[rpc.pid_].first];
+        delete socks_[sock_index_[rpc.pid_].second];
+        socks_[sock_index_[rpc.pid_].first] = nullptr;
+        socks_[sock_index_[rpc.pid_].second] = nullptr;
+        disable(sock_index_[rpc.pid_].second);
+        sock_index_[rpc.pid_] = make_pair(-1,-1);
+        return false;
+      }
+
+      // Proxy Core Codes:
+      case Rpc::Type::TEARDOWN_ENGINE:
+        teardown_engine(sock, rpc);
+        break;
+
+      // Control reaches here innocuosly when fds are closed remotely
+      default:
+        break;
+    }
+  } while (sock->rdbuf()->in_avail() > 0);
+
+  return true;
 }
 
 void RemoteCompiler::compile(sockstream* sock, const Rpc& rpc) {
@@ -328,12 +433,32 @@ void RemoteCompiler::compile(sockstream* sock, const Rpc& rpc) {
     eid = engine_index_[rpc.pid_][rpc.eid_];
   }
 
+  // Record whether this request was able to skip connection setup and
+  // whether there's a worker sitting idle waiting to pick it up.
+  uint32_t caps = 0;
+  auto reused = false;
+  sockstream* isock = nullptr;
+  { lock_guard<mutex> lg(slock_);
+    caps = caps_index_[rpc.pid_];
+    isock = socks_[sock_index_[rpc.pid_].second];
+    const auto fd = static_cast<size_t>(sock->descriptor());
+    reused = (fd < pooled_.size()) && pooled_[fd];
+  }
+  const auto pooled = (caps & Rpc::POOLED_SOCKETS) != 0;
+  { lock_guard<mutex> lg(tlock_);
+    ++stats_.compiles;
+    stats_.socket_hits += reused ? 1 : 0;
+  }
+
   // Now create a new thread to compile the code, enter it into the
-  // engine table, and close the socket when it's done.
-  pool_.insert([this, sock, rpc, md, eid]{
+  // engine table, and recycle the socket when it's done.
+  const auto queued = chrono::steady_clock::now();
+  pool_.insert([this, sock, isock, caps, rpc, md, eid, pooled, queued]{
+    dequeue(queued);
     // TODO(eschkufz) Race condition here between when we set sock_ and when
-    // it's read.  Also, note the unguarded access to sock_index_
-    sock_ = socks_[sock_index_[rpc.pid_].second];
+    // it's read.
+    sock_ = isock;
+    caps_ = caps;
     assert(sock_ != nullptr);
     auto* e = Compiler::compile(eid, md);
 
@@ -347,7 +472,7 @@ void RemoteCompiler::compile(sockstream* sock, const Rpc& rpc) {
       Rpc(Rpc::Type::FAIL).serialize(*sock);
       sock->flush();
     }
-    delete sock;
+    recycle(sock, pooled);
   });
 }
 
@@ -363,14 +488,19 @@ void RemoteCompiler::stop_compile(sockstream* sock, const Rpc& rpc) {
   if (eid != -1) {
     Compiler::stop_compile(eid);
   }
+  const auto caps = get_caps(rpc);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
-  delete sock;
+  recycle(sock, (caps & Rpc::POOLED_SOCKETS) != 0);
 }
 
-void RemoteCompiler::get_state(sockstream* sock, Engine* e) {
+void RemoteCompiler::get_state(sockstream* sock, Engine* e, bool tagged) {
   auto* s = e->get_state();
-  s->serialize(*sock);
+  if (tagged) {
+    s->serialize(*sock);
+  } else {
+    s->serialize_legacy(*sock);
+  }
   delete s;
   sock->flush();
 }
@@ -382,9 +512,13 @@ void RemoteCompiler::set_state(sockstream* sock, Engine* e) {
   delete s;
 }
 
-void RemoteCompiler::get_input(sockstream* sock, Engine* e) {
+void RemoteCompiler::get_input(sockstream* sock, Engine* e, bool tagged) {
   auto* i = e->get_input();
-  i->serialize(*sock);
+  if (tagged) {
+    i->serialize(*sock);
+  } else {
+    i->serialize_legacy(*sock);
+  }
   delete i;
   sock->flush();
 }
@@ -400,6 +534,7 @@ void RemoteCompiler::finalize(sockstream* sock, Engine* e) {
   e->finalize();
   // This call to finalize will have primed the socket with tasks and writes
   // Appending an OKAY rpc indicates that everything has been sent
+  flush_writes(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -436,6 +571,7 @@ void RemoteCompiler::evaluate(sockstream* sock, Engine* e) {
   e->evaluate();
   // This call to evaluate will have primed the socket with tasks and writes
   // Appending an OKAY rpc, indicates that everything has been sent.
+  flush_writes(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -448,6 +584,7 @@ void RemoteCompiler::update(sockstream* sock, Engine* e) {
   e->update();
   // This call to update will have primed the socket with tasks and writes
   // Appending an OKAY rpc, indicates that everything has been sent.
+  flush_writes(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -460,6 +597,7 @@ void RemoteCompiler::conditional_update(sockstream* sock, Engine* e) {
   const auto res = e->conditional_update();
   // This call to conditional_update will have primed the socket with tasks and
   // writes Appending an OKAY rpc, indicates that everything has been sent.
+  flush_writes(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->put(res ? 1 : 0);
   sock->flush();
@@ -472,34 +610,90 @@ void RemoteCompiler::open_loop(sockstream* sock, Engine* e, int fd) {
   uint32_t itr = 0;
   sock->read(reinterpret_cast<char*>(&itr), 4);
 
-  mlock_.lock();
-  FD_CLR(fd, &(this->master_set));
-  mlock_.unlock();
   pool_.insert([this, sock, e, fd, clk, val, itr]{
     const uint32_t res = e->open_loop(clk, val, itr);
+    flush_writes(e);
     // This call to open_loop  will have primed the socket with tasks and
     // writes Appending an OKAY rpc, indicates that everything has been sent.
     Rpc(Rpc::Type::OKAY).serialize(*sock);
     sock->write(reinterpret_cast<const char*>(&res), 4);
     sock->flush();
-    mlock_.lock();
-    FD_SET(fd, &(this->master_set));
-    mlock_.unlock();
+    enable(fd);
   });
 }
 
+void RemoteCompiler::batch_evaluate(sockstream* sock, Engine* e) {
+  e->evaluate();
+  // As with evaluate(), the socket is now primed with tasks and writes. The
+  // terminating OKAY rpc carries the flags which would otherwise require
+  // separate round trips.
+  flush_writes(e);
+  Rpc(Rpc::Type::OKAY, 0, 0, get_flags(e)).serialize(*sock);
+  sock->flush();
+}
+
+void RemoteCompiler::batch_update(sockstream* sock, Engine* e) {
+  e->update();
+  flush_writes(e);
+  Rpc(Rpc::Type::OKAY, 0, 0, get_flags(e)).serialize(*sock);
+  sock->flush();
+}
+
+void RemoteCompiler::batch_conditional_update(sockstream* sock, Engine* e) {
+  const auto res = e->conditional_update();
+  flush_writes(e);
+  Rpc(Rpc::Type::OKAY, 0, 0, get_flags(e) | (res ? Rpc::RESULT : 0)).serialize(*sock);
+  sock->flush();
+}
+
+void RemoteCompiler::get_state_delta(sockstream* sock, Engine* e, bool tagged) {
+  const auto d = static_cast<Core::Delta>(sock->get());
+  auto* s = e->get_state_delta(d);
+  if (tagged) {
+    s->serialize(*sock);
+  } else {
+    s->serialize_legacy(*sock);
+  }
+  delete s;
+  sock->flush();
+}
+
+void RemoteCompiler::clear_state_delta(sockstream* sock, Engine* e) {
+  const auto d = static_cast<Core::Delta>(sock->get());
+  e->clear_state_delta(d);
+  Rpc(Rpc::Type::OKAY).serialize(*sock);
+  sock->flush();
+}
+
 void RemoteCompiler::open_conn_1(sockstream* sock, const Rpc& rpc) {
-  (void) rpc;
   const auto pid = sock_index_.size();
   sock_index_.push_back(make_pair(sock->descriptor(), 0));
-  Rpc(Rpc::Type::OKAY, pid, 0, 0).serialize(*sock);
+  // Reply with the subset of the client's protocol extensions that we support
+  caps_index_.push_back(rpc.n_ & Rpc::capabilities);
+  Rpc(Rpc::Type::OKAY, pid, 0, caps_index_.back()).serialize(*sock);
   sock->flush();
+
+  lock_guard<mutex> lg(tlock_);
+  open_times_.push_back(make_pair(chrono::steady_clock::now(), false));
+  ++stats_.sessions;
 }
 
 void RemoteCompiler::open_conn_2(sockstream* sock, const Rpc& rpc) {
   sock_index_[rpc.pid_].second = sock->descriptor();
-  Rpc(Rpc::Type::OKAY).serialize(*sock);
+
+  // If this request is followed by the name of a shared memory segment, try
+  // to attach to it. Either way, reply with whether we'll be using it.
+  shmsegment* seg = nullptr;
+  if (rpc.n_ == 1) {
+    string name = "";
+    getline(*sock, name, '\0');
+    seg = shmsegment::attach(name);
+  }
+  Rpc(Rpc::Type::OKAY, 0, 0, (seg != nullptr) ? 1 : 0).serialize(*sock);
   sock->flush();
+  if (seg != nullptr) {
+    sock->share(seg);
+  }
 }
 
 void RemoteCompiler::teardown_engine(sockstream* sock, const Rpc& rpc) {
@@ -511,9 +705,156 @@ void RemoteCompiler::teardown_engine(sockstream* sock, const Rpc& rpc) {
   }
 } 
 
+void RemoteCompiler::enable(int fd) {
+  { lock_guard<mutex> lg(mlock_);
+    if (static_cast<size_t>(fd) >= active_.size()) {
+      active_.resize(fd+1, false);
+    }
+    active_[fd] = true;
+#ifdef __linux__
+    // Sockets are armed for a single request at a time. Descriptors which are
+    // still registered from an earlier request are re-armed in place.
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.fd = fd;
+    if ((::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev) != 0) && (errno == EEXIST)) {
+      ::epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &ev);
+    }
+#endif
+  }
+#ifndef __linux__
+  wakeup();
+#endif
+}
+
+void RemoteCompiler::disable(int fd) {
+  lock_guard<mutex> lg(mlock_);
+  if (static_cast<size_t>(fd) < active_.size()) {
+    active_[fd] = false;
+  }
+#ifdef __linux__
+  ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+}
+
+void RemoteCompiler::wakeup() {
+  const char c = 0;
+  (void) ::write(wakeup_[1], &c, 1);
+}
+
+void RemoteCompiler::wait_for_requests(vector<int>& fds) {
+  fds.clear();
+  char buf[64];
+
+#ifdef __linux__
+  epoll_event evs[64];
+  const auto n = ::epoll_wait(epoll_, evs, 64, 10);
+  for (auto j = 0; j < n; ++j) {
+    if (evs[j].data.fd == wakeup_[0]) {
+      while (::read(wakeup_[0], buf, sizeof(buf)) > 0);
+    } else {
+      fds.push_back(evs[j].data.fd);
+    }
+  }
+#else
+  vector<pollfd> pfds;
+  pfds.push_back({wakeup_[0], POLLIN, 0});
+  mlock_.lock();
+  for (size_t i = 0, ie = active_.size(); i < ie; ++i) {
+    if (active_[i]) {
+      pfds.push_back({static_cast<int>(i), POLLIN, 0});
+    }
+  }
+  mlock_.unlock();
+
+  if (::poll(pfds.data(), pfds.size(), 10) <= 0) {
+    return;
+  }
+  if (pfds[0].revents != 0) {
+    while (::read(wakeup_[0], buf, sizeof(buf)) > 0);
+  }
+  // Disarm sockets which reported a request, as epoll would
+  for (size_t j = 1, je = pfds.size(); j < je; ++j) {
+    if (pfds[j].revents != 0) {
+      fds.push_back(pfds[j].fd);
+      disable(pfds[j].fd);
+    }
+  }
+#endif
+}
+
+void RemoteCompiler::recycle(sockstream* sock, bool pooled) {
+  if (!pooled) {
+    delete sock;
+    return;
+  }
+  // Return the socket to the active set. This is a write critical section for
+  // sockets, so it's guarded against the state safe interrupt handler.
+  const auto fd = sock->descriptor();
+  { lock_guard<mutex> lg(slock_);
+    socks_[fd] = sock;
+    if (static_cast<size_t>(fd) >= pooled_.size()) {
+      pooled_.resize(fd+1, false);
+    }
+    pooled_[fd] = true;
+  }
+  enable(fd);
+}
+
+void RemoteCompiler::release(int fd) {
+  lock_guard<mutex> lg(slock_);
+  if ((static_cast<size_t>(fd) >= pooled_.size()) || !pooled_[fd]) {
+    return;
+  }
+  delete socks_[fd];
+  socks_[fd] = nullptr;
+  pooled_[fd] = false;
+  disable(fd);
+}
+
+void RemoteCompiler::dequeue(chrono::steady_clock::time_point queued) {
+  lock_guard<mutex> lg(tlock_);
+  const auto dt = chrono::duration<double, milli>(chrono::steady_clock::now() - queued).count();
+  total_queue_ms_ += dt;
+  ++num_dequeued_;
+  stats_.mean_queue_ms = total_queue_ms_ / num_dequeued_;
+  stats_.max_queue_ms = max(stats_.max_queue_ms, dt);
+}
+
+void RemoteCompiler::first_cycle(const Rpc& rpc) {
+  lock_guard<mutex> lg(tlock_);
+  if ((rpc.pid_ >= open_times_.size()) || open_times_[rpc.pid_].second) {
+    return;
+  }
+  open_times_[rpc.pid_].second = true;
+
+  const auto dt = chrono::duration<double, milli>(chrono::steady_clock::now() - open_times_[rpc.pid_].first).count();
+  total_first_cycle_ms_ += dt;
+  ++num_first_cycles_;
+  stats_.mean_first_cycle_ms = total_first_cycle_ms_ / num_first_cycles_;
+  stats_.max_first_cycle_ms = max(stats_.max_first_cycle_ms, dt);
+}
+
 Engine* RemoteCompiler::get_engine(const Rpc& rpc) {
   lock_guard<mutex> lg(elock_);
   return engines_[engine_index_[rpc.pid_][rpc.eid_]][rpc.n_];
 }
 
+uint32_t RemoteCompiler::get_caps(const Rpc& rpc) {
+  lock_guard<mutex> lg(slock_);
+  return caps_index_[rpc.pid_];
+}
+
+void RemoteCompiler::flush_writes(Engine* e) {
+  // Every engine in this compiler was created with a remote interface
+  static_cast<RemoteInterface*>(e->get_interface())->flush_writes();
+}
+
+uint32_t RemoteCompiler::get_flags(Engine* e) {
+  uint32_t res = 0;
+  res |= e->there_are_updates() ? Rpc::UPDATES : 0;
+  res |= e->there_were_tasks() ? Rpc::TASKS : 0;
+  return res;
+}
+
 } // namespace cascade
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_TARGET_COMPILER_REMOTE_COMPILER_H
 #define CASCADE_SRC_TARGET_COMPILER_REMOTE_COMPILER_H
 
+#include <chrono>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -49,16 +50,43 @@ class RemoteCompiler : public Compiler, public Thread {
     RemoteCompiler();
     ~RemoteCompiler() override;
 
+    // Configuration Interface:
     RemoteCompiler& set_path(const std::string& p);
     RemoteCompiler& set_port(uint32_t p);
+    RemoteCompiler& set_num_workers(size_t n);
+    RemoteCompiler& set_num_dispatchers(size_t n);
+
+    // Statistics Interface:
+    //
+    // Counters describing how quickly remote engines were brought up. A socket
+    // hit is a compilation which arrived on a pooled connection rather than a
+    // freshly opened one, and pooled sockets is the number of pooled
+    // connections which are currently open. Queueing delay is measured from
+    // the moment a compilation request arrives to the moment a worker thread
+    // picks it up. Time to first cycle is measured from the moment a client
+    // opens a connection to its first evaluation request.
+    struct Stats {
+      size_t sessions;
+      size_t compiles;
+      size_t socket_hits;
+      size_t pooled_sockets;
+      double mean_queue_ms;
+      double max_queue_ms;
+      double mean_first_cycle_ms;
+      double max_first_cycle_ms;
+    };
+    Stats get_stats();
 
   private:
     // Configuration Options:
     std::string path_;
     uint32_t port_;
+    size_t num_workers_;
+    size_t num_dispatchers_;
 
     // Compiler Interface State:
     sockstream* sock_;
+    uint32_t caps_;
     ThreadPool pool_;
 
     // Socket and Engine Indices:
@@ -72,13 +100,70 @@ class RemoteCompiler : public Compiler, public Thread {
     std::vector<std::vector<Engine*>> engines_;
     // Maps a proxy core id to its asynchronous and synchronous socket ids
     std::vector<std::pair<int, int>> sock_index_;
+    // Maps a proxy core id to the protocol extensions it negotiated
+    std::vector<uint32_t> caps_index_;
     // Maps a proxy core / engine id to a local engine id
     std::vector<std::vector<int>> engine_index_;
 
-    // Socket management
-    fd_set master_set;
+    // Socket management:
+    //
+    // The ith element of this vector is true if fd=i is a pooled compilation
+    // socket. Clients which advertise the POOLED_SOCKETS extension reuse these
+    // sockets for COMPILE and STOP_COMPILE requests rather than opening a new
+    // one per request. They are returned to the active set after each reply
+    // and deleted when the client hangs up.
+    std::vector<bool> pooled_;
+    // The ith element of this vector is true if fd=i should be polled for
+    // incoming requests. A socket is disarmed as soon as it reports a request
+    // and re-enabled once that request has been handled, so that requests on
+    // a single connection are always handled one at a time and in order. On
+    // Linux this set is maintained by epoll. Elsewhere, changes are picked up
+    // by the request loop on its next iteration, and threads other than the
+    // request loop wake it up immediately by writing to the wakeup pipe.
+    std::vector<bool> active_;
+    int epoll_;
+    int wakeup_[2];
     std::mutex mlock_;
 
+    // Request Dispatch:
+    //
+    // Requests are handled by a fixed set of single-threaded dispatchers.
+    // Connections are sharded across dispatchers by descriptor, so that
+    // requests for engines belonging to different clients are handled in
+    // parallel.
+    std::vector<ThreadPool*> dispatchers_;
+
+    // Socket management helpers:
+    void enable(int fd);
+    void disable(int fd);
+    void wakeup();
+    void wait_for_requests(std::vector<int>& fds);
+    void recycle(sockstream* sock, bool pooled);
+    void release(int fd);
+
+    // Request Dispatch Helpers:
+    //
+    // Handles every request which is pending on a socket. Returns true if the
+    // socket should be re-enabled afterwards, or false if the socket was
+    // handed off or closed.
+    bool handle(int fd, sockstream* sock);
+
+    // Statistics State:
+    //
+    // The ith element of this vector holds the time at which proxy core i
+    // opened its connection, and whether it has run its first cycle.
+    std::vector<std::pair<std::chrono::steady_clock::time_point, bool>> open_times_;
+    double total_queue_ms_;
+    size_t num_dequeued_;
+    double total_first_cycle_ms_;
+    size_t num_first_cycles_;
+    Stats stats_;
+    std::mutex tlock_;
+
+    // Statistics Helpers:
+    void dequeue(std::chrono::steady_clock::time_point queued);
+    void first_cycle(const Rpc& rpc);
+
     // Compiler Interface:
     void schedule_state_safe_interrupt(Runtime::Interrupt int_) override;
     Interface* get_interface(const std::string& loc) override;
@@ -91,9 +176,9 @@ class RemoteCompiler : public Compiler, public Thread {
     void stop_compile(sockstream* sock, const Rpc& rpc);
     
     // Core Interface:
-    void get_state(sockstream* sock, Engine* e);
+    void get_state(sockstream* sock, Engine* e, bool tagged);
     void set_state(sockstream* sock, Engine* e);
-    void get_input(sockstream* sock, Engine* e);
+    void get_input(sockstream* sock, Engine* e, bool tagged);
     void set_input(sockstream* sock, Engine* e);
     void finalize(sockstream* sock, Engine* e);
 
@@ -111,6 +196,13 @@ class RemoteCompiler : public Compiler, public Thread {
     void conditional_update(sockstream* sock, Engine* e);
     void open_loop(sockstream* sock, Engine* e, int fd);
 
+    void batch_evaluate(sockstream* sock, Engine* e);
+    void batch_update(sockstream* sock, Engine* e);
+    void batch_conditional_update(sockstream* sock, Engine* e);
+
+    void get_state_delta(sockstream* sock, Engine* e, bool tagged);
+    void clear_state_delta(sockstream* sock, Engine* e);
+
     void open_conn_1(sockstream* sock, const Rpc& rpc);
     void open_conn_2(sockstream* sock, const Rpc& rpc);
 
@@ -118,6 +210,12 @@ class RemoteCompiler : public Compiler, public Thread {
 
     // Index Helpers:
     Engine* get_engine(const Rpc& rpc);
+    uint32_t get_caps(const Rpc& rpc);
+
+    // Batched Step Helpers:
+    uint32_t get_flags(Engine* e);
+    // Batched Write Helpers:
+    void flush_writes(Engine* e);
 };
 
 } // namespace cascade
@@ -32,17 +32,25 @@
 #define CASCADE_SRC_TARGET_INTERFACE_REMOTE_REMOTE_INTERFACE_H
 
 #include <cassert>
+#include <map>
+#include <unordered_map>
 #include "common/sockstream.h"
 #include "target/compiler/rpc.h"
+#include "target/compiler/write_batch.h"
 #include "target/interface.h"
 
 namespace cascade {
 
 class RemoteInterface : public Interface {
   public:
-    explicit RemoteInterface(sockstream* sock);
+    RemoteInterface(sockstream* sock, bool coalesce);
     ~RemoteInterface() override = default;
 
+    // Sends any writes which have been buffered since the previous call to
+    // this method. This must be called before replying to any request which
+    // may have caused writes.
+    void flush_writes();
+
     void write(VId id, const Bits* b) override;
     void write(VId id, bool b) override;
 
@@ -66,25 +74,88 @@ class RemoteInterface : public Interface {
       
   private:
     sockstream* sock_;
+
+    // Write Coalescing:
+    //
+    // If the proxy compiler on the other end of this connection supports
+    // batched writes, writes are buffered rather than sent immediately. Only
+    // the most recent value of each variable is kept, and values which are
+    // identical to the ones which were last sent are dropped entirely. This
+    // relies on the invariant that every variable has exactly one writer.
+    struct Value {
+      bool is_bool;
+      bool b;
+      Bits bits;
+    };
+    bool coalesce_;
+    std::map<VId, Value> pending_;
+    std::unordered_map<VId, Value> sent_;
 }; 
 
-inline RemoteInterface::RemoteInterface(sockstream* sock) : Interface() {
+inline RemoteInterface::RemoteInterface(sockstream* sock, bool coalesce) : Interface() {
   sock_ = sock;
+  coalesce_ = coalesce;
+}
+
+inline void RemoteInterface::flush_writes() {
+  if (pending_.empty()) {
+    return;
+  }
+
+  WriteBatch batch;
+  for (auto& p : pending_) {
+    auto& v = p.second;
+    const auto itr = sent_.find(p.first);
+    if (itr != sent_.end()) {
+      const auto& s = itr->second;
+      if (v.is_bool ? (s.is_bool && (s.b == v.b)) : (!s.is_bool && (s.bits.size() == v.bits.size()) && (s.bits == v.bits))) {
+        continue;
+      }
+    }
+    if (v.is_bool) {
+      batch.push_back(p.first, v.b);
+    } else {
+      batch.push_back(p.first, &v.bits);
+    }
+    sent_[p.first] = std::move(v);
+  }
+  pending_.clear();
+  if (batch.empty()) {
+    return;
+  }
+
+  const uint32_t len = batch.data().length();
+  Rpc(Rpc::Type::WRITE_BATCH, 0, 0, batch.size()).serialize(*sock_);
+  sock_->write(reinterpret_cast<const char*>(&len), sizeof(len));
+  sock_->write(batch.data().data(), len);
 }
 
 inline void RemoteInterface::write(VId id, const Bits* b) {
+  if (coalesce_) {
+    auto& v = pending_[id];
+    v.is_bool = false;
+    v.bits = *b;
+    return;
+  }
   Rpc(Rpc::Type::WRITE_BITS).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   b->serialize(*sock_);
 }
 
 inline void RemoteInterface::write(VId id, bool b) {
+  if (coalesce_) {
+    auto& v = pending_[id];
+    v.is_bool = true;
+    v.b = b;
+    return;
+  }
   Rpc(Rpc::Type::WRITE_BOOL).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->put(b ? 1 : 0);
 }
 
 inline void RemoteInterface::debug(uint32_t action, const std::string& arg) {
+  flush_writes();
   Rpc(Rpc::Type::DEBUG).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&action), 4);
   sock_->write(arg.c_str(), arg.length());
@@ -92,33 +163,39 @@ inline void RemoteInterface::debug(uint32_t action, const std::string& arg) {
 }
 
 inline void RemoteInterface::finish(uint32_t arg) {
+  flush_writes();
   Rpc(Rpc::Type::FINISH).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&arg), 4);
 }
 
 inline void RemoteInterface::restart(const std::string& path) {
+  flush_writes();
   Rpc(Rpc::Type::RESTART).serialize(*sock_);
   sock_->write(path.c_str(), path.length());
   sock_->put('\0');
 }
 
 inline void RemoteInterface::retarget(const std::string& s) {
+  flush_writes();
   Rpc(Rpc::Type::RETARGET).serialize(*sock_);
   sock_->write(s.c_str(), s.length());
   sock_->put('\0');
 }
 
 inline void RemoteInterface::save(const std::string& path) {
+  flush_writes();
   Rpc(Rpc::Type::SAVE).serialize(*sock_);
   sock_->write(path.c_str(), path.length());
   sock_->put('\0');
 }
 
 inline void RemoteInterface::yield() {
+  flush_writes();
   Rpc(Rpc::Type::YIELD).serialize(*sock_);
 }
 
 inline FId RemoteInterface::fopen(const std::string& path, uint8_t mode) {
+  flush_writes();
   Rpc(Rpc::Type::FOPEN).serialize(*sock_);
   sock_->write(path.c_str(), path.length());
   sock_->put('\0');
@@ -131,6 +208,7 @@ inline FId RemoteInterface::fopen(const std::string& path, uint8_t mode) {
 }
 
 inline int32_t RemoteInterface::in_avail(FId id) {
+  flush_writes();
   Rpc(Rpc::Type::IN_AVAIL).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->flush();
@@ -141,6 +219,7 @@ inline int32_t RemoteInterface::in_avail(FId id) {
 }
 
 inline uint32_t RemoteInterface::pubseekoff(FId id, int32_t off, uint8_t way, uint8_t which) {
+  flush_writes();
   Rpc(Rpc::Type::PUBSEEKOFF).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&off), sizeof(off));
@@ -154,6 +233,7 @@ inline uint32_t RemoteInterface::pubseekoff(FId id, int32_t off, uint8_t way, ui
 }
 
 inline uint32_t RemoteInterface::pubseekpos(FId id, int32_t pos, uint8_t which) {
+  flush_writes();
   Rpc(Rpc::Type::PUBSEEKPOS).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&pos), sizeof(pos));
@@ -166,6 +246,7 @@ inline uint32_t RemoteInterface::pubseekpos(FId id, int32_t pos, uint8_t which)
 }
 
 inline int32_t RemoteInterface::pubsync(FId id) {
+  flush_writes();
   Rpc(Rpc::Type::PUBSYNC).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->flush();
@@ -176,6 +257,7 @@ inline int32_t RemoteInterface::pubsync(FId id) {
 }
 
 inline int32_t RemoteInterface::sbumpc(FId id) {
+  flush_writes();
   Rpc(Rpc::Type::SBUMPC).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->flush();
@@ -186,6 +268,7 @@ inline int32_t RemoteInterface::sbumpc(FId id) {
 }
 
 inline int32_t RemoteInterface::sgetc(FId id) {
+  flush_writes();
   Rpc(Rpc::Type::SGETC).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->flush();
@@ -196,6 +279,7 @@ inline int32_t RemoteInterface::sgetc(FId id) {
 }
 
 inline uint32_t RemoteInterface::sgetn(FId id, char* c, uint32_t n) {
+  flush_writes();
   Rpc(Rpc::Type::SGETN).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&n), sizeof(n));
@@ -208,6 +292,7 @@ inline uint32_t RemoteInterface::sgetn(FId id, char* c, uint32_t n) {
 }
 
 inline int32_t RemoteInterface::sputc(FId id, char c) {
+  flush_writes();
   Rpc(Rpc::Type::SPUTC).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->put(c);
@@ -219,6 +304,7 @@ inline int32_t RemoteInterface::sputc(FId id, char c) {
 }
 
 inline uint32_t RemoteInterface::sputn(FId id, const char* c, uint32_t n) {
+  flush_writes();
   Rpc(Rpc::Type::SPUTN).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&n), sizeof(n));
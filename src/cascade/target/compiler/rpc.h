@@ -98,7 +98,54 @@ struct Rpc : Serializable {
     STATE_SAFE_FINISH,
 
     // Proxy Core Codes:
-    TEARDOWN_ENGINE
+    TEARDOWN_ENGINE,
+
+    // Batched Core Codes: These are only sent to peers which have advertised
+    // the BATCHED_STEP capability. New codes must be appended to the end of
+    // this enum so that older peers continue to agree on the values above.
+    BATCH_EVALUATE,
+    BATCH_UPDATE,
+    BATCH_CONDITIONAL_UPDATE,
+
+    // State Delta Codes: These are only sent to peers which have advertised
+    // the STATE_DELTA capability. The request is followed by a single byte
+    // which holds the Core::Delta channel that it applies to.
+    GET_STATE_DELTA,
+    CLEAR_STATE_DELTA,
+
+    // Batched Write Codes: These are only sent to peers which have advertised
+    // the BATCHED_WRITES capability. The n_ field holds the number of writes
+    // in the batch. See write_batch.h for the encoding which follows.
+    WRITE_BATCH
+  };
+
+  // Protocol Extensions:
+  //
+  // These bits are exchanged in the n_ field of OPEN_CONN_1 requests and
+  // responses. A client advertises the extensions that it supports and the
+  // server replies with the subset that it supports as well. Peers which
+  // predate an extension always send zero for its bit.
+  enum Capability : uint32_t {
+    BATCHED_STEP = 0x1,
+    SHARED_MEMORY = 0x2,
+    STATE_DELTA = 0x4,
+    BATCHED_WRITES = 0x8,
+    POOLED_SOCKETS = 0x10,
+    // States and inputs may be sent in the tagged format (see State::version_)
+    // rather than the legacy format.
+    TAGGED_STATE = 0x20
+  };
+  static constexpr uint32_t capabilities = BATCHED_STEP | SHARED_MEMORY | STATE_DELTA | BATCHED_WRITES | POOLED_SOCKETS | TAGGED_STATE;
+
+  // Batched Step Flags:
+  //
+  // The OKAY response to a BATCH_* request carries these bits in its n_ field.
+  // They hold the values of there_are_updates(), there_were_tasks(), and the
+  // result of conditional_update() (where applicable) following the request.
+  enum Flag : uint32_t {
+    UPDATES = 0x1,
+    TASKS = 0x2,
+    RESULT = 0x4
   };
 
   Rpc();
@@ -0,0 +1,171 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_COMPILER_WRITE_BATCH_H
+#define CASCADE_SRC_TARGET_COMPILER_WRITE_BATCH_H
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include "common/bits.h"
+#include "runtime/ids.h"
+
+namespace cascade {
+
+// A packed encoding of the writes which a remote engine performs during a
+// single request. Entries must be appended in ascending order of id. Each
+// entry consists of the difference between its id and the previous one,
+// followed by a header which either holds a boolean value, or the type and
+// width of a value which is stored in the minimum number of bytes. Ids and
+// headers are encoded as variable-length integers, so the common case of a
+// narrow output costs only a few bytes.
+
+class WriteBatch {
+  public:
+    // Constructors:
+    WriteBatch();
+
+    // Encoding Interface:
+    void push_back(VId id, const Bits* b);
+    void push_back(VId id, bool b);
+    bool empty() const;
+    size_t size() const;
+    const std::string& data() const;
+
+    // Decoding Interface:
+    //
+    // Invokes w(id, b) for every entry in the n bytes starting at c, where b
+    // is either a bool or a pointer to a Bits. Returns false if the encoding
+    // is malformed.
+    template <typename W>
+    static bool decode(const char* c, size_t n, W w);
+
+  private:
+    std::string data_;
+    size_t size_;
+    VId last_;
+
+    void put_id(VId id);
+    void put_varint(uint64_t v);
+    static const char* get_varint(const char* c, const char* end, uint64_t& v);
+};
+
+inline WriteBatch::WriteBatch() {
+  size_ = 0;
+  last_ = 0;
+}
+
+inline void WriteBatch::push_back(VId id, const Bits* b) {
+  put_id(id);
+  put_varint((static_cast<uint64_t>(b->size()) << 3) | (static_cast<uint64_t>(b->get_type()) << 1));
+  const auto offset = data_.length();
+  data_.resize(offset + (b->size()+7)/8);
+  b->write_bytes(&data_[offset]);
+}
+
+inline void WriteBatch::push_back(VId id, bool b) {
+  put_id(id);
+  put_varint(b ? 0x3 : 0x1);
+}
+
+inline bool WriteBatch::empty() const {
+  return size_ == 0;
+}
+
+inline size_t WriteBatch::size() const {
+  return size_;
+}
+
+inline const std::string& WriteBatch::data() const {
+  return data_;
+}
+
+template <typename W>
+inline bool WriteBatch::decode(const char* c, size_t n, W w) {
+  const auto* end = c + n;
+  VId id = 0;
+  Bits bits;
+  while (c < end) {
+    uint64_t delta = 0;
+    uint64_t header = 0;
+    if ((c = get_varint(c, end, delta)) == nullptr) {
+      return false;
+    }
+    if ((c = get_varint(c, end, header)) == nullptr) {
+      return false;
+    }
+    id += delta;
+
+    if (header & 0x1) {
+      w(id, (header & 0x2) != 0);
+      continue;
+    }
+    const auto width = static_cast<size_t>(header >> 3);
+    const auto len = (width+7)/8;
+    if (static_cast<size_t>(end - c) < len) {
+      return false;
+    }
+    bits.read_bytes(c, width, static_cast<Bits::Type>((header >> 1) & 0x3));
+    w(id, &bits);
+    c += len;
+  }
+  return true;
+}
+
+inline void WriteBatch::put_id(VId id) {
+  assert(empty() || (id > last_));
+  put_varint(id - last_);
+  last_ = id;
+  ++size_;
+}
+
+inline void WriteBatch::put_varint(uint64_t v) {
+  while (v >= 0x80) {
+    data_.push_back(static_cast<char>((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  data_.push_back(static_cast<char>(v));
+}
+
+inline const char* WriteBatch::get_varint(const char* c, const char* end, uint64_t& v) {
+  v = 0;
+  for (size_t shift = 0; (c < end) && (shift < 64); shift += 7) {
+    const auto b = static_cast<uint8_t>(*c++);
+    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return c;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace cascade
+
+#endif
@@ -44,6 +44,16 @@ class State;
 
 class Core {
   public:
+    // Change tracking channels. Each consumer of incremental state tracks its
+    // changes independently, so that, for example, a migration which is in
+    // progress doesn't reset the changes that the next incremental checkpoint
+    // needs to record.
+    enum class Delta : uint8_t {
+      CHECKPOINT = 0,
+      MIGRATION
+    };
+    static constexpr size_t num_deltas = 2;
+
     explicit Core(Interface* interface);
     virtual ~Core() = default;
 
@@ -54,9 +64,17 @@ class Core {
     virtual State* get_state() = 0;
     // This method must update the value of any non-volatile stateful elements
     // contained in this module. It may ignore values for volatile elements. It
-    // is called exactly once before finalize(), and may be called multiple
-    // times thereafter.
+    // is called at least once before finalize(), and may be called multiple
+    // times thereafter. Values which are not present in s must be left alone.
     virtual void set_state(const State* s) = 0;
+    // Target-specific implementations may override these methods to support
+    // incremental checkpoints and migration. get_state_delta(d) must return at
+    // least those non-volatile stateful elements which have changed since the
+    // previous call to clear_state_delta(d), regardless of any calls for other
+    // channels. The default implementations return get_state() and do
+    // nothing.
+    virtual State* get_state_delta(Delta d);
+    virtual void clear_state_delta(Delta d);
     // This method must return the values of all inputs connected to this
     // module. It may be called multiple times before this core is torn down.
     virtual Input* get_input() = 0;
@@ -119,14 +137,17 @@ class Core {
     // performance-specific advantage to doing so. This method is only called
     // in a state where the entire program has been inlined into this core such
     // that the only input clk, is the runtime's clock, it has value val, and
-    // there are no outputs. This method must run for up to itr iterations, or
-    // until a system task is generated before returning control. On return it
-    // must report the number of iterations that it ran for. 
+    // its outputs (if any) are only read by leds. This method must run for up
+    // to itr iterations, or until a system task is generated before returning
+    // control. Changes to outputs must be reported before returning, though
+    // only their final values need be. On return it must report the number
+    // of iterations that it ran for. 
     virtual size_t open_loop(VId clk, bool val, size_t itr);
 
     // Light-weight RTTI:
     virtual bool is_clock() const;
     virtual bool is_custom() const;
+    virtual bool is_led() const;
     virtual bool is_logic() const;
     virtual bool is_stub() const;
 
@@ -165,6 +186,7 @@ class Led : public Core {
   public:
     using Core::Core;
     bool there_were_tasks() const override;
+    bool is_led() const override;
 };
 
 class Logic : public Core { 
@@ -189,6 +211,16 @@ inline Core::Core(Interface* interface) {
   interface_ = interface;
 }
 
+inline State* Core::get_state_delta(Delta d) {
+  (void) d;
+  return get_state();
+}
+
+inline void Core::clear_state_delta(Delta d) {
+  (void) d;
+  // Does nothing.
+}
+
 inline void Core::finalize() {
   // Does nothing.
 }
@@ -246,6 +278,10 @@ inline bool Core::is_custom() const {
   return false;
 }
 
+inline bool Core::is_led() const {
+  return false;
+}
+
 inline bool Core::is_logic() const {
   return false;
 }
@@ -278,6 +314,10 @@ inline bool Led::there_were_tasks() const {
   return false;
 }
 
+inline bool Led::is_led() const {
+  return true;
+}
+
 inline bool Logic::is_logic() const {
   return true;
 }
@@ -30,6 +30,8 @@
 
 #include "target/core/aos/amorphos/amorphos_logic.h"
 
+#include <vector>
+
 namespace cascade::aos {
 
 AmorphosLogic::AmorphosLogic(Interface* interface, ModuleDeclaration* md, size_t slot, syncbuf* reqs, syncbuf* resps) : AosLogic<uint64_t>(interface, md) {
@@ -76,6 +78,41 @@ AmorphosLogic::AmorphosLogic(Interface* interface, ModuleDeclaration* md, size_t
     //std::cout << "w " << index << " " << val << std::endl;
     reqs->sputn(reinterpret_cast<const char*>(bytes), 11);
   });
+  // Bursts send every request in a single message, and then wait for all of
+  // the responses at once. Responses are returned in request order.
+  get_table()->set_read_burst([slot, reqs, resps](size_t index, uint64_t* vals, size_t n) {
+    std::vector<uint8_t> bytes(8*n);
+    const uint8_t packed = (1 << 7) | slot;
+    for (size_t i = 0; i < n; ++i) {
+      const uint16_t vid = index + i;
+      bytes[3*i+0] = packed;
+      bytes[3*i+1] = vid >> 0;
+      bytes[3*i+2] = vid >> 8;
+    }
+    reqs->sputn(reinterpret_cast<const char*>(bytes.data()), 3*n);
+    resps->waitforn(reinterpret_cast<char*>(bytes.data()), 8*n);
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t result = 0;
+      for (size_t j = 8; j > 0; --j) {
+        result = (result << 8) | bytes[8*i+j-1];
+      }
+      vals[i] = result;
+    }
+  });
+  get_table()->set_write_burst([slot, reqs](size_t index, const uint64_t* vals, size_t n) {
+    std::vector<uint8_t> bytes(11*n);
+    const uint8_t packed = (1 << 7) | (1 << 6) | slot;
+    for (size_t i = 0; i < n; ++i) {
+      const uint16_t vid = index + i;
+      bytes[11*i+0] = packed;
+      bytes[11*i+1] = vid >> 0;
+      bytes[11*i+2] = vid >> 8;
+      for (size_t j = 0; j < 8; ++j) {
+        bytes[11*i+3+j] = vals[i] >> (8*j);
+      }
+    }
+    reqs->sputn(reinterpret_cast<const char*>(bytes.data()), 11*n);
+  });
 }
 
 } // namespace cascade::aos
@@ -94,6 +94,7 @@ class AosLogic : public Logic {
   private:
     // Compiler State:
     Callback cb_;
+    const Identifier* clock_;
 
     // Source Management:
     ModuleDeclaration* src_;
@@ -169,6 +170,7 @@ template <typename T>
 inline AosLogic<T>::AosLogic(Interface* interface, ModuleDeclaration* src) : Logic(interface), sync_(this) { 
   src_ = src;
   cb_ = nullptr;
+  clock_ = nullptr;
   tasks_.push_back(nullptr);
   
   eval_.set_feof_handler([this](Evaluate* eval, const FeofExpression* fe) {
@@ -311,6 +313,8 @@ inline void AosLogic<T>::finalize() {
   // synchronizing stream state.
   StreamSync ss(this);
   src_->accept(&ss);
+
+  clock_ = open_loop_clock();
 }
 
 template <typename T>
@@ -351,9 +355,12 @@ inline bool AosLogic<T>::there_were_tasks() const {
 
 template <typename T>
 inline size_t AosLogic<T>::open_loop(VId clk, bool val, size_t itr) {
-  // The fpga already knows the value of clk. We can ignore it.
-  (void) clk;
-  (void) val;
+  // If this module wasn't compiled with an open loop clock, the fpga can't
+  // toggle it on our behalf. Fall back on stepping one clock at a time.
+  if (clock_ == nullptr) {
+    return Logic::open_loop(clk, val, itr);
+  }
+  // Otherwise, the fpga already knows the value of clk. We can ignore it.
 
   there_were_tasks_ = false;
 
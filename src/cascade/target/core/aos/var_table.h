@@ -34,6 +34,7 @@
 #include <cassert>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 #include "common/bits.h"
 #include "common/vector.h"
 #include "verilog/analyze/evaluate.h"
@@ -58,6 +59,8 @@ class VarTable {
     // IO Typedefs:
     typedef std::function<T(size_t)> Read;
     typedef std::function<void(size_t, T)> Write;
+    typedef std::function<void(size_t, T*, size_t)> ReadBurst;
+    typedef std::function<void(size_t, const T*, size_t)> WriteBurst;
 
     // Iterator Typedefs:
     typedef typename std::unordered_map<const Identifier*, const Row>::const_iterator const_iterator;
@@ -68,6 +71,10 @@ class VarTable {
     // Configuration Interface:
     VarTable& set_read(Read read);
     VarTable& set_write(Write write);
+    // Optional: Transfers a contiguous range of words in a single request.
+    // Tables without burst handlers fall back on one read or write per word.
+    VarTable& set_read_burst(ReadBurst read_burst);
+    VarTable& set_write_burst(WriteBurst write_burst);
 
     // Inserts an element into the table.
     void insert(const Identifier* id);
@@ -117,10 +124,16 @@ class VarTable {
   private:
     Read read_;
     Write write_;
+    ReadBurst read_burst_;
+    WriteBurst write_burst_;
 
     size_t next_index_;
     std::unordered_map<const Identifier*, const Row> vtable_;
 
+    // Burst Helpers:
+    void read_range(size_t index, T* data, size_t n) const;
+    void write_range(size_t index, const T* data, size_t n);
+
     constexpr size_t bits_per_word() const;
 };
 
@@ -130,6 +143,8 @@ using VarTable64 = VarTable<uint64_t>;
 
 template <typename T>
 inline VarTable<T>::VarTable() {
+  read_burst_ = nullptr;
+  write_burst_ = nullptr;
   next_index_ = debug_index() + 1;
 }
 
@@ -145,6 +160,18 @@ inline VarTable<T>& VarTable<T>::set_write(Write write) {
   return *this;
 }
 
+template <typename T>
+inline VarTable<T>& VarTable<T>::set_read_burst(ReadBurst read_burst) {
+  read_burst_ = read_burst;
+  return *this;
+}
+
+template <typename T>
+inline VarTable<T>& VarTable<T>::set_write_burst(WriteBurst write_burst) {
+  write_burst_ = write_burst;
+  return *this;
+}
+
 template <typename T>
 inline void VarTable<T>::insert(const Identifier* id) {
   assert(find(id) == end());
@@ -255,13 +282,15 @@ inline void VarTable<T>::read_var(const Identifier* id) const {
   const auto itr = vtable_.find(id);
   assert(itr != vtable_.end());
 
-  auto idx = itr->second.begin;
+  const auto n = itr->second.elements * itr->second.words_per_element;
+  std::vector<T> words(n);
+  read_range(itr->second.begin, words.data(), n);
+
+  size_t idx = 0;
   for (size_t i = 0; i < itr->second.elements; ++i) {
     for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-      const volatile auto word = read_(idx);
-      Evaluate().assign_word<T>(id, i, j, word);
-      ++idx;
-    } 
+      Evaluate().assign_word<T>(id, i, j, words[idx++]);
+    }
   }
 }
 
@@ -271,12 +300,12 @@ inline void VarTable<T>::write_var(const Identifier* id, const Bits& val) {
   assert(itr != vtable_.end());
   assert(itr->second.elements == 1);
 
-  auto idx = itr->second.begin;
-  for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-    const volatile auto word = val.read_word<T>(j);
-    write_(idx, word);
-    ++idx;
+  const auto n = itr->second.words_per_element;
+  std::vector<T> words(n);
+  for (size_t j = 0; j < n; ++j) {
+    words[j] = val.read_word<T>(j);
   }
+  write_range(itr->second.begin, words.data(), n);
 }
 
 template <typename T>
@@ -285,14 +314,39 @@ inline void VarTable<T>::write_var(const Identifier* id, const Vector<Bits>& val
   assert(itr != vtable_.end());
   assert(val.size() == itr->second.elements);
 
-  auto idx = itr->second.begin;
+  const auto n = itr->second.elements * itr->second.words_per_element;
+  std::vector<T> words(n);
+  size_t idx = 0;
   for (size_t i = 0; i < itr->second.elements; ++i) {
     for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-      const volatile auto word = val[i].read_word<T>(j);
-      write_(idx, word);
-      ++idx;
+      words[idx++] = val[i].read_word<T>(j);
     }
   }
+  write_range(itr->second.begin, words.data(), n);
+}
+
+template <typename T>
+inline void VarTable<T>::read_range(size_t index, T* data, size_t n) const {
+  if (read_burst_ != nullptr) {
+    read_burst_(index, data, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const volatile auto word = read_(index + i);
+    data[i] = word;
+  }
+}
+
+template <typename T>
+inline void VarTable<T>::write_range(size_t index, const T* data, size_t n) {
+  if (write_burst_ != nullptr) {
+    write_burst_(index, data, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const volatile auto word = data[i];
+    write_(index + i, word);
+  }
 }
 
 template <typename T>
@@ -31,6 +31,8 @@
 #ifndef CASCADE_SRC_TARGET_CORE_AVMM_AVALON_AVALON_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_AVMM_AVALON_AVALON_LOGIC_H
 
+#include <cstring>
+#include <vector>
 #include "target/core/common/syncbuf.h"
 #include "target/core/avmm/avalon/avalon_logic.h"
 #include "target/core/avmm/avmm_logic.h"
@@ -79,6 +81,28 @@ inline AvalonLogic<V,A,T>::AvalonLogic(Interface* interface, ModuleDeclaration*
       reqs->sputn(reinterpret_cast<const char*>(bytes), 13);
     });
   }
+  // Bursts pack every request into a single message, and then wait for all of
+  // the responses at once.
+  AvmmLogic<V,A,T>::get_table()->set_read_burst([reqs, resps](A index, T* vals, size_t n) {
+    std::vector<uint8_t> bytes(n * (1 + sizeof(A)));
+    for (size_t i = 0; i < n; ++i) {
+      const A addr = index + i;
+      bytes[i * (1 + sizeof(A))] = 2;
+      memcpy(&bytes[i * (1 + sizeof(A)) + 1], &addr, sizeof(A));
+    }
+    reqs->sputn(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    resps->waitforn(reinterpret_cast<char*>(vals), n * sizeof(T));
+  });
+  AvmmLogic<V,A,T>::get_table()->set_write_burst([reqs](A index, const T* vals, size_t n) {
+    std::vector<uint8_t> bytes(n * (1 + sizeof(A) + sizeof(T)));
+    for (size_t i = 0; i < n; ++i) {
+      const A addr = index + i;
+      bytes[i * (1 + sizeof(A) + sizeof(T))] = 1;
+      memcpy(&bytes[i * (1 + sizeof(A) + sizeof(T)) + 1], &addr, sizeof(A));
+      memcpy(&bytes[i * (1 + sizeof(A) + sizeof(T)) + 1 + sizeof(A)], &vals[i], sizeof(T));
+    }
+    reqs->sputn(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  });
 }
 
 } // namespace cascade::avmm
@@ -78,6 +78,30 @@ class AvmmCompiler : public CoreCompiler {
     // to stop the execution of any invocations of compile().
     virtual void stop_compile() = 0;
 
+    // Avalon Memory Mapped Compiler Interface (Separate Compilation)
+    //
+    // Targets which can compile each slot into a separate unit should
+    // override these methods, in which case compile() and stop_compile() are
+    // never invoked. compile_slot() is passed text which contains only the
+    // module in that slot. It is called without holding the global lock on
+    // this compiler, and may run concurrently with compilations for other
+    // slots. It should return true on success and must not disturb the logic
+    // running in any other slot. load_slot() is called while holding the
+    // global lock once a compilation has succeeded and will not be stopped,
+    // and should install its result. stop_slot() should stop any invocation
+    // of compile_slot() for that slot.
+    virtual bool separate_slots() const;
+    virtual bool compile_slot(size_t slot, const std::string& text);
+    virtual void load_slot(size_t slot);
+    virtual void stop_slot(size_t slot);
+
+    // Avalon Memory Mapped Compiler Interface (Device Sharing)
+    //
+    // Returns true if every slot is backed by the same device, in which case
+    // requests to that device are serialized. Targets which provide each slot
+    // with a device of its own should override this method to return false.
+    virtual bool shared_device() const;
+
   private:
     // Compilation States:
     enum class State : uint8_t {
@@ -94,6 +118,13 @@ class AvmmCompiler : public CoreCompiler {
       std::string text;
     };
 
+    // Device Management:
+    //
+    // Logic cores may be driven from different threads (say, on behalf of
+    // different remote clients). If their slots share a device, requests to
+    // that device are serialized by this lock.
+    std::mutex device_lock_;
+
     // Program Management:
     std::mutex lock_;
     std::condition_variable cv_;
@@ -102,6 +133,9 @@ class AvmmCompiler : public CoreCompiler {
     // Core Compiler Interface:
     AvmmLogic<V,A,T>* compile_logic(Engine::Id id, ModuleDeclaration* md, Interface* interface) override;
 
+    // Compilation Helpers:
+    AvmmLogic<V,A,T>* compile_separate(Engine::Id id, const ModuleDeclaration* md, size_t slot, AvmmLogic<V,A,T>* al, std::unique_lock<std::mutex>& lg);
+
     // Slot Management Helpers:
     int get_free() const;
     void release(size_t slot);
@@ -109,6 +143,8 @@ class AvmmCompiler : public CoreCompiler {
 
     // Codegen Helpers:
     std::string get_text();
+    std::string get_text(size_t slot);
+    std::string get_text(const std::map<MId, std::string>& text);
 };
 
 template <size_t M, size_t V, typename A, typename T>
@@ -121,6 +157,18 @@ template <size_t M, size_t V, typename A, typename T>
 inline void AvmmCompiler<M,V,A,T>::stop_compile(Engine::Id id) {
   std::lock_guard<std::mutex> lg(lock_);
 
+  // Targets which compile slots separately only need to stop the slots which
+  // are working on this id. 
+  if (separate_slots()) {
+    for (size_t i = 0, ie = slots_.size(); i < ie; ++i) {
+      if ((slots_[i].id == id) && (slots_[i].state == State::COMPILING)) {
+        slots_[i].state = State::STOPPED;
+        stop_slot(i);
+      }
+    }
+    return;
+  }
+
   // Free any slot with this id which is in the compiling or waiting state. 
   auto stopped = false;
   auto need_new_lead = false;
@@ -164,23 +212,6 @@ inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_logic(Engine::Id id, Mod
   std::unique_lock<std::mutex> lg(lock_);
   ModuleInfo info(md);
 
-  // Check for unsupported language features
-  auto unsupported = false;
-  if (info.uses_mixed_triggers()) {
-    get_compiler()->error("Avmm backends do not currently support code with mixed triggers!");
-    unsupported = true;
-  } else if (!info.implied_latches().empty()) {
-    get_compiler()->error("Avmm backends do not currently support the use of implied latches!");
-    unsupported = true;
-  } else if (info.uses_multiple_clocks()) {
-    get_compiler()->error("Avmm backends do not currently support the use of multiple clocks!");
-    unsupported = true;
-  }
-  if (unsupported) {
-    delete md;
-    return nullptr;
-  }
-
   // Find a free slot 
   const auto slot = get_free();
   if (slot == -1) {
@@ -194,6 +225,9 @@ inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_logic(Engine::Id id, Mod
   // final invocation of index_tasks is lexicographic by construction, as it's
   // based on a recursive descent of the AST.
   auto* al = build(interface, md, slot);
+  if (shared_device()) {
+    al->get_table()->set_lock(&device_lock_);
+  }
   std::map<VId, const Identifier*> is;
   for (auto* i : info.inputs()) {
     is.insert(std::make_pair(to_vid(i), i));
@@ -217,10 +251,13 @@ inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_logic(Engine::Id id, Mod
   }
   al->index_tasks();
   // Check table and index sizes. If this program uses too much state, we won't
-  // be able to uniquely name its elements using our current addressing scheme.
+  // be able to uniquely name its elements (or the task fifo and state mask
+  // windows which sit past the end of the table) using our current addressing
+  // scheme.
 
   const auto max_vars = T(1) << V;
-  if (al->get_table()->size() >= max_vars) {
+  const auto* vt = al->get_table();
+  if ((vt->size() + vt->fifo_depth() + vt->state_mask_words()) >= max_vars) {
     std::stringstream ss;
     ss << "Avmm backends do not currently support more than " << max_vars << " entries in variable table";
     get_compiler()->error(ss.str());
@@ -228,6 +265,12 @@ inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_logic(Engine::Id id, Mod
     return nullptr;
   }
 
+  // Targets which compile slots separately don't need to coordinate with the
+  // other slots.
+  if (separate_slots()) {
+    return compile_separate(id, md, slot, al, lg);
+  }
+
   // Downgrade any compilation slots to waiting slots, and stop any slots that
   // are working on this id.
   for (auto& s : slots_) {
@@ -269,6 +312,67 @@ inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_logic(Engine::Id id, Mod
   }
 }
 
+template <size_t M, size_t V, typename A, typename T>
+inline bool AvmmCompiler<M,V,A,T>::separate_slots() const {
+  return false;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline bool AvmmCompiler<M,V,A,T>::compile_slot(size_t slot, const std::string& text) {
+  (void) slot;
+  (void) text;
+  return false;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void AvmmCompiler<M,V,A,T>::load_slot(size_t slot) {
+  (void) slot;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void AvmmCompiler<M,V,A,T>::stop_slot(size_t slot) {
+  (void) slot;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline bool AvmmCompiler<M,V,A,T>::shared_device() const {
+  return true;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline AvmmLogic<V,A,T>* AvmmCompiler<M,V,A,T>::compile_separate(Engine::Id id, const ModuleDeclaration* md, size_t slot, AvmmLogic<V,A,T>* al, std::unique_lock<std::mutex>& lg) {
+  // Stop any other slots that are working on this id.
+  for (size_t i = 0, ie = slots_.size(); i < ie; ++i) {
+    if ((slots_[i].id == id) && (slots_[i].state == State::COMPILING)) {
+      slots_[i].state = State::STOPPED;
+      stop_slot(i);
+    }
+  }
+
+  // Claim this slot and compile it without holding the lock, so that other
+  // slots can compile alongside it.
+  slots_[slot].id = id;
+  slots_[slot].state = State::COMPILING;
+  slots_[slot].text = Rewrite<M,V,A,T>().run(md, slot, al->get_table(), al->open_loop_clock());
+  const auto text = get_text(slot);
+  lg.unlock();
+  const auto res = compile_slot(slot, text);
+  lg.lock();
+
+  // If compilation succeeded and no one stopped us in the meantime, this slot
+  // is ready to go. Otherwise, it's free to be used again.
+  if (res && (slots_[slot].state == State::COMPILING)) {
+    load_slot(slot);
+    slots_[slot].state = State::CURRENT;
+    al->set_callback([this, slot]{release(slot);});
+    return al;
+  }
+  slots_[slot].state = State::FREE;
+  cv_.notify_all();
+  delete al;
+  return nullptr;
+}
+
 template <size_t M, size_t V, typename A, typename T>
 inline int AvmmCompiler<M,V,A,T>::get_free() const {
   for (size_t i = 0, ie = slots_.size(); i < ie; ++i) {
@@ -302,16 +406,28 @@ inline void AvmmCompiler<M,V,A,T>::update() {
 
 template <size_t M, size_t V, typename A, typename T>
 inline std::string AvmmCompiler<M,V,A,T>::get_text() {
-  std::stringstream ss;
-  indstream os(ss);
-
-  // Generate code for modules
+  // Generate code for every slot which is in use
   std::map<MId, std::string> text;
   for (size_t i = 0, ie = slots_.size(); i < ie; ++i) {
     if (slots_[i].state != State::FREE) {
       text.insert(std::make_pair(i, slots_[i].text));
     }
   }
+  return get_text(text);
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline std::string AvmmCompiler<M,V,A,T>::get_text(size_t slot) {
+  // Generate code for this slot only
+  std::map<MId, std::string> text;
+  text.insert(std::make_pair(slot, slots_[slot].text));
+  return get_text(text);
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline std::string AvmmCompiler<M,V,A,T>::get_text(const std::map<MId, std::string>& text) {
+  std::stringstream ss;
+  indstream os(ss);
 
   // Module Declarations
   for (const auto& s : text) {
@@ -31,8 +31,11 @@
 #ifndef CASCADE_SRC_TARGET_CORE_AVMM_AVMM_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_AVMM_AVMM_LOGIC_H
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <functional>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 #include "common/bits.h"
@@ -74,6 +77,8 @@ class AvmmLogic : public Logic {
     // Core Interface:
     State* get_state() override;
     void set_state(const State* s) override;
+    State* get_state_delta(Delta d) override;
+    void clear_state_delta(Delta d) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
     void finalize() override;
@@ -93,28 +98,46 @@ class AvmmLogic : public Logic {
     // Compiler State:
     Callback cb_;
     size_t slot_;
+    const Identifier* clock_;
 
     // Source Management:
     ModuleDeclaration* src_;
     std::vector<const Identifier*> inputs_;
     std::unordered_map<VId, const Identifier*> state_;
+    std::vector<VId> tracked_;
     std::vector<std::pair<const Identifier*, VId>> outputs_;
     std::vector<const SystemTaskEnableStatement*> tasks_;
 
     // Control State:
     bool there_were_tasks_;
+    bool publish_all_;
     VarTable<V,A,T> table_;
     std::unordered_map<FId, interfacestream*> streams_;
 
+    // Change Tracking:
+    //
+    // The hardware sets a bit in the state mask whenever it applies an update
+    // to a tracked variable. Once clear_state_delta(d) has been called, the
+    // bits which are read back are accumulated in changes_[d].
+    std::array<bool, num_deltas> track_changes_;
+    std::array<std::vector<bool>, num_deltas> changes_;
+    std::vector<T> state_mask_;
+
     // Control Helpers:
     interfacestream* get_stream(FId fd);
     bool handle_tasks();
+    void drain_fifo();
+    void put(const PutStatement* ps);
+    void publish_outputs();
+    void poll_changes();
+    void record_change(size_t i);
 
     // Feof Helpers:
     void set_feof_mask(FId fd, bool val);
 
     // Indexes system tasks and inserts the identifiers which appear in those
-    // tasks into the variable table.
+    // tasks into the variable table. Puts are also recorded as candidates for
+    // the task fifo.
     class Inserter : public Visitor {
       public:
         explicit Inserter(AvmmLogic* av);
@@ -122,6 +145,8 @@ class AvmmLogic : public Logic {
       private:
         AvmmLogic* av_;
         bool in_args_;
+        bool saw_feof_;
+        std::vector<const Identifier*> args_;
         void visit(const Identifier* id) override;
         void visit(const FeofExpression* fe) override;
         void visit(const DebugStatement* ds) override;
@@ -169,7 +194,10 @@ inline AvmmLogic<V,A,T>::AvmmLogic(Interface* interface, ModuleDeclaration* src,
   src_ = src;
   cb_ = nullptr;
   slot_ = slot;
+  clock_ = nullptr;
   tasks_.push_back(nullptr);
+  publish_all_ = true;
+  track_changes_.fill(false);
 
   eval_.set_feof_handler([this](Evaluate* eval, const FeofExpression* fe) {
     fe->accept_fd(&sync_);
@@ -211,6 +239,8 @@ inline AvmmLogic<V,A,T>& AvmmLogic<V,A,T>::set_state(bool is_volatile, const Ide
   }   
   if (!is_volatile) {
     state_.insert(std::make_pair(vid, id));
+    tracked_.push_back(vid);
+    table_.track(id);
   }
   return *this;
 }
@@ -221,6 +251,11 @@ inline AvmmLogic<V,A,T>& AvmmLogic<V,A,T>::set_output(const Identifier* id, VId
     table_.insert(id);
   }
   outputs_.push_back(std::make_pair(id, vid));
+  // Keep outputs in var table order. This is the order that the hardware uses
+  // to assign bits in the output mask.
+  std::sort(outputs_.begin(), outputs_.end(), [this](const auto& x, const auto& y) {
+    return table_.find(x.first)->second.begin < table_.find(y.first)->second.begin;
+  });
   return *this;
 }
 
@@ -259,15 +294,52 @@ inline State* AvmmLogic<V,A,T>::get_state() {
 
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::set_state(const State* s) {
-  table_.write_control_var(table_.reset_index(), 1);
+  table_.write_control_var(slot_, table_.reset_index(), 1);
   for (const auto& sv : state_) {
     const auto itr = s->find(sv.first);
     if (itr != s->end()) {
       table_.write_var(slot_, sv.second, itr->second);
     }
   }
-  table_.write_control_var(table_.reset_index(), 1);
-  table_.write_control_var(table_.resume_index(), 1);
+  table_.write_control_var(slot_, table_.reset_index(), 1);
+  table_.write_control_var(slot_, table_.resume_index(), 1);
+  publish_all_ = true;
+
+  // Writes from the host bypass the update queue, so the hardware won't report
+  // them. Record them here instead.
+  for (size_t i = 0, ie = tracked_.size(); i < ie; ++i) {
+    if (s->find(tracked_[i]) != s->end()) {
+      record_change(i);
+    }
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline State* AvmmLogic<V,A,T>::get_state_delta(Delta d) {
+  const auto c = static_cast<size_t>(d);
+  if (!track_changes_[c]) {
+    return get_state();
+  }
+  poll_changes();
+  auto* s = new State();
+  for (size_t i = 0, ie = tracked_.size(); i < ie; ++i) {
+    if (changes_[c][i]) {
+      const auto* id = state_[tracked_[i]];
+      table_.read_var(slot_, id);
+      s->insert(tracked_[i], eval_.get_array_value(id));
+    }
+  }
+  return s;
+}
+
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::clear_state_delta(Delta d) {
+  // Drain the hardware mask first, so that changes which haven't been read
+  // back yet are still credited to the other channels.
+  poll_changes();
+  const auto c = static_cast<size_t>(d);
+  track_changes_[c] = true;
+  changes_[c].assign(tracked_.size(), false);
 }
 
 template <size_t V, typename A, typename T>
@@ -286,7 +358,7 @@ inline Input* AvmmLogic<V,A,T>::get_input() {
 
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::set_input(const Input* i) {
-  table_.write_control_var(table_.reset_index(), 1);
+  table_.write_control_var(slot_, table_.reset_index(), 1);
   for (size_t v = 0, ve = inputs_.size(); v < ve; ++v) {
     const auto* id = inputs_[v];
     if (id == nullptr) {
@@ -297,8 +369,9 @@ inline void AvmmLogic<V,A,T>::set_input(const Input* i) {
       table_.write_var(slot_, id, itr->second);
     }
   }
-  table_.write_control_var(table_.reset_index(), 1);
-  table_.write_control_var(table_.resume_index(), 1);
+  table_.write_control_var(slot_, table_.reset_index(), 1);
+  table_.write_control_var(slot_, table_.resume_index(), 1);
+  publish_all_ = true;
 }
 
 template <size_t V, typename A, typename T>
@@ -310,6 +383,8 @@ inline void AvmmLogic<V,A,T>::finalize() {
   // synchronizing stream state.
   StreamSync ss(this);
   src_->accept(&ss);
+
+  clock_ = open_loop_clock();
 }
 
 template <size_t V, typename A, typename T>
@@ -323,22 +398,43 @@ template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::evaluate() {
   there_were_tasks_ = false;
   while (handle_tasks()) {
-    table_.write_control_var(table_.resume_index(), 1);
+    table_.write_control_var(slot_, table_.resume_index(), 1);
   }
-  for (const auto& o : outputs_) {
+  publish_outputs();
+}
+
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::publish_outputs() {
+  if (outputs_.empty()) {
+    return;
+  }
+
+  // Only read back the outputs which the hardware reports as having changed
+  // since the last evaluation. Everything is read back on the first
+  // evaluation after this module's state or inputs are overwritten, as the
+  // runtime may not yet have seen those values.
+  const auto top = static_cast<size_t>(std::numeric_limits<T>::digits-1);
+  const auto mask = table_.read_control_var(slot_, table_.output_mask_index());
+  for (size_t i = 0, ie = outputs_.size(); i < ie; ++i) {
+    const auto bit = std::min(i, top);
+    if (!publish_all_ && (((mask >> bit) & 1) == 0)) {
+      continue;
+    }
+    const auto& o = outputs_[i];
     table_.read_var(slot_, o.first);
     interface()->write(o.second, &eval_.get_value(o.first));
   }
+  publish_all_ = false;
 }
 
 template <size_t V, typename A, typename T>
 inline bool AvmmLogic<V,A,T>::there_are_updates() const {
-  return table_.read_control_var(table_.there_are_updates_index()) != 0;
+  return table_.read_control_var(slot_, table_.there_are_updates_index()) != 0;
 }
 
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::update() {
-  table_.write_control_var(table_.apply_update_index(), 1);
+  table_.write_control_var(slot_, table_.apply_update_index(), 1);
   evaluate();
 }
 
@@ -349,9 +445,12 @@ inline bool AvmmLogic<V,A,T>::there_were_tasks() const {
 
 template <size_t V, typename A, typename T>
 inline size_t AvmmLogic<V,A,T>::open_loop(VId clk, bool val, size_t itr) {
-  // The fpga already knows the value of clk. We can ignore it.
-  (void) clk;
-  (void) val;
+  // If this module wasn't compiled with an open loop clock, the fpga can't
+  // toggle it on our behalf. Fall back on stepping one clock at a time.
+  if (clock_ == nullptr) {
+    return Logic::open_loop(clk, val, itr);
+  }
+  // Otherwise, the fpga already knows the value of clk. We can ignore it.
 
   there_were_tasks_ = false;
 
@@ -359,25 +458,29 @@ inline size_t AvmmLogic<V,A,T>::open_loop(VId clk, bool val, size_t itr) {
   // ticks.  Loop here either until control returns without having hit a task
   // (indicating that we've finished) or it trips a task that requires
   // immediate attention.
-  table_.write_control_var(table_.open_loop_index(), itr);
+  table_.write_control_var(slot_, table_.open_loop_index(), itr);
   while (handle_tasks() && !there_were_tasks_) {
-    table_.write_control_var(table_.resume_index(), 1);
+    table_.write_control_var(slot_, table_.resume_index(), 1);
   }
 
   // If we hit a task that requires immediate attention, clear the open loop
   // counter, finish out this clock, and return the number of iterations that
   // we ran for. Otherwise, we finished our quota.
   if (there_were_tasks_) {
-    const auto res = table_.read_control_var(table_.open_loop_index());
-    table_.write_control_var(table_.open_loop_index(), 0);
+    const auto res = table_.read_control_var(slot_, table_.open_loop_index());
+    table_.write_control_var(slot_, table_.open_loop_index(), 0);
     while (handle_tasks()) {
-      table_.write_control_var(table_.resume_index(), 1);
+      table_.write_control_var(slot_, table_.resume_index(), 1);
     }
+    publish_outputs();
     // Note: res was recorded *before* the completion of the current iteration
     return itr-res+1;
-  } else {
-    return itr;
   }
+
+  // Otherwise we finished our quota. Outputs may have changed any number of
+  // times along the way, but only their final values need to be reported.
+  publish_outputs();
+  return itr;
 }
 
 template <size_t V, typename A, typename T>
@@ -389,9 +492,6 @@ inline const Identifier* AvmmLogic<V,A,T>::open_loop_clock() {
   if (eval_.get_width(*info.inputs().begin()) != 1) {
     return nullptr;
   }
-  if (!info.outputs().empty()) {
-    return nullptr;
-  }
   return *ModuleInfo(src_).inputs().begin();
 }
 
@@ -408,7 +508,15 @@ inline interfacestream* AvmmLogic<V,A,T>::get_stream(FId fd) {
 
 template <size_t V, typename A, typename T>
 inline bool AvmmLogic<V,A,T>::handle_tasks() {
-  volatile auto task_id = table_.read_control_var(table_.there_were_tasks_index());
+  // Anything in the task fifo was logged before the task that the hardware is
+  // reporting, so drain it first. Logged tasks are only reported when the fifo
+  // is full, and draining the fifo is enough to release them.
+  volatile auto task_id = table_.read_control_var(slot_, table_.there_were_tasks_index());
+  drain_fifo();
+  while (table_.fifo_tasks().find(static_cast<size_t>(task_id)) != table_.fifo_tasks().end()) {
+    task_id = table_.read_control_var(slot_, table_.there_were_tasks_index());
+    drain_fifo();
+  }
   if (task_id == 0) {
     return false;
   }
@@ -481,15 +589,8 @@ inline bool AvmmLogic<V,A,T>::handle_tasks() {
     case Node::Tag::put_statement: {
       const auto* ps = static_cast<const PutStatement*>(task);
       ps->accept_fd(&sync_);
-      const auto fd = eval_.get_value(ps->get_fd()).to_uint();
-      auto* is = get_stream(fd);
-
       ps->accept_expr(&sync_);
-      printf_.write(*is, &eval_, ps);
-      if (is->eof()) {
-        set_feof_mask(fd, true);
-      }
-
+      put(ps);
       break;
     }
     case Node::Tag::restart_statement: {
@@ -523,33 +624,116 @@ inline bool AvmmLogic<V,A,T>::handle_tasks() {
   return true;
 }
 
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::drain_fifo() {
+  if (table_.fifo_tasks().empty()) {
+    return;
+  }
+  const auto n = table_.read_control_var(slot_, table_.task_fifo_index());
+  if (n == 0) {
+    return;
+  }
+
+  // Read the contents of the fifo in a single burst and pop them before
+  // replaying the records. The fifo only ever holds whole records.
+  std::vector<T> words(n);
+  table_.read_fifo(slot_, words.data(), n);
+  table_.write_control_var(slot_, table_.task_fifo_index(), n);
+
+  for (size_t i = 0; i < n; ) {
+    const auto task_id = words[i++];
+    const auto itr = table_.fifo_tasks().find(task_id);
+    assert(itr != table_.fifo_tasks().end());
+    for (auto* a : itr->second) {
+      for (size_t j = 0, je = table_.find(a)->second.words_per_element; j < je; ++j) {
+        Evaluate().assign_word<T>(a, 0, j, words[i++]);
+      }
+    }
+    assert(tasks_[task_id]->is(Node::Tag::put_statement));
+    put(static_cast<const PutStatement*>(tasks_[task_id]));
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::put(const PutStatement* ps) {
+  const auto fd = eval_.get_value(ps->get_fd()).to_uint();
+  auto* is = get_stream(fd);
+
+  printf_.write(*is, &eval_, ps);
+  if (is->eof()) {
+    set_feof_mask(fd, true);
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::poll_changes() {
+  // Reading the control variable latches and clears the mask. There's no need
+  // to bother the hardware if no one is listening.
+  if (std::find(track_changes_.begin(), track_changes_.end(), true) == track_changes_.end()) {
+    return;
+  }
+  const auto n = table_.read_control_var(slot_, table_.state_mask_index());
+  if (n == 0) {
+    return;
+  }
+  assert(n == table_.state_mask_words());
+  state_mask_.resize(n);
+  table_.read_state_mask(slot_, state_mask_.data(), n);
+
+  const auto digits = std::numeric_limits<T>::digits;
+  for (size_t i = 0, ie = tracked_.size(); i < ie; ++i) {
+    if ((state_mask_[i / digits] >> (i % digits)) & 1) {
+      record_change(i);
+    }
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline void AvmmLogic<V,A,T>::record_change(size_t i) {
+  for (size_t c = 0; c < num_deltas; ++c) {
+    if (track_changes_[c]) {
+      changes_[c][i] = true;
+    }
+  }
+}
+
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::set_feof_mask(FId fd, bool val) {
   const auto fid = fd & 0x7fff'ffff;
-  table_.write_control_var(table_.feof_index(), (fid << 1) | (val ? 1 : 0));
+  table_.write_control_var(slot_, table_.feof_index(), (fid << 1) | (val ? 1 : 0));
 }
 
 template <size_t V, typename A, typename T>
 inline AvmmLogic<V,A,T>::Inserter::Inserter(AvmmLogic* av) : Visitor() {
   av_ = av;
   in_args_ = false;
+  saw_feof_ = false;
 }
 
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::Inserter::visit(const Identifier* id) {
   Visitor::visit(id);
+  if (!in_args_) {
+    return;
+  }
   const auto* r = Resolve().get_resolution(id);
-  if (in_args_ && (av_->table_.find(r) == av_->table_.end())) {
+  if (av_->table_.find(r) == av_->table_.end()) {
     av_->table_.insert(r);
   }
+  if (std::find(args_.begin(), args_.end(), r) == args_.end()) {
+    args_.push_back(r);
+  }
 }
 
 template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::Inserter::visit(const FeofExpression* fe) {
-  // Don't insert this into the task index
+  // Don't insert this into the task index. Feof depends on the state of a
+  // stream, which can't be captured in hardware.
+  const auto in_args = in_args_;
   in_args_ = true;
+  saw_feof_ = true;
   fe->accept_fd(this);
-  in_args_ = false;
+  in_args_ = in_args;
 }
 
 template <size_t V, typename A, typename T>
@@ -595,9 +779,17 @@ template <size_t V, typename A, typename T>
 inline void AvmmLogic<V,A,T>::Inserter::visit(const PutStatement* ps) {
   av_->tasks_.push_back(ps);
   in_args_ = true;
+  saw_feof_ = false;
+  args_.clear();
   ps->accept_fd(this);
   ps->accept_expr(this);
   in_args_ = false;
+
+  // Puts which only depend on the values of their arguments can be logged to
+  // the task fifo, and replayed by the host in bulk.
+  if (!saw_feof_) {
+    av_->table_.insert_fifo_task(av_->tasks_.size()-1, args_);
+  }
 }
 
 template <size_t V, typename A, typename T>
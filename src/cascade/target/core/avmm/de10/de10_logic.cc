@@ -42,6 +42,20 @@ De10Logic::De10Logic(Interface* interface, ModuleDeclaration* md, size_t slot, v
     auto* maddr = reinterpret_cast<volatile uint8_t*>(addr + (index << 2));
     DE10_WRITE(maddr, val);
   });
+  // Bursts walk the mapped region directly rather than paying for a callback
+  // per word.
+  get_table()->set_read_burst([addr](uint16_t index, uint32_t* vals, size_t n) {
+    auto* maddr = reinterpret_cast<volatile uint8_t*>(addr + (index << 2));
+    for (size_t i = 0; i < n; ++i, maddr += 4) {
+      vals[i] = DE10_READ(maddr);
+    }
+  });
+  get_table()->set_write_burst([addr](uint16_t index, const uint32_t* vals, size_t n) {
+    auto* maddr = reinterpret_cast<volatile uint8_t*>(addr + (index << 2));
+    for (size_t i = 0; i < n; ++i, maddr += 4) {
+      DE10_WRITE(maddr, vals[i]);
+    }
+  });
 }
 
 } // namespace cascade::avmm
@@ -46,7 +46,9 @@ namespace cascade::avmm {
 // continuation-passing state machines which can be combined later on into a
 // single monolithic always @(posedge __clk) block. This pass uses system tasks
 // as landmarks, but recall that they've been replaced by non-blocking assigns
-// to __next_task_id in pass 1.
+// to __next_task_id in pass 1. Level-triggered blocks which assign to the
+// variable table (recall that after pass 1, these can only be implied
+// latches) are lowered the same way, so that latches become clocked state.
 
 template <typename T>
 class Machinify {
@@ -88,7 +90,7 @@ class Machinify {
         // non-blocking assign task_id <= 0;
         void next_state();
         // Transforms an event into a trigger signal
-        Identifier* to_guard(const Event* e) const;
+        Expression* to_guard(const Event* e) const;
     };
 
     typedef typename std::vector<Generate>::const_iterator const_iterator;
@@ -111,6 +113,17 @@ class Machinify {
         bool res_;
         void visit(const BlockingAssign* ba) override;
     };
+    // Checks whether an always construct contains any assignments to the
+    // variable table.
+    class LatchCheck : public Visitor {
+      public:
+        LatchCheck();
+        ~LatchCheck() override = default;
+        bool run(const Node* n);
+      private:
+        bool res_;
+        void visit(const BlockingAssign* ba) override;
+    };
 
     std::vector<Generate> generators_;
 };
@@ -160,7 +173,7 @@ inline void Machinify<T>::Generate::run(const EventControl* ec, const Statement*
     guard = new BinaryExpression(to_guard(*i), BinaryExpression::Op::PPIPE, guard);
   }
   machine_->push_front_stmts(new ConditionalStatement(
-    new Identifier("__continue"),
+    new Identifier(new Id("__continue"), new Number(Bits(std::numeric_limits<T>::digits, idx_))),
     new BlockingAssign(new Identifier(new Id("__task_id"), new Number(Bits(std::numeric_limits<T>::digits, idx_))), new Number(Bits(std::numeric_limits<T>::digits, 0))),
     new SeqBlock()));
   machine_->push_back_stmts(new BlockingAssign(
@@ -343,7 +356,7 @@ inline void Machinify<T>::Generate::transition(size_t n) {
 template <typename T>
 inline void Machinify<T>::Generate::transition(SeqBlock* sb, size_t n) {
   sb->push_back_stmts(new BlockingAssign(
-    new Identifier(new Id("__state"), new Number(Bits(std::numeric_limits<T>::digits, 0))),
+    new Identifier(new Id("__state"), new Number(Bits(std::numeric_limits<T>::digits, idx_))),
     new Number(Bits(std::numeric_limits<T>::digits, n))
   ));
 }
@@ -366,7 +379,7 @@ inline void Machinify<T>::Generate::next_state() {
 }
 
 template <typename T>
-inline Identifier* Machinify<T>::Generate::to_guard(const Event* e) const {
+inline Expression* Machinify<T>::Generate::to_guard(const Event* e) const {
   assert(e->get_expr()->is(Node::Tag::identifier));
   const auto* i = static_cast<const Identifier*>(e->get_expr());
   switch (e->get_type()) {
@@ -374,6 +387,15 @@ inline Identifier* Machinify<T>::Generate::to_guard(const Event* e) const {
       return new Identifier(i->front_ids()->get_readable_sid()+"_negedge");
     case Event::Type::POSEDGE:
       return new Identifier(i->front_ids()->get_readable_sid()+"_posedge");
+    case Event::Type::EDGE: {
+      // Level events only appear here alongside edges or in blocks which
+      // hold latches. They fire whenever the (possibly subscripted) value
+      // differs from its value on the previous clock.
+      auto* prev = i->clone();
+      prev->purge_ids();
+      prev->push_back_ids(new Id(i->front_ids()->get_readable_sid()+"_prev"));
+      return new BinaryExpression(prev, BinaryExpression::Op::BEQ, i->clone());
+    }
     default:
       assert(false);
       return nullptr;
@@ -396,13 +418,19 @@ inline void Machinify<T>::run(ModuleDeclaration* md) {
       continue;
     }
 
-    // Ignore combinational always constructs
+    // Ignore combinational always constructs. Constructs which mix level
+    // events with at least one edge are treated as edge-triggered, as are
+    // level-triggered constructs which hold implied latches.
     auto* ac = static_cast<AlwaysConstruct*>(*i);
     assert(ac->get_stmt()->is(Node::Tag::timing_control_statement));
     auto* tcs = static_cast<const TimingControlStatement*>(ac->get_stmt());
     assert(tcs->get_ctrl()->is(Node::Tag::event_control));
     auto* ec = static_cast<const EventControl*>(tcs->get_ctrl());
-    if (ec->empty_events() || (ec->front_events()->get_type() == Event::Type::EDGE)) {
+    auto combinational = true;
+    for (auto j = ec->begin_events(), je = ec->end_events(); j != je; ++j) {
+      combinational = combinational && ((*j)->get_type() == Event::Type::EDGE);
+    }
+    if (combinational && !LatchCheck().run(tcs->get_stmt())) {
       ++i;
       continue;
     }
@@ -443,6 +471,25 @@ inline void Machinify<T>::TaskCheck::visit(const BlockingAssign* ba) {
   }
 }
 
+template <typename T>
+inline Machinify<T>::LatchCheck::LatchCheck() : Visitor() { } 
+
+template <typename T>
+inline bool Machinify<T>::LatchCheck::run(const Node* n) {
+  res_ = false; 
+  n->accept(this);
+  return res_;
+}
+
+template <typename T>
+inline void Machinify<T>::LatchCheck::visit(const BlockingAssign* ba) {
+  for (auto i = ba->begin_lhs(), ie = ba->end_lhs(); i != ie; ++i) {
+    if ((*i)->eq("__var")) {
+      res_ = true;
+    }
+  }
+}
+
 } // namespace cascade::avmm
 
 #endif
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_TARGET_CORE_AVMM_REWRITE_H
 #define CASCADE_SRC_TARGET_CORE_AVMM_REWRITE_H
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <set>
@@ -56,13 +57,22 @@ class Rewrite {
     std::string run(const ModuleDeclaration* md, size_t slot, const VarTable<V,A,T>* vt, const Identifier* clock);
 
   private:
-    // Records variables which appear in timing control statements
+    // Records variables which appear in timing control statements. Level
+    // events are only recorded when they're mixed with edges, or when they
+    // guard a block which assigns to an implied latch.
     struct TriggerIndex : Visitor {
-      TriggerIndex();
+      TriggerIndex(const ModuleDeclaration* md);
       ~TriggerIndex() override = default;
+      const ModuleDeclaration* md_;
+      const EventControl* level_;
       std::map<std::string, const Identifier*> negedges_;
       std::map<std::string, const Identifier*> posedges_;
+      std::map<std::string, const Identifier*> levels_;
+      void visit(const BlockingAssign* ba) override;
       void visit(const Event* e) override;
+      void visit(const EventControl* ec) override;
+      void visit(const TimingControlStatement* tcs) override;
+      void record_levels(const EventControl* ec);
     };
 
     void emit_state_machine_vars(ModuleDeclaration* res, const Machinify<T>* mfy);
@@ -74,6 +84,9 @@ class Rewrite {
     void emit_state_vars(ModuleDeclaration* res);
     void emit_trigger_vars(ModuleDeclaration* res, const TriggerIndex* ti);
     void emit_open_loop_vars(ModuleDeclaration* res);
+    void emit_output_mask_vars(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt);
+    void emit_state_mask_vars(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
+    void emit_fifo_vars(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
 
     void emit_avalon_logic(ModuleDeclaration* res);
     void emit_update_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
@@ -81,6 +94,9 @@ class Rewrite {
     void emit_trigger_logic(ModuleDeclaration* res, const TriggerIndex* ti);
     void emit_open_loop_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
     void emit_var_logic(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt, const Machinify<T>* mfy, const Identifier* open_loop_clock);
+    void emit_output_mask_logic(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt);
+    void emit_state_mask_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
+    void emit_fifo_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt);
     void emit_output_logic(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt);
           
     void emit_subscript(Identifier* id, size_t idx, size_t n, const std::vector<size_t>& arity) const;
@@ -92,7 +108,7 @@ inline std::string Rewrite<M,V,A,T>::run(const ModuleDeclaration* md, size_t slo
   std::stringstream ss;
 
   // Generate index tables before doing anything even remotely invasive
-  TriggerIndex ti;
+  TriggerIndex ti(md);
   md->accept(&ti);
 
   // Emit a new declaration, with module name based on slot id. This
@@ -117,6 +133,9 @@ inline std::string Rewrite<M,V,A,T>::run(const ModuleDeclaration* md, size_t slo
   emit_state_vars(res);
   emit_trigger_vars(res, &ti);
   emit_open_loop_vars(res);
+  emit_output_mask_vars(res, md, vt);
+  emit_state_mask_vars(res, vt);
+  emit_fifo_vars(res, vt);
 
   // Emit original program logic
   TextMangle<V,A,T> tm(md, vt);
@@ -131,6 +150,9 @@ inline std::string Rewrite<M,V,A,T>::run(const ModuleDeclaration* md, size_t slo
   emit_trigger_logic(res, &ti);
   emit_open_loop_logic(res, vt);
   emit_var_logic(res, md, vt, &mfy, clock);
+  emit_output_mask_logic(res, md, vt);
+  emit_state_mask_logic(res, vt);
+  emit_fifo_logic(res, vt);
   emit_output_logic(res, md, vt);
 
   // Final cleanup passes
@@ -144,7 +166,25 @@ inline std::string Rewrite<M,V,A,T>::run(const ModuleDeclaration* md, size_t slo
 }
 
 template <size_t M, size_t V, typename A, typename T>
-inline Rewrite<M,V,A,T>::TriggerIndex::TriggerIndex() : Visitor() { }
+inline Rewrite<M,V,A,T>::TriggerIndex::TriggerIndex(const ModuleDeclaration* md) : Visitor() { 
+  md_ = md;
+  level_ = nullptr;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::TriggerIndex::visit(const BlockingAssign* ba) {
+  Visitor::visit(ba);
+  if (level_ == nullptr) {
+    return;
+  }
+  ModuleInfo info(md_);
+  for (auto i = ba->begin_lhs(), ie = ba->end_lhs(); i != ie; ++i) {
+    if (info.is_implied_latch(*i)) {
+      record_levels(level_);
+      return;
+    }
+  }
+}
 
 template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::TriggerIndex::visit(const Event* e) {
@@ -161,16 +201,60 @@ inline void Rewrite<M,V,A,T>::TriggerIndex::visit(const Event* e) {
       posedges_[r->front_ids()->get_readable_sid()] = r;
       break;
     default:
-      // Don't record untyped edges
+      // Untyped edges are handled by the enclosing event control
       break;
   }
 }
 
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::TriggerIndex::visit(const EventControl* ec) {
+  Visitor::visit(ec);
+
+  auto mixed = false;
+  for (auto i = ec->begin_events(), ie = ec->end_events(); i != ie; ++i) {
+    mixed = mixed || ((*i)->get_type() != Event::Type::EDGE);
+  }
+  if (mixed) {
+    record_levels(ec);
+  }
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::TriggerIndex::visit(const TimingControlStatement* tcs) {
+  // Keep track of whether we're inside of a purely level-triggered block
+  level_ = nullptr;
+  if (tcs->get_ctrl()->is(Node::Tag::event_control)) {
+    const auto* ec = static_cast<const EventControl*>(tcs->get_ctrl());
+    level_ = ec;
+    for (auto i = ec->begin_events(), ie = ec->end_events(); i != ie; ++i) {
+      if ((*i)->get_type() != Event::Type::EDGE) {
+        level_ = nullptr;
+        break;
+      }
+    }
+  }
+  Visitor::visit(tcs);
+  level_ = nullptr;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::TriggerIndex::record_levels(const EventControl* ec) {
+  for (auto i = ec->begin_events(), ie = ec->end_events(); i != ie; ++i) {
+    if ((*i)->get_type() == Event::Type::EDGE) {
+      assert((*i)->get_expr()->is(Node::Tag::identifier));
+      const auto* r = Resolve().get_resolution(static_cast<const Identifier*>((*i)->get_expr()));
+      assert(r != nullptr);
+      levels_[r->front_ids()->get_readable_sid()] = r;
+    }
+  }
+}
+
 template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::emit_state_machine_vars(ModuleDeclaration* res, const Machinify<T>* mfy) {
   ItemBuilder ib;
   ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __task_id[" << (mfy->end()-mfy->begin()-1) << ":0];" << std::endl;
   ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __state[" << (mfy->end()-mfy->begin()-1) << ":0];" << std::endl;
+  ib << "wire[" << (std::max(static_cast<size_t>(mfy->end()-mfy->begin()), static_cast<size_t>(1))-1) << ":0] __continue;" << std::endl;
   
   res->push_back_items(ib.begin(), ib.end());
 }
@@ -179,6 +263,7 @@ template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::emit_avalon_vars(ModuleDeclaration* res) {
   ItemBuilder ib;
   ib << "reg __read_prev = 0;" << std::endl;
+  ib << "reg[" << (M+V-1) << ":0] __vid_prev = 0;" << std::endl;
   ib << "wire __read_request;" << std::endl; 
   ib << "reg __write_prev = 0;" << std::endl;
   ib << "wire __write_request;" << std::endl; 
@@ -300,7 +385,8 @@ inline void Rewrite<M,V,A,T>::emit_state_vars(ModuleDeclaration* res) {
 
   ib << "wire __there_were_tasks;" << std::endl;
   ib << "wire __all_final;" << std::endl;
-  ib << "wire __continue;" << std::endl;
+  ib << "wire[" << (std::numeric_limits<T>::digits-1) << ":0] __task;" << std::endl;
+  ib << "wire __resume;" << std::endl;
   ib << "wire __reset;" << std::endl;
 
   res->push_back_items(ib.begin(), ib.end());
@@ -318,6 +404,9 @@ inline void Rewrite<M,V,A,T>::emit_trigger_vars(ModuleDeclaration* res, const Tr
   for (auto& e : ti->posedges_) {
     vars[e.first] = e.second;
   }
+  for (auto& e : ti->levels_) {
+    vars[e.first] = e.second;
+  }
 
   // Emit variables for storing previous values of trigger variables
   for (const auto& v : vars) {
@@ -361,13 +450,67 @@ inline void Rewrite<M,V,A,T>::emit_open_loop_vars(ModuleDeclaration* res) {
   res->push_back_items(ib.begin(), ib.end());
 }
 
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_output_mask_vars(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt) {
+  ModuleInfo info(md);
+  ItemBuilder ib;
+
+  // Emit a copy of every output as of the last time the host read the output
+  // mask, with name suffixed by _seen.
+  for (auto* o : info.outputs()) {
+    const auto itr = vt->find(o);
+    assert(itr != vt->end());
+    const auto w = itr->second.bits_per_element;
+    ib << "reg[" << (w-1) << ":0] " << o->front_ids()->get_readable_sid() << "_seen = 0;" << std::endl;
+  }
+  ib << "wire[" << (std::numeric_limits<T>::digits-1) << ":0] __output_mask;" << std::endl;
+  ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __output_mask_latch = 0;" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_state_mask_vars(ModuleDeclaration* res, const VarTable<V,A,T>* vt) {
+  if (vt->tracked().empty()) {
+    return;
+  }
+
+  const auto n = vt->tracked().size();
+  ItemBuilder ib;
+  ib << "wire[" << (n-1) << ":0] __state_mask_next;" << std::endl;
+  ib << "reg[" << (n-1) << ":0] __state_mask = 0;" << std::endl;
+  ib << "reg[" << (n-1) << ":0] __state_mask_latch = 0;" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_fifo_vars(ModuleDeclaration* res, const VarTable<V,A,T>* vt) {
+  if (vt->fifo_tasks().empty()) {
+    return;
+  }
+
+  ItemBuilder ib;
+  ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __fifo[" << (vt->fifo_depth()-1) << ":0];" << std::endl;
+  ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __fifo_head = 0;" << std::endl;
+  ib << "reg[" << (std::numeric_limits<T>::digits-1) << ":0] __fifo_tail = 0;" << std::endl;
+  ib << "wire[" << (std::numeric_limits<T>::digits-1) << ":0] __fifo_count;" << std::endl;
+  ib << "wire __fifo_push;" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
 template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::emit_avalon_logic(ModuleDeclaration* res) {
   ItemBuilder ib;
+  // A request begins when either signal is raised, or when the address
+  // changes while it's held. The latter is how a master bursts through
+  // consecutive addresses without releasing the bus between words.
   ib << "always @(posedge __clk) __read_prev <= __read;" << std::endl;
-  ib << "assign __read_request = (!__read_prev && __read);" << std::endl;
+  ib << "always @(posedge __clk) __vid_prev <= __vid;" << std::endl;
+  ib << "assign __read_request = (__read && (!__read_prev || (__vid != __vid_prev)));" << std::endl;
   ib << "always @(posedge __clk) __write_prev <= __write;" << std::endl;
-  ib << "assign __write_request = (!__write_prev && __write);" << std::endl;
+  ib << "assign __write_request = (__write && (!__write_prev || (__vid != __vid_prev)));" << std::endl;
   res->push_back_items(ib.begin(), ib.end()); 
 }
 
@@ -388,9 +531,14 @@ template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::emit_state_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt, const Machinify<T>* mfy) {
   ItemBuilder ib;
 
+  ib << "assign __resume = (__read_request && (__vid == " << vt->resume_index() << "));" << std::endl;
+  ib << "assign __reset = (__read_request && (__vid == " << vt->reset_index() << "));" << std::endl;
+
   if (mfy->begin() == mfy->end()) {
     ib << "assign __there_were_tasks = 0;" << std::endl;
     ib << "assign __all_final = 1;" << std::endl;
+    ib << "assign __task = 0;" << std::endl;
+    ib << "assign __continue = 0;" << std::endl;
   } else {
     ib << "assign __there_were_tasks = |{";
     for (auto i = mfy->begin(), ie = mfy->end(); i != ie;) {
@@ -408,10 +556,25 @@ inline void Rewrite<M,V,A,T>::emit_state_logic(ModuleDeclaration* res, const Var
       }
     }
     ib << "};" << std::endl;
-  }
 
-  ib << "assign __continue = ((__read_request && (__vid == " << vt->resume_index() << ")) || (!__all_final && !__there_were_tasks));" << std::endl;
-  ib << "assign __reset = (__read_request && (__vid == " << vt->reset_index() << "));" << std::endl;
+    // The host services one task at a time, in machine order. Task ids are
+    // unique, so a resume only releases the machine whose task was reported
+    // (along with any machines which are waiting on a reset). 
+    ib << "assign __task = ";
+    for (auto i = mfy->begin(), ie = mfy->end(); i != ie; ++i) {
+      ib << "(__task_id[" << i->name() << "] != 0) ? __task_id[" << i->name() << "] : ";
+    }
+    ib << "0;" << std::endl;
+    // Tasks which are logged to the task fifo release their machine as soon
+    // as their record has been pushed.
+    for (auto i = mfy->begin(), ie = mfy->end(); i != ie; ++i) {
+      ib << "assign __continue[" << i->name() << "] = ((__resume && ((~__task_id[" << i->name() << "] == 0) || (__task_id[" << i->name() << "] == __task))) || ";
+      if (!vt->fifo_tasks().empty()) {
+        ib << "(__fifo_push && (__task_id[" << i->name() << "] == __task)) || ";
+      }
+      ib << "(!__all_final && !__there_were_tasks));" << std::endl;
+    }
+  }
 
   res->push_back_items(ib.begin(), ib.end());
 }
@@ -428,6 +591,9 @@ inline void Rewrite<M,V,A,T>::emit_trigger_logic(ModuleDeclaration* res, const T
   for (const auto& e : ti->posedges_) {
     vars.insert(e.first);
   }
+  for (const auto& e : ti->levels_) {
+    vars.insert(e.first);
+  }
 
   // Emit updates for trigger variables
   ib << "always @(posedge __clk) begin" << std::endl;
@@ -445,22 +611,28 @@ inline void Rewrite<M,V,A,T>::emit_trigger_logic(ModuleDeclaration* res, const T
     ib << "assign " << e.first << "_posedge = (" << e.first << "_prev == 0) && (" << e.first << " == 1);" << std::endl;
   }
   
-  // Emit logic for tracking whether any triggers just occurred
-  if (ti->posedges_.empty() && ti->negedges_.empty()) {
+  // Emit logic for tracking whether any triggers just occurred. Level
+  // triggers are approximated by a change to any part of their variable,
+  // which at worst costs an extra cycle of waiting.
+  std::vector<std::string> triggers;
+  for (const auto& e : ti->negedges_) {
+    triggers.push_back(e.first + "_negedge");
+  }
+  for (const auto& e : ti->posedges_) {
+    triggers.push_back(e.first + "_posedge");
+  }
+  for (const auto& e : ti->levels_) {
+    triggers.push_back("(" + e.first + "_prev != " + e.first + ")");
+  }
+  if (triggers.empty()) {
     ib << "assign __any_triggers = 0;" << std::endl;
   } else {
     ib << "assign __any_triggers = |{";
-    for (auto i = ti->negedges_.begin(), ie = ti->negedges_.end(); i != ie; ) {
-      ib << i->first << "_negedge";
-      if ((++i != ie) || !ti->posedges_.empty()) {
-        ib << ",";
-      }
-    }
-    for (auto i = ti->posedges_.begin(), ie = ti->posedges_.end(); i != ie; ) {
-      ib << i->first << "_posedge";
+    for (auto i = triggers.begin(), ie = triggers.end(); i != ie; ) {
+      ib << *i;
       if (++i != ie) {
         ib << ",";
-      } 
+      }
     }
     ib << "};" << std::endl;
   }
@@ -473,6 +645,10 @@ inline void Rewrite<M,V,A,T>::emit_open_loop_logic(ModuleDeclaration* res, const
   ItemBuilder ib;
 
   ib << "always @(posedge __clk) __open_loop <= ((__read_request && (__vid == " << vt->open_loop_index() << ")) ? __in : (__open_loop_tick ? (__open_loop - 1) : __open_loop));" << std::endl;
+  // Open loop keeps running when an output changes. Outputs only drive leds
+  // while in open loop, so the host only needs their final values. These are
+  // read back through the output mask at the end of the quantum, which
+  // remembers every output that changed since the host last saw it.
   ib << "assign __open_loop_tick = (__all_final && (!__any_triggers && (__open_loop > 0)));" << std::endl;
 
   res->push_back_items(ib.begin(), ib.end());
@@ -562,6 +738,152 @@ inline void Rewrite<M,V,A,T>::emit_var_logic(ModuleDeclaration* res, const Modul
   res->push_back_items(ib.begin(), ib.end());
 }
 
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_output_mask_logic(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt) {
+  ModuleInfo info(md);
+
+  // Index outputs in var table order. This is the order that the host uses
+  // to assign bits in the output mask.
+  std::map<size_t, std::string> outputs;
+  for (auto* o : info.outputs()) {
+    const auto itr = vt->find(o);
+    assert(itr != vt->end());
+    outputs[itr->second.begin] = o->front_ids()->get_readable_sid();
+  }
+
+  // Bit i of the mask is set if the i'th output has changed since it was last
+  // seen by the host. If there are more outputs than bits, the final bit is
+  // shared by all of the outputs that remain.
+  ItemBuilder ib;
+  if (outputs.empty()) {
+    ib << "assign __output_mask = 0;" << std::endl;
+  } else {
+    const auto top = static_cast<size_t>(std::numeric_limits<T>::digits-1);
+    std::vector<std::string> bits;
+    for (const auto& o : outputs) {
+      const auto dirty = "(" + o.second + " != " + o.second + "_seen)";
+      if (bits.size() <= top) {
+        bits.push_back(dirty);
+      } else {
+        bits.back() += " || " + dirty;
+      }
+    }
+    ib << "assign __output_mask = {";
+    for (auto i = bits.rbegin(), ie = bits.rend(); i != ie; ) {
+      ib << "(" << *i << ")";
+      if (++i != ie) {
+        ib << ",";
+      }
+    }
+    ib << "};" << std::endl;
+  }
+
+  // Reading the mask latches its value and records the outputs it describes
+  // as seen. The latch is what the host observes on the following cycle.
+  ib << "always @(posedge __clk) begin" << std::endl;
+  ib << "if (__write_request && (__vid == " << vt->output_mask_index() << ")) begin" << std::endl;
+  ib << "__output_mask_latch <= __output_mask;" << std::endl;
+  for (const auto& o : outputs) {
+    ib << o.second << "_seen <= " << o.second << ";" << std::endl;
+  }
+  ib << "end" << std::endl;
+  ib << "end" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_state_mask_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt) {
+  if (vt->tracked().empty()) {
+    return;
+  }
+
+  // Bit i of the mask is set whenever an update is applied to any word of the
+  // i'th tracked variable. This is the order that the host uses to assign
+  // bits in the state mask.
+  ItemBuilder ib;
+  ib << "assign __state_mask_next = {";
+  for (auto i = vt->tracked().rbegin(), ie = vt->tracked().rend(); i != ie; ) {
+    const auto itr = vt->find(*i);
+    assert(itr != vt->end());
+    const auto begin = itr->second.begin;
+    const auto end = begin + itr->second.elements * itr->second.words_per_element;
+    ib << "(__apply_updates && (|__update_queue[" << (end-1) << ":" << begin << "]))";
+    if (++i != ie) {
+      ib << ",";
+    }
+  }
+  ib << "};" << std::endl;
+
+  // Reading the mask latches its value and clears it. Updates which are
+  // applied on the same cycle are reported in the latch rather than lost.
+  ib << "always @(posedge __clk) begin" << std::endl;
+  ib << "if (__write_request && (__vid == " << vt->state_mask_index() << ")) begin" << std::endl;
+  ib << "__state_mask_latch <= __state_mask | __state_mask_next;" << std::endl;
+  ib << "__state_mask <= 0;" << std::endl;
+  ib << "end else" << std::endl;
+  ib << "__state_mask <= __state_mask | __state_mask_next;" << std::endl;
+  ib << "end" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void Rewrite<M,V,A,T>::emit_fifo_logic(ModuleDeclaration* res, const VarTable<V,A,T>* vt) {
+  if (vt->fifo_tasks().empty()) {
+    return;
+  }
+
+  const auto mask = vt->fifo_depth()-1;
+  ItemBuilder ib;
+  ib << "assign __fifo_count = __fifo_tail - __fifo_head;" << std::endl;
+
+  // A record is pushed in place of reporting a task to the host, provided
+  // that there's room for all of it. Otherwise the task is reported as usual,
+  // and the host drains the fifo to make room.
+  ib << "assign __fifo_push = |{";
+  for (auto i = vt->fifo_tasks().begin(), ie = vt->fifo_tasks().end(); i != ie; ) {
+    ib << "((__task == " << i->first << ") && (__fifo_count <= " << (vt->fifo_depth() - vt->fifo_record_size(i->first)) << "))";
+    if (++i != ie) {
+      ib << ",";
+    }
+  }
+  ib << "};" << std::endl;
+
+  // Records are the task id followed by the words of each argument. Values
+  // are sampled on the cycle after the task was reached, which is what the
+  // host would have seen had the task been reported instead.
+  ib << "always @(posedge __clk) begin" << std::endl;
+  ib << "if (__fifo_push) begin" << std::endl;
+  ib << "case(__task)" << std::endl;
+  for (const auto& t : vt->fifo_tasks()) {
+    ib << t.first << ": begin" << std::endl;
+    ib << "__fifo[__fifo_tail & " << mask << "] <= " << t.first << ";" << std::endl;
+    size_t idx = 1;
+    for (auto* a : t.second) {
+      const auto itr = vt->find(a);
+      assert(itr != vt->end());
+      const auto w = itr->second.bits_per_element;
+      for (size_t j = 0, je = itr->second.words_per_element; j < je; ++j, ++idx) {
+        auto* id = a->clone();
+        id->purge_dim();
+        emit_slice(id, w, j);
+        ib << "__fifo[(__fifo_tail + " << idx << ") & " << mask << "] <= " << id << ";" << std::endl;
+        delete id;
+      }
+    }
+    ib << "__fifo_tail <= __fifo_tail + " << idx << ";" << std::endl;
+    ib << "end" << std::endl;
+  }
+  ib << "endcase" << std::endl;
+  ib << "end" << std::endl;
+  ib << "if (__read_request && (__vid == " << vt->task_fifo_index() << "))" << std::endl;
+  ib << "__fifo_head <= __fifo_head + __in;" << std::endl;
+  ib << "end" << std::endl;
+
+  res->push_back_items(ib.begin(), ib.end());
+}
+
 template <size_t M, size_t V, typename A, typename T>
 inline void Rewrite<M,V,A,T>::emit_output_logic(ModuleDeclaration* res, const ModuleDeclaration* md, const VarTable<V,A,T>* vt) {
   ModuleInfo info(md);      
@@ -599,9 +921,22 @@ inline void Rewrite<M,V,A,T>::emit_output_logic(ModuleDeclaration* res, const Mo
   }
   
   ib << vt->there_are_updates_index() << ": __out = __there_are_updates;" << std::endl;
-  ib << vt->there_were_tasks_index() << ": __out = __task_id[0];" << std::endl;
+  ib << vt->there_were_tasks_index() << ": __out = __task;" << std::endl;
   ib << vt->open_loop_index() << ": __out = __open_loop;" << std::endl;
+  ib << vt->output_mask_index() << ": __out = __output_mask_latch;" << std::endl;
+  ib << vt->state_mask_index() << ": __out = " << vt->state_mask_words() << ";" << std::endl;
+  for (size_t i = 0, ie = vt->state_mask_words(); i < ie; ++i) {
+    const auto digits = static_cast<size_t>(std::numeric_limits<T>::digits);
+    const auto top = std::min((i+1)*digits, vt->tracked().size()) - 1;
+    ib << (vt->state_mask_window_index()+i) << ": __out = __state_mask_latch[" << top << ":" << (i*digits) << "];" << std::endl;
+  }
   ib << vt->debug_index() << ": __out = __state[0];" << std::endl;
+  if (!vt->fifo_tasks().empty()) {
+    ib << vt->task_fifo_index() << ": __out = __fifo_count;" << std::endl;
+    for (size_t i = 0, ie = vt->fifo_depth(); i < ie; ++i) {
+      ib << (vt->fifo_window_index()+i) << ": __out = __fifo[(__fifo_head + " << i << ") & " << (ie-1) << "];" << std::endl;
+    }
+  }
 
   // TODO: See comments in emit_var_logic for a similar discussion. There's a
   // non-trivial decision to be made here about what code to generate and when
@@ -621,7 +956,7 @@ inline void Rewrite<M,V,A,T>::emit_output_logic(ModuleDeclaration* res, const Mo
   }
 
   ib << "endcase" << std::endl;
-  ib << "assign __wait = __read_request || __write_request || __open_loop_tick || __any_triggers || __continue;" << std::endl;
+  ib << "assign __wait = __read_request || __write_request || __open_loop_tick || __any_triggers || (|__continue);" << std::endl;
 
   res->push_back_items(ib.begin(), ib.end());
 }
@@ -31,8 +31,11 @@
 #ifndef CASCADE_SRC_TARGET_CORE_AVMM_ULX3S_ULX3S_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_AVMM_ULX3S_ULX3S_LOGIC_H
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <unistd.h>
+#include <vector>
 #include "target/core/avmm/avmm_logic.h"
 #include "target/core/avmm/ulx3s/ulx3s_compiler.h"
 #include "target/core/avmm/ulx3s/ulx3s_logic.h"
@@ -52,6 +55,8 @@ class Ulx3sLogic : public AvmmLogic<V,A,T> {
     Ulx3sLogic& set_callback(Callback cb);
 
   private:
+    static constexpr size_t window_ = 128 / (sizeof(T) + sizeof(A));
+
     int fd_;
     Callback cb_;
 
@@ -84,6 +89,40 @@ inline Ulx3sLogic<V,A,T>::Ulx3sLogic(Interface* interface, ModuleDeclaration* md
     write_all(reinterpret_cast<char*>(&addr), sizeof(A));
     read_all(reinterpret_cast<char*>(&res), sizeof(T));
   });
+  // Bursts pipeline their requests: A window of requests is sent before any
+  // response is read, so the round trip latency of the serial link is paid
+  // once per window rather than once per word. Windows are sized to fit in
+  // half of the uart's receive fifo.
+  AvmmLogic<V,A,T>::get_table()->set_read_burst([this](A index, T* vals, size_t n) {
+    std::vector<char> buf(window_ * (sizeof(T) + sizeof(A)));
+    for (size_t i = 0; i < n; i += window_) {
+      const auto m = std::min(window_, n-i);
+      for (size_t j = 0; j < m; ++j) {
+        const T res = 0;
+        const A addr = (A(0) << (std::numeric_limits<A>::digits-1)) | (index+i+j);
+        auto* req = buf.data() + j * (sizeof(T) + sizeof(A));
+        memcpy(req, &res, sizeof(T));
+        memcpy(req + sizeof(T), &addr, sizeof(A));
+      }
+      write_all(buf.data(), m * (sizeof(T) + sizeof(A)));
+      read_all(reinterpret_cast<char*>(vals+i), m * sizeof(T));
+    }
+  });
+  AvmmLogic<V,A,T>::get_table()->set_write_burst([this](A index, const T* vals, size_t n) {
+    std::vector<char> buf(window_ * (sizeof(T) + sizeof(A)));
+    std::vector<T> res(window_);
+    for (size_t i = 0; i < n; i += window_) {
+      const auto m = std::min(window_, n-i);
+      for (size_t j = 0; j < m; ++j) {
+        const A addr = (A(1) << (std::numeric_limits<A>::digits-1)) | (index+i+j);
+        auto* req = buf.data() + j * (sizeof(T) + sizeof(A));
+        memcpy(req, &vals[i+j], sizeof(T));
+        memcpy(req + sizeof(T), &addr, sizeof(A));
+      }
+      write_all(buf.data(), m * (sizeof(T) + sizeof(A)));
+      read_all(reinterpret_cast<char*>(res.data()), m * sizeof(T));
+    }
+  });
 }
 
 template <size_t V, typename A, typename T>
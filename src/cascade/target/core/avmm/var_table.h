@@ -32,8 +32,12 @@
 #define CASCADE_SRC_TARGET_CORE_AVMM_VAR_TABLE_H
 
 #include <cassert>
+#include <limits>
 #include <functional>
+#include <map>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "common/bits.h"
 #include "common/vector.h"
 #include "verilog/analyze/evaluate.h"
@@ -56,6 +60,8 @@ class VarTable {
     // IO Typedefs:
     typedef std::function<T(A)> Read;
     typedef std::function<void(A, T)> Write;
+    typedef std::function<void(A, T*, size_t)> ReadBurst;
+    typedef std::function<void(A, const T*, size_t)> WriteBurst;
 
     // Iterator Typedefs:
     typedef typename std::unordered_map<const Identifier*, const Row>::const_iterator const_iterator;
@@ -66,6 +72,15 @@ class VarTable {
     // Configuration Interface:
     VarTable& set_read(Read read);
     VarTable& set_write(Write write);
+    // Optional: Transfers a contiguous range of words in a single request.
+    // Tables without burst handlers fall back on one read or write per word.
+    VarTable& set_read_burst(ReadBurst read_burst);
+    VarTable& set_write_burst(WriteBurst write_burst);
+    // Optional: Tables whose handlers share a device with other tables should
+    // share a lock as well. Every request to the device is made while holding
+    // this lock, so that requests made on behalf of different tables are never
+    // interleaved.
+    VarTable& set_lock(std::mutex* lock);
 
     // Inserts an element into the table.
     void insert(const Identifier* id);
@@ -95,13 +110,51 @@ class VarTable {
     size_t open_loop_index() const;
     // Returns the address of the feof control variable.
     size_t feof_index() const;
+    // Returns the address of the output mask control variable.
+    size_t output_mask_index() const;
+    // Returns the address of the task fifo control variable. Reads return the
+    // number of words in the fifo, writes pop that many words.
+    size_t task_fifo_index() const;
+    // Returns the address of the state mask control variable. Reads return
+    // the number of words in the state mask, latch its value, and clear it.
+    size_t state_mask_index() const;
     // Reserved for debugging
     size_t debug_index() const;
 
+    // Records a task whose arguments can be logged to the task fifo rather
+    // than read back by the host. Returns false if the task's arguments
+    // aren't scalars or won't fit comfortably in the fifo.
+    bool insert_fifo_task(size_t task, const std::vector<const Identifier*>& args);
+    // Returns the tasks which are logged to the task fifo, along with their
+    // arguments in the order in which they appear in fifo records.
+    const std::map<size_t, std::vector<const Identifier*>>& fifo_tasks() const;
+    // Returns the number of words in the fifo record for a task.
+    size_t fifo_record_size(size_t task) const;
+    // Returns the number of words in the task fifo, or zero if no tasks are
+    // logged to the fifo.
+    size_t fifo_depth() const;
+    // Returns the first address of the window through which the contents of
+    // the task fifo are read. The window begins just past the end of the
+    // table.
+    size_t fifo_window_index() const;
+
+    // Records an element whose updates should be reported in the state mask.
+    // Bits in the mask are assigned in the order in which elements are
+    // tracked.
+    void track(const Identifier* id);
+    // Returns the elements which are reported in the state mask.
+    const std::vector<const Identifier*>& tracked() const;
+    // Returns the number of words in the state mask.
+    size_t state_mask_words() const;
+    // Returns the first address of the window through which the latched
+    // value of the state mask is read. The window begins just past the end of
+    // the task fifo window.
+    size_t state_mask_window_index() const;
+
     // Reads the value of a control variable
-    T read_control_var(size_t index) const;
+    T read_control_var(size_t slot, size_t index) const;
     // Writes the value of a control variable
-    void write_control_var(size_t index, T val);
+    void write_control_var(size_t slot, size_t index, T val);
 
     // Reads the value of a variable
     void read_var(size_t slot, const Identifier* id) const; 
@@ -109,17 +162,36 @@ class VarTable {
     void write_var(size_t slot, const Identifier* id, const Bits& val);
     // Writes the value of an array variable
     void write_var(size_t slot, const Identifier* id, const Vector<Bits>& val);
+    // Reads the first n words from the task fifo
+    void read_fifo(size_t slot, T* data, size_t n) const;
+    // Reads the first n words of the latched state mask
+    void read_state_mask(size_t slot, T* data, size_t n) const;
 
   private:
     Read read_;
     Write write_;
+    ReadBurst read_burst_;
+    WriteBurst write_burst_;
+    std::mutex* lock_;
 
     size_t next_index_;
     std::unordered_map<const Identifier*, const Row> vtable_;
+    std::map<size_t, std::vector<const Identifier*>> fifo_tasks_;
+    std::vector<const Identifier*> tracked_;
+
+    // Locking Helpers:
+    std::unique_lock<std::mutex> acquire() const;
+
+    // Burst Helpers:
+    void read_range(A addr, T* data, size_t n) const;
+    void write_range(A addr, const T* data, size_t n);
 };
 
 template <size_t V, typename A, typename T>
 inline VarTable<V,A,T>::VarTable() {
+  read_burst_ = nullptr;
+  write_burst_ = nullptr;
+  lock_ = nullptr;
   next_index_ = 0;
 }
 
@@ -135,6 +207,24 @@ inline VarTable<V,A,T>& VarTable<V,A,T>::set_write(Write write) {
   return *this;
 }
 
+template <size_t V, typename A, typename T>
+inline VarTable<V,A,T>& VarTable<V,A,T>::set_read_burst(ReadBurst read_burst) {
+  read_burst_ = read_burst;
+  return *this;
+}
+
+template <size_t V, typename A, typename T>
+inline VarTable<V,A,T>& VarTable<V,A,T>::set_write_burst(WriteBurst write_burst) {
+  write_burst_ = write_burst;
+  return *this;
+}
+
+template <size_t V, typename A, typename T>
+inline VarTable<V,A,T>& VarTable<V,A,T>::set_lock(std::mutex* lock) {
+  lock_ = lock;
+  return *this;
+}
+
 template <size_t V, typename A, typename T>
 inline void VarTable<V,A,T>::insert(const Identifier* id) {
   assert(find(id) == end());
@@ -217,22 +307,111 @@ inline size_t VarTable<V,A,T>::feof_index() const {
 }
 
 template <size_t V, typename A, typename T>
-inline size_t VarTable<V,A,T>::debug_index() const {
+inline size_t VarTable<V,A,T>::output_mask_index() const {
   return next_index_ + 7;
 }
 
 template <size_t V, typename A, typename T>
-inline T VarTable<V,A,T>::read_control_var(size_t index) const {
+inline size_t VarTable<V,A,T>::task_fifo_index() const {
+  return next_index_ + 8;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::state_mask_index() const {
+  return next_index_ + 9;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::debug_index() const {
+  return next_index_ + 10;
+}
+
+template <size_t V, typename A, typename T>
+inline bool VarTable<V,A,T>::insert_fifo_task(size_t task, const std::vector<const Identifier*>& args) {
+  assert(fifo_tasks_.find(task) == fifo_tasks_.end());
+
+  // Records are a task id followed by the words of each argument. Keeping
+  // records to a quarter of the fifo means that the fifo is never more than
+  // three quarters full when it stops accepting records.
+  size_t n = 1;
+  for (auto* a : args) {
+    const auto itr = find(a);
+    assert(itr != end());
+    if (itr->second.elements != 1) {
+      return false;
+    }
+    n += itr->second.words_per_element;
+  }
+  if (n > 16) {
+    return false;
+  }
+
+  fifo_tasks_.insert(std::make_pair(task, args));
+  return true;
+}
+
+template <size_t V, typename A, typename T>
+inline const std::map<size_t, std::vector<const Identifier*>>& VarTable<V,A,T>::fifo_tasks() const {
+  return fifo_tasks_;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::fifo_record_size(size_t task) const {
+  const auto itr = fifo_tasks_.find(task);
+  assert(itr != fifo_tasks_.end());
+
+  size_t n = 1;
+  for (auto* a : itr->second) {
+    n += find(a)->second.words_per_element;
+  }
+  return n;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::fifo_depth() const {
+  return fifo_tasks_.empty() ? 0 : 64;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::fifo_window_index() const {
+  return debug_index() + 1;
+}
+
+template <size_t V, typename A, typename T>
+inline void VarTable<V,A,T>::track(const Identifier* id) {
+  assert(find(id) != end());
+  tracked_.push_back(id);
+}
+
+template <size_t V, typename A, typename T>
+inline const std::vector<const Identifier*>& VarTable<V,A,T>::tracked() const {
+  return tracked_;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::state_mask_words() const {
+  return (tracked_.size() + std::numeric_limits<T>::digits - 1) / std::numeric_limits<T>::digits;
+}
+
+template <size_t V, typename A, typename T>
+inline size_t VarTable<V,A,T>::state_mask_window_index() const {
+  return fifo_window_index() + fifo_depth();
+}
+
+template <size_t V, typename A, typename T>
+inline T VarTable<V,A,T>::read_control_var(size_t slot, size_t index) const {
   assert(index >= there_are_updates_index());
   assert(index <= debug_index());
-  return read_(index);
+  const auto lg = acquire();
+  return read_((slot << V) | index);
 }
 
 template <size_t V, typename A, typename T>
-inline void VarTable<V,A,T>::write_control_var(size_t index, T val) {
+inline void VarTable<V,A,T>::write_control_var(size_t slot, size_t index, T val) {
   assert(index >= there_are_updates_index());
   assert(index <= debug_index());
-  write_(index, val);
+  const auto lg = acquire();
+  write_((slot << V) | index, val);
 }
 
 template <size_t V, typename A, typename T>
@@ -240,13 +419,15 @@ inline void VarTable<V,A,T>::read_var(size_t slot, const Identifier* id) const {
   const auto itr = vtable_.find(id);
   assert(itr != vtable_.end());
 
-  auto idx = itr->second.begin;
+  const auto n = itr->second.elements * itr->second.words_per_element;
+  std::vector<T> words(n);
+  read_range((slot << V) | itr->second.begin, words.data(), n);
+
+  size_t idx = 0;
   for (size_t i = 0; i < itr->second.elements; ++i) {
     for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-      const volatile auto word = read_((slot << V) | idx);
-      Evaluate().assign_word<T>(id, i, j, word);
-      ++idx;
-    } 
+      Evaluate().assign_word<T>(id, i, j, words[idx++]);
+    }
   }
 }
 
@@ -256,12 +437,12 @@ inline void VarTable<V,A,T>::write_var(size_t slot, const Identifier* id, const
   assert(itr != vtable_.end());
   assert(itr->second.elements == 1);
 
-  auto idx = itr->second.begin;
-  for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-    const volatile auto word = val.read_word<T>(j);
-    write_((slot << V) | idx, word);
-    ++idx;
+  const auto n = itr->second.words_per_element;
+  std::vector<T> words(n);
+  for (size_t j = 0; j < n; ++j) {
+    words[j] = val.read_word<T>(j);
   }
+  write_range((slot << V) | itr->second.begin, words.data(), n);
 }
 
 template <size_t V, typename A, typename T>
@@ -270,14 +451,58 @@ inline void VarTable<V,A,T>::write_var(size_t slot, const Identifier* id, const
   assert(itr != vtable_.end());
   assert(val.size() == itr->second.elements);
 
-  auto idx = itr->second.begin;
+  const auto n = itr->second.elements * itr->second.words_per_element;
+  std::vector<T> words(n);
+  size_t idx = 0;
   for (size_t i = 0; i < itr->second.elements; ++i) {
     for (size_t j = 0; j < itr->second.words_per_element; ++j) {
-      const volatile auto word = val[i].read_word<T>(j);
-      write_((slot << V) | idx, word);
-      ++idx;
+      words[idx++] = val[i].read_word<T>(j);
     }
   }
+  write_range((slot << V) | itr->second.begin, words.data(), n);
+}
+
+template <size_t V, typename A, typename T>
+inline void VarTable<V,A,T>::read_fifo(size_t slot, T* data, size_t n) const {
+  assert(n <= fifo_depth());
+  read_range((slot << V) | fifo_window_index(), data, n);
+}
+
+template <size_t V, typename A, typename T>
+inline void VarTable<V,A,T>::read_state_mask(size_t slot, T* data, size_t n) const {
+  assert(n <= state_mask_words());
+  read_range((slot << V) | state_mask_window_index(), data, n);
+}
+
+template <size_t V, typename A, typename T>
+inline void VarTable<V,A,T>::read_range(A addr, T* data, size_t n) const {
+  const auto lg = acquire();
+  if (read_burst_ != nullptr) {
+    read_burst_(addr, data, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const volatile auto word = read_(addr + i);
+    data[i] = word;
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline void VarTable<V,A,T>::write_range(A addr, const T* data, size_t n) {
+  const auto lg = acquire();
+  if (write_burst_ != nullptr) {
+    write_burst_(addr, data, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const volatile auto word = data[i];
+    write_(addr + i, word);
+  }
+}
+
+template <size_t V, typename A, typename T>
+inline std::unique_lock<std::mutex> VarTable<V,A,T>::acquire() const {
+  return (lock_ != nullptr) ? std::unique_lock<std::mutex>(*lock_) : std::unique_lock<std::mutex>();
 }
 
 } // namespace cascade::avmm
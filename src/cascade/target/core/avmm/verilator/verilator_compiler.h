@@ -31,11 +31,15 @@
 #ifndef CASCADE_SRC_TARGET_CORE_AVMM_VERILATOR_VERILATOR_COMPILER_H
 #define CASCADE_SRC_TARGET_CORE_AVMM_VERILATOR_VERILATOR_COMPILER_H
 
+#include <cassert>
+#include <csignal>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <fstream>
-#include <thread>
+#include <mutex>
+#include <string>
 #include <type_traits>
+#include <vector>
 #include "common/system.h"
 #include "target/core/avmm/avmm_compiler.h"
 #include "target/core/avmm/verilator/verilator_logic.h"
@@ -48,21 +52,46 @@ class VerilatorCompiler : public AvmmCompiler<M,V,A,T> {
     VerilatorCompiler();
     ~VerilatorCompiler() override;
 
+    // Configuration Interface:
+    //
+    // Sets the number of threads used to simulate each module. Multi-threaded
+    // models are only worth their synchronization overhead for large modules.
+    VerilatorCompiler& set_threads(size_t n);
+    // Enables or disables burst transfers. With bursts disabled, every word of
+    // state is moved by a transaction of its own.
+    VerilatorCompiler& set_bursts(bool enable);
+
   private:
     // Avmm Compiler Interface:
     VerilatorLogic<V,A,T>* build(Interface* interface, ModuleDeclaration* md, size_t slot) override;
     bool compile(const std::string& text, std::mutex& lock) override;
     void stop_compile() override;
-
-    // Verilator Control Thread:
-    std::thread verilator_;
-
-    // Shared Library Handles:
-    void* handle_;
-    void (*stop_)();
-
-    // Logic Core Handle:
-    VerilatorLogic<V,A,T>* logic_;
+    bool separate_slots() const override;
+    bool compile_slot(size_t slot, const std::string& text) override;
+    void load_slot(size_t slot) override;
+    void stop_slot(size_t slot) override;
+    bool shared_device() const override;
+
+    // Per-Slot State:
+    //
+    // Every slot is compiled into its own shared library, which contains its
+    // own instance of the harness. The harness is driven synchronously from
+    // whichever thread issues reads and writes, so there's no control thread
+    // to manage. Build state is guarded by lock_, since slots may compile
+    // concurrently.
+    struct Unit {
+      VerilatorLogic<V,A,T>* logic;
+      std::string dir;
+      pid_t pid;
+      void* handle;
+      void (*stop)();
+    };
+    std::mutex lock_;
+    std::vector<Unit> units_;
+
+    // Configuration State:
+    size_t threads_;
+    bool bursts_;
 };
 
 using Verilator32Compiler = VerilatorCompiler<2,12,uint16_t,uint32_t>;
@@ -70,28 +99,63 @@ using Verilator64Compiler = VerilatorCompiler<8,20,uint32_t,uint64_t>;
 
 template <size_t M, size_t V, typename A, typename T>
 inline VerilatorCompiler<M,V,A,T>::VerilatorCompiler() : AvmmCompiler<M,V,A,T>() {
-  handle_ = nullptr;
+  units_.resize(T(1) << M, {nullptr, "", 0, nullptr, nullptr});
+  threads_ = 1;
+  bursts_ = true;
 }
 
 template <size_t M, size_t V, typename A, typename T>
 inline VerilatorCompiler<M,V,A,T>::~VerilatorCompiler() {
-  if (handle_ != nullptr) {
-    stop_();
-    verilator_.join();
-    dlclose(handle_);
+  for (auto& u : units_) {
+    if (u.handle != nullptr) {
+      u.stop();
+      dlclose(u.handle);
+    }
   }
 }
 
+template <size_t M, size_t V, typename A, typename T>
+inline VerilatorCompiler<M,V,A,T>& VerilatorCompiler<M,V,A,T>::set_threads(size_t n) {
+  std::lock_guard<std::mutex> lg(lock_);
+  threads_ = (n == 0) ? 1 : n;
+  return *this;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline VerilatorCompiler<M,V,A,T>& VerilatorCompiler<M,V,A,T>::set_bursts(bool enable) {
+  std::lock_guard<std::mutex> lg(lock_);
+  bursts_ = enable;
+  return *this;
+}
+
 template <size_t M, size_t V, typename A, typename T>
 inline VerilatorLogic<V,A,T>* VerilatorCompiler<M,V,A,T>::build(Interface* interface, ModuleDeclaration* md, size_t slot) {
-  logic_ = new VerilatorLogic<V,A,T>(interface, md, slot);
-  return logic_;
+  units_[slot].logic = new VerilatorLogic<V,A,T>(interface, md, slot);
+  return units_[slot].logic;
 }
 
 template <size_t M, size_t V, typename A, typename T>
 inline bool VerilatorCompiler<M,V,A,T>::compile(const std::string& text, std::mutex& lock) {
-  stop_compile();
+  // Control should never reach here. Slots are compiled separately.
+  (void) text;
+  (void) lock;
+  assert(false);
+  return false;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void VerilatorCompiler<M,V,A,T>::stop_compile() {
+  // Control should never reach here. Slots are stopped separately.
+  assert(false);
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline bool VerilatorCompiler<M,V,A,T>::separate_slots() const {
+  return true;
+}
 
+template <size_t M, size_t V, typename A, typename T>
+inline bool VerilatorCompiler<M,V,A,T>::compile_slot(size_t slot, const std::string& text) {
   System::execute("mkdir -p /tmp/verilator/");
   char path[] = "/tmp/verilator/program_logic_XXXXXX.v";
   const auto fd = mkstemps(path, 2);
@@ -103,51 +167,67 @@ inline bool VerilatorCompiler<M,V,A,T>::compile(const std::string& text, std::mu
   ofs << text << std::endl;
   ofs.close();
 
-  pid_t pid = 0;
+  // Record the build process for this slot so that stop_slot() can find it. 
+  std::unique_lock<std::mutex> lg(lock_);
   if constexpr (std::is_same<T, uint32_t>::value) {
-    pid = System::no_block_begin_execute("cd " + System::src_root() + "/share/cascade/verilator/ && ./build_verilator_32.sh " + dir + " " + System::cxx_compiler(), false);
+    units_[slot].pid = System::no_block_begin_execute("cd " + System::src_root() + "/share/cascade/verilator/ && ./build_verilator_32.sh " + dir + " " + System::cxx_compiler() + " " + std::to_string(threads_), false, true);
   } else if constexpr (std::is_same<T, uint64_t>::value) {
-    pid = System::no_block_begin_execute("cd " + System::src_root() + "/share/cascade/verilator/ && ./build_verilator_64.sh " + dir + " " + System::cxx_compiler(), false);
+    units_[slot].pid = System::no_block_begin_execute("cd " + System::src_root() + "/share/cascade/verilator/ && ./build_verilator_64.sh " + dir + " " + System::cxx_compiler() + " " + std::to_string(threads_), false, true);
   } 
+  units_[slot].dir = dir;
+  const auto pid = units_[slot].pid;
+  lg.unlock();
 
-  lock.unlock();
   const auto res = System::no_block_wait_finish(pid);
-  lock.lock();
 
-  if (res != 0) {
-    return false;
-  }
-    
-  AvmmCompiler<M,V,A,T>::get_compiler()->schedule_state_safe_interrupt([this, dir]{
-    if (handle_ != nullptr) {
-      stop_();
-      verilator_.join();
-      dlclose(handle_);
+  lg.lock();
+  units_[slot].pid = 0;
+  return res == 0;
+}
+
+template <size_t M, size_t V, typename A, typename T>
+inline void VerilatorCompiler<M,V,A,T>::load_slot(size_t slot) {
+  std::lock_guard<std::mutex> lg(lock_);
+  const auto dir = units_[slot].dir;
+  auto* logic = units_[slot].logic;
+  const auto bursts = bursts_;
+
+  AvmmCompiler<M,V,A,T>::get_compiler()->schedule_state_safe_interrupt([this, slot, dir, logic, bursts]{
+    auto& u = units_[slot];
+    if (u.handle != nullptr) {
+      u.stop();
+      dlclose(u.handle);
     }
     
-    handle_ = dlopen((dir + "/libverilator.so").c_str(), RTLD_LAZY);
-    stop_ = (void (*)()) dlsym(handle_, "verilator_stop");
+    u.handle = dlopen((dir + "/libverilator.so").c_str(), RTLD_LAZY | RTLD_LOCAL);
+    u.stop = (void (*)()) dlsym(u.handle, "verilator_stop");
     
-    auto read = (T (*)(A)) dlsym(handle_, "verilator_read");
-    auto write = (void (*)(A, T)) dlsym(handle_, "verilator_write");
-    logic_->set_io(read, write);
+    auto read = (T (*)(A)) dlsym(u.handle, "verilator_read");
+    auto write = (void (*)(A, T)) dlsym(u.handle, "verilator_write");
+    auto read_burst = bursts ? (void (*)(A, T*, size_t)) dlsym(u.handle, "verilator_read_burst") : nullptr;
+    auto write_burst = bursts ? (void (*)(A, const T*, size_t)) dlsym(u.handle, "verilator_write_burst") : nullptr;
+    logic->set_io(read, write, read_burst, write_burst);
     
-    auto init = (void (*)()) dlsym(handle_, "verilator_init");
+    auto init = (void (*)()) dlsym(u.handle, "verilator_init");
     init();
-    auto start = (void (*)()) dlsym(handle_, "verilator_start");
-    verilator_ = std::thread(start);
   });
+}
 
-  return true;
+template <size_t M, size_t V, typename A, typename T>
+inline void VerilatorCompiler<M,V,A,T>::stop_slot(size_t slot) {
+  // Kill the build script for this slot along with everything it spawned,
+  // including the compiler jobs started by make. The script runs in a process
+  // group of its own, so builds for other slots are left alone.
+  std::lock_guard<std::mutex> lg(lock_);
+  const auto pid = units_[slot].pid;
+  if (pid != 0) {
+    ::kill(-pid, SIGKILL);
+  }
 }
 
 template <size_t M, size_t V, typename A, typename T>
-inline void VerilatorCompiler<M,V,A,T>::stop_compile() {
-  if constexpr (std::is_same<T, uint32_t>::value) {
-    System::execute(R"(pkill -9 -P `ps -ax | grep build_verilator_32.sh | awk '{print $1}' | head -n1`)");
-  } else if constexpr (std::is_same<T, uint64_t>::value) {
-    System::execute(R"(pkill -9 -P `ps -ax | grep build_verilator_64.sh | awk '{print $1}' | head -n1`)");
-  } 
+inline bool VerilatorCompiler<M,V,A,T>::shared_device() const {
+  return false;
 }
 
 } // namespace cascade::avmm
@@ -43,20 +43,36 @@ class VerilatorLogic : public AvmmLogic<V,A,T> {
     VerilatorLogic(Interface* interface, ModuleDeclaration* md, size_t slot);
     virtual ~VerilatorLogic() override = default;
 
-    void set_io(T(*read)(A), void(*write)(A,T)); 
+    void set_io(T(*read)(A), void(*write)(A,T), void(*read_burst)(A,T*,size_t), void(*write_burst)(A,const T*,size_t));
 };
 
 template <size_t V, typename A, typename T>
 inline VerilatorLogic<V,A,T>::VerilatorLogic(Interface* interface, ModuleDeclaration* md, size_t slot) : AvmmLogic<V,A,T>(interface, md, slot) { }
 
 template <size_t V, typename A, typename T>
-inline void VerilatorLogic<V,A,T>::set_io(T(*read)(A), void(write)(A,T)) {
+inline void VerilatorLogic<V,A,T>::set_io(T(*read)(A), void(write)(A,T), void(*read_burst)(A,T*,size_t), void(*write_burst)(A,const T*,size_t)) {
   AvmmLogic<V,A,T>::get_table()->set_read([read](A index) {
     return read(index);
   });
   AvmmLogic<V,A,T>::get_table()->set_write([write](A index, T val) {
     write(index, val);
   });
+  // The table falls back on per-word transactions for whichever of the burst
+  // functions was not provided.
+  if (read_burst != nullptr) {
+    AvmmLogic<V,A,T>::get_table()->set_read_burst([read_burst](A index, T* vals, size_t n) {
+      read_burst(index, vals, n);
+    });
+  } else {
+    AvmmLogic<V,A,T>::get_table()->set_read_burst(nullptr);
+  }
+  if (write_burst != nullptr) {
+    AvmmLogic<V,A,T>::get_table()->set_write_burst([write_burst](A index, const T* vals, size_t n) {
+      write_burst(index, vals, n);
+    });
+  } else {
+    AvmmLogic<V,A,T>::get_table()->set_write_burst(nullptr);
+  }
 }
 
 } // namespace cascade::avmm
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_TARGET_CORE_COMMON_PRINTF_H
 #define CASCADE_SRC_TARGET_CORE_COMMON_PRINTF_H
 
+#include <cassert>
 #include <cstdio>
 #include <iostream>
 #include "verilog/analyze/evaluate.h"
@@ -40,17 +41,26 @@ namespace cascade {
 
 struct Printf {
   void write(std::ostream& os, Evaluate* eval, const PutStatement* ps) const;
+  // Formats val in place of the value of ps's argument
+  void write(std::ostream& os, const Bits& val, const PutStatement* ps) const;
 };
 
 inline void Printf::write(std::ostream& os, Evaluate* eval, const PutStatement* ps) const {
-  const auto* fmt = ps->get_fmt()->get_readable_val().c_str();
+  const auto& fmt = ps->get_fmt()->get_readable_val();
   if (fmt[0] != '%') {
     os << fmt;
     return;
   }
-
   assert(ps->is_non_null_expr());
-  const auto& val = eval->get_value(ps->get_expr());
+  write(os, eval->get_value(ps->get_expr()), ps);
+}
+
+inline void Printf::write(std::ostream& os, const Bits& val, const PutStatement* ps) const {
+  const auto* fmt = ps->get_fmt()->get_readable_val().c_str();
+  if (fmt[0] != '%') {
+    os << fmt;
+    return;
+  }
 
   switch (fmt[1]) {
     case '_':
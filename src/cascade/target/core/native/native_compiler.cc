@@ -0,0 +1,280 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "target/core/native/native_compiler.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <signal.h>
+#include <sstream>
+#include "common/system.h"
+#include "target/compiler.h"
+#include "verilog/analyze/evaluate.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/ast/ast.h"
+#include "verilog/print/print.h"
+
+using namespace std;
+
+namespace cascade::native {
+
+NativeCompiler::NativeCompiler() : CoreCompiler() { }
+
+void NativeCompiler::stop_compile(Engine::Id id) {
+  lock_guard<mutex> lg(lock_);
+  const auto itr = pids_.find(id);
+  if (itr == pids_.end()) {
+    return;
+  }
+  // Kill the build script's children, then the script itself. The compile
+  // thread will notice this when its wait returns.
+  const auto pid = to_string(itr->second);
+  System::execute("pkill -9 -P `pgrep -P " + pid + "` > /dev/null 2>&1; pkill -9 -P " + pid + " > /dev/null 2>&1");
+  ::kill(itr->second, SIGKILL);
+  stopped_.insert(id);
+}
+
+NativeLogic* NativeCompiler::compile_logic(Engine::Id id, ModuleDeclaration* md, Interface* interface) {
+  // Check for unsupported language features
+  Unsupported u;
+  md->accept(&u);
+  if (u.found()) {
+    get_compiler()->error("Native backends do not currently support file i/o tasks other than $display and $write!");
+    delete md;
+    return nullptr;
+  }
+
+  // Register inputs, state, and outputs, and index system tasks
+  ModuleInfo info(md);
+  auto* nl = new NativeLogic(interface, md);
+  for (auto* i : info.inputs()) {
+    nl->set_input(i, to_vid(i));
+  }
+  for (auto* s : info.stateful()) {
+    nl->set_state(info.is_volatile(s), s, to_vid(s));
+  }
+  for (auto* o : info.outputs()) {
+    nl->set_output(o, to_vid(o));
+  }
+  nl->index_tasks();
+
+  // Emit the rewritten module and its accessors into a fresh directory
+  System::execute("mkdir -p /tmp/native/");
+  char path[] = "/tmp/native/program_logic_XXXXXX";
+  if (mkdtemp(path) == nullptr) {
+    get_compiler()->error("Unable to create a build directory for native compilation");
+    delete nl;
+    return nullptr;
+  }
+  const string dir = path;
+
+  NativeRewrite nr;
+  auto* res = nr.run(md);
+  ofstream ofs(dir + "/program_logic.v");
+  ofs << res << endl;
+  ofs.close();
+  delete res;
+
+  ofstream acc(dir + "/program_logic.inc");
+  acc << get_accessors(nl, &nr);
+  acc.close();
+
+  // Build the shared library. This can take a while, so make sure that this
+  // compilation can be interrupted.
+  pid_t pid = 0;
+  { lock_guard<mutex> lg(lock_);
+    stopped_.erase(id);
+    pid = System::no_block_begin_execute("cd " + System::src_root() + "/share/cascade/native/ && ./build_native.sh " + dir + " " + System::cxx_compiler(), false);
+    pids_[id] = pid;
+  }
+  const auto status = System::no_block_wait_finish(pid);
+  auto stopped = false;
+  { lock_guard<mutex> lg(lock_);
+    pids_.erase(id);
+    stopped = stopped_.erase(id) > 0;
+  }
+
+  if (stopped) {
+    delete nl;
+    return nullptr;
+  }
+  if (status != 0) {
+    get_compiler()->error("Native backends were unable to build this module!");
+    delete nl;
+    return nullptr;
+  }
+  if (!nl->set_library(dir + "/libnative.so")) {
+    get_compiler()->error("Native backends were unable to load this module!");
+    delete nl;
+    return nullptr;
+  }
+  return nl;
+}
+
+string NativeCompiler::get_accessors(const NativeLogic* nl, NativeRewrite* nr) const {
+  stringstream ss;
+  const auto& vars = nl->get_vars();
+
+  // Task mask and open loop clock
+  ss << "#define NATIVE_TASKS " << nl->get_num_tasks() << endl;
+  if (nl->get_open_loop_clock() != nullptr) {
+    ss << "#define NATIVE_CLOCK " << nr->get_name(nl->get_open_loop_clock()) << endl;
+  }
+  ss << endl;
+
+  // Emits a reference to element e of variable v
+  const auto emit_ref = [&ss, nr](const NativeLogic::Var& v) {
+    ss << "    auto& x = ";
+    ss << (v.is_port ? "pl_->" : "ROOT->program_logic__DOT__") << nr->get_name(v.id);
+    auto n = v.elements;
+    for (auto a : v.arity) {
+      n /= a;
+      ss << "[(e / " << n << ") % " << a << "]";
+    }
+    ss << ";" << endl;
+  };
+
+  // Read accessors
+  ss << "void read_var(size_t v, size_t e, uint32_t* w) {" << endl;
+  ss << "  switch (v) {" << endl;
+  for (size_t i = 0, ie = vars.size(); i < ie; ++i) {
+    const auto& v = vars[i];
+    ss << "  case " << i << ": {" << endl;
+    emit_ref(v);
+    if (v.width <= 32) {
+      ss << "    w[0] = x;" << endl;
+    } else if (v.width <= 64) {
+      ss << "    w[0] = x;" << endl;
+      ss << "    w[1] = x >> 32;" << endl;
+    } else {
+      ss << "    for (size_t i = 0; i < " << v.words << "; ++i) w[i] = x[i];" << endl;
+    }
+    ss << "    break;" << endl;
+    ss << "  }" << endl;
+  }
+  ss << "  default:" << endl;
+  ss << "    break;" << endl;
+  ss << "  }" << endl;
+  ss << "}" << endl;
+  ss << endl;
+
+  // Write accessors
+  ss << "void write_var(size_t v, size_t e, const uint32_t* w) {" << endl;
+  ss << "  switch (v) {" << endl;
+  for (size_t i = 0, ie = vars.size(); i < ie; ++i) {
+    const auto& v = vars[i];
+    ss << "  case " << i << ": {" << endl;
+    emit_ref(v);
+    if (v.width <= 32) {
+      ss << "    x = w[0];" << endl;
+    } else if (v.width <= 64) {
+      ss << "    x = (static_cast<uint64_t>(w[1]) << 32) | w[0];" << endl;
+    } else {
+      ss << "    for (size_t i = 0; i < " << v.words << "; ++i) x[i] = w[i];" << endl;
+    }
+    ss << "    break;" << endl;
+    ss << "  }" << endl;
+  }
+  ss << "  default:" << endl;
+  ss << "    break;" << endl;
+  ss << "  }" << endl;
+  ss << "}" << endl;
+  ss << endl;
+
+  // Put argument accessors, indexed by entry in the task log
+  ss << "void read_put(size_t t, size_t e, uint32_t* w) {" << endl;
+  ss << "  switch (t) {" << endl;
+  for (size_t i = 0, ie = nl->get_num_tasks(); i < ie; ++i) {
+    const auto width = nl->get_put_width(i);
+    if (width == 0) {
+      continue;
+    }
+    ss << "  case " << i << ": {" << endl;
+    ss << "    auto& x = ROOT->program_logic__DOT__" << nr->get_put_name(i) << "[e];" << endl;
+    if (width <= 32) {
+      ss << "    w[0] = x;" << endl;
+    } else if (width <= 64) {
+      ss << "    w[0] = x;" << endl;
+      ss << "    w[1] = x >> 32;" << endl;
+    } else {
+      ss << "    for (size_t i = 0; i < " << ((width + 31) / 32) << "; ++i) w[i] = x[i];" << endl;
+    }
+    ss << "    break;" << endl;
+    ss << "  }" << endl;
+  }
+  ss << "  default:" << endl;
+  ss << "    break;" << endl;
+  ss << "  }" << endl;
+  ss << "}" << endl;
+
+  return ss.str();
+}
+
+NativeCompiler::Unsupported::Unsupported() : Visitor() {
+  found_ = false;
+}
+
+bool NativeCompiler::Unsupported::found() const {
+  return found_;
+}
+
+void NativeCompiler::Unsupported::visit(const FeofExpression* fe) {
+  (void) fe;
+  found_ = true;
+}
+
+void NativeCompiler::Unsupported::visit(const FopenExpression* fe) {
+  (void) fe;
+  found_ = true;
+}
+
+void NativeCompiler::Unsupported::visit(const FflushStatement* fs) {
+  (void) fs;
+  found_ = true;
+}
+
+void NativeCompiler::Unsupported::visit(const FseekStatement* fs) {
+  (void) fs;
+  found_ = true;
+}
+
+void NativeCompiler::Unsupported::visit(const GetStatement* gs) {
+  (void) gs;
+  found_ = true;
+}
+
+void NativeCompiler::Unsupported::visit(const PutStatement* ps) {
+  // Arguments are passed back to the host as raw bits
+  if (ps->is_non_null_expr() && (Evaluate().get_type(ps->get_expr()) == Bits::Type::REAL)) {
+    found_ = true;
+  }
+}
+
+} // namespace cascade::native
@@ -0,0 +1,91 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_COMPILER_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_COMPILER_H
+
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <unordered_set>
+#include "target/core_compiler.h"
+#include "target/core/native/native_logic.h"
+#include "target/core/native/native_rewrite.h"
+#include "verilog/ast/visitors/visitor.h"
+
+namespace cascade::native {
+
+// A verilator-based compiler which builds a native model for each logic core.
+// Each core runs in its own shared library, so unlike the avmm backends, any
+// number of modules can be compiled and run concurrently. Modules which use
+// file i/o tasks are not supported, with the exception of $display and $write
+// (and $fdisplay and $fwrite to the standard streams) of non-real values.
+
+class NativeCompiler : public CoreCompiler {
+  public:
+    NativeCompiler();
+    ~NativeCompiler() override = default;
+
+    // Core Compiler Interface:
+    void stop_compile(Engine::Id id) override;
+
+  private:
+    // Compilation State:
+    std::mutex lock_;
+    std::unordered_map<Engine::Id, pid_t> pids_;
+    std::unordered_set<Engine::Id> stopped_;
+
+    // Core Compiler Interface:
+    NativeLogic* compile_logic(Engine::Id id, ModuleDeclaration* md, Interface* interface) override;
+
+    // Codegen Helpers:
+    std::string get_accessors(const NativeLogic* nl, NativeRewrite* nr) const;
+
+    // Checks for language features that the harness can't support
+    class Unsupported : public Visitor {
+      public:
+        Unsupported();
+        ~Unsupported() override = default;
+        bool found() const;
+      private:
+        bool found_;
+        void visit(const FeofExpression* fe) override;
+        void visit(const FopenExpression* fe) override;
+        void visit(const FflushStatement* fs) override;
+        void visit(const FseekStatement* fs) override;
+        void visit(const GetStatement* gs) override;
+        void visit(const PutStatement* ps) override;
+    };
+};
+
+} // namespace cascade::native
+
+#endif
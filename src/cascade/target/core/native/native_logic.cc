@@ -0,0 +1,487 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "target/core/native/native_logic.h"
+
+#include <algorithm>
+#include <cassert>
+#include <dlfcn.h>
+#include <sstream>
+#include "target/core/native/native_rewrite.h"
+#include "target/input.h"
+#include "target/interface.h"
+#include "target/state.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/resolve.h"
+
+using namespace std;
+
+namespace cascade::native {
+
+NativeLogic::NativeLogic(Interface* interface, ModuleDeclaration* md) : Logic(interface), sync_(this) {
+  handle_ = nullptr;
+  src_ = md;
+  there_were_tasks_ = false;
+}
+
+NativeLogic::~NativeLogic() {
+  if (handle_ != nullptr) {
+    harness_.final();
+    dlclose(handle_);
+  }
+  delete src_;
+  for (auto& s : streams_) {
+    delete s.second;
+  }
+}
+
+NativeLogic& NativeLogic::set_input(const Identifier* id, VId vid) {
+  insert(id);
+  if (inputs_.size() <= vid) {
+    inputs_.resize(vid+1, nullptr);
+  }
+  inputs_[vid] = id;
+  return *this;
+}
+
+NativeLogic& NativeLogic::set_state(bool is_volatile, const Identifier* id, VId vid) {
+  insert(id);
+  if (!is_volatile) {
+    state_.insert(make_pair(vid, id));
+  }
+  return *this;
+}
+
+NativeLogic& NativeLogic::set_output(const Identifier* id, VId vid) {
+  insert(id);
+  outputs_.push_back(make_pair(id, vid));
+  return *this;
+}
+
+NativeLogic& NativeLogic::index_tasks() {
+  Inserter i(this);
+  src_->accept(&i);
+  return *this;
+}
+
+bool NativeLogic::set_library(const string& path) {
+  handle_ = dlopen(path.c_str(), RTLD_LAZY);
+  if (handle_ == nullptr) {
+    return false;
+  }
+  harness_.final = (void (*)()) dlsym(handle_, "native_final");
+  harness_.read = (void (*)(size_t, size_t, uint32_t*)) dlsym(handle_, "native_read");
+  harness_.write = (void (*)(size_t, size_t, const uint32_t*)) dlsym(handle_, "native_write");
+  harness_.eval = (bool (*)()) dlsym(handle_, "native_eval");
+  harness_.tasks = (size_t (*)()) dlsym(handle_, "native_tasks");
+  harness_.task = (size_t (*)(size_t)) dlsym(handle_, "native_task");
+  harness_.put = (void (*)(size_t, size_t, uint32_t*)) dlsym(handle_, "native_put");
+  harness_.open_loop = (size_t (*)(bool, size_t)) dlsym(handle_, "native_open_loop");
+
+  auto init = (void (*)()) dlsym(handle_, "native_init");
+  init();
+  return true;
+}
+
+const ModuleDeclaration* NativeLogic::get_src() const {
+  return src_;
+}
+
+const vector<NativeLogic::Var>& NativeLogic::get_vars() const {
+  return vars_;
+}
+
+size_t NativeLogic::get_num_tasks() const {
+  return tasks_index_.size();
+}
+
+size_t NativeLogic::get_put_width(size_t task) const {
+  assert(task < tasks_index_.size());
+  const auto* t = tasks_index_[task];
+  if (!t->is(Node::Tag::put_statement) || !static_cast<const PutStatement*>(t)->is_non_null_expr()) {
+    return 0;
+  }
+  return Evaluate().get_width(static_cast<const PutStatement*>(t)->get_expr());
+}
+
+const Identifier* NativeLogic::get_open_loop_clock() const {
+  // Open loop execution is only possible for modules with a single one-bit
+  // input and no outputs.
+  const Identifier* res = nullptr;
+  for (const auto* i : inputs_) {
+    if (i == nullptr) {
+      continue;
+    } else if (res != nullptr) {
+      return nullptr;
+    }
+    res = i;
+  }
+  if ((res == nullptr) || !outputs_.empty()) {
+    return nullptr;
+  }
+  return (vars_[var_index_.find(res)->second].width == 1) ? res : nullptr;
+}
+
+State* NativeLogic::get_state() {
+  auto* s = new State();
+  for (const auto& sv : state_) {
+    read_var(sv.second);
+    s->insert(sv.first, eval_.get_array_value(sv.second));
+  }
+  return s;
+}
+
+void NativeLogic::set_state(const State* s) {
+  for (const auto& sv : state_) {
+    const auto itr = s->find(sv.first);
+    if (itr != s->end()) {
+      write_var(sv.second, itr->second);
+    }
+  }
+}
+
+Input* NativeLogic::get_input() {
+  auto* i = new Input();
+  for (size_t v = 0, ve = inputs_.size(); v < ve; ++v) {
+    const auto* id = inputs_[v];
+    if (id == nullptr) {
+      continue;
+    }
+    read_var(id);
+    i->insert(v, eval_.get_value(id));
+  }
+  return i;
+}
+
+void NativeLogic::set_input(const Input* i) {
+  for (size_t v = 0, ve = inputs_.size(); v < ve; ++v) {
+    const auto* id = inputs_[v];
+    if (id == nullptr) {
+      continue;
+    }
+    const auto itr = i->find(v);
+    if (itr != i->end()) {
+      write_var(id, itr->second);
+    }
+  }
+}
+
+void NativeLogic::finalize() {
+  // Every output is reported on the first call to update()
+  published_.clear();
+  pending_.clear();
+  for (size_t k = 0, ke = outputs_.size(); k < ke; ++k) {
+    read_var(outputs_[k].first);
+    published_.push_back(eval_.get_value(outputs_[k].first));
+    pending_.push_back(k);
+  }
+}
+
+void NativeLogic::read(VId id, const Bits* b) {
+  assert(id < inputs_.size());
+  assert(inputs_[id] != nullptr);
+  write_var(inputs_[id], *b);
+}
+
+void NativeLogic::evaluate() {
+  there_were_tasks_ = false;
+  if (harness_.eval()) {
+    handle_tasks();
+  }
+  check_outputs();
+}
+
+bool NativeLogic::there_are_updates() const {
+  return !pending_.empty();
+}
+
+void NativeLogic::update() {
+  for (auto k : pending_) {
+    published_[k] = eval_.get_value(outputs_[k].first);
+    interface()->write(outputs_[k].second, &published_[k]);
+  }
+  pending_.clear();
+}
+
+bool NativeLogic::there_were_tasks() const {
+  return there_were_tasks_;
+}
+
+size_t NativeLogic::open_loop(VId clk, bool val, size_t itr) {
+  if (get_open_loop_clock() == nullptr) {
+    return Logic::open_loop(clk, val, itr);
+  }
+  // The harness toggles the clock and evaluates the model in a native loop
+  // which returns early if a task is triggered.
+  there_were_tasks_ = false;
+  const auto res = harness_.open_loop(val, itr);
+  handle_tasks();
+  return res;
+}
+
+void NativeLogic::insert(const Identifier* id) {
+  if (var_index_.find(id) != var_index_.end()) {
+    return;
+  }
+
+  Var v;
+  v.id = id;
+  v.is_port = ModuleInfo(src_).is_input(id) || ModuleInfo(src_).is_output(id);
+  v.width = eval_.get_width(id);
+  v.arity = eval_.get_arity(id);
+  v.elements = 1;
+  for (auto a : v.arity) {
+    v.elements *= a;
+  }
+  v.words = (v.width + 31) / 32;
+
+  var_index_.insert(make_pair(id, vars_.size()));
+  vars_.push_back(v);
+  if (buffer_.size() < v.words) {
+    buffer_.resize(v.words);
+  }
+}
+
+void NativeLogic::read_var(const Identifier* id) {
+  const auto itr = var_index_.find(id);
+  assert(itr != var_index_.end());
+  const auto& v = vars_[itr->second];
+
+  for (size_t i = 0; i < v.elements; ++i) {
+    harness_.read(itr->second, i, buffer_.data());
+    for (size_t j = 0; j < v.words; ++j) {
+      eval_.assign_word<uint32_t>(id, i, j, buffer_[j]);
+    }
+  }
+}
+
+void NativeLogic::write_var(const Identifier* id, const Bits& val) {
+  const auto itr = var_index_.find(id);
+  assert(itr != var_index_.end());
+  const auto& v = vars_[itr->second];
+  assert(v.elements == 1);
+
+  for (size_t j = 0; j < v.words; ++j) {
+    buffer_[j] = val.read_word<uint32_t>(j);
+  }
+  harness_.write(itr->second, 0, buffer_.data());
+}
+
+void NativeLogic::write_var(const Identifier* id, const Vector<Bits>& val) {
+  const auto itr = var_index_.find(id);
+  assert(itr != var_index_.end());
+  const auto& v = vars_[itr->second];
+  assert(val.size() == v.elements);
+
+  for (size_t i = 0; i < v.elements; ++i) {
+    for (size_t j = 0; j < v.words; ++j) {
+      buffer_[j] = val[i].read_word<uint32_t>(j);
+    }
+    harness_.write(itr->second, i, buffer_.data());
+  }
+}
+
+void NativeLogic::check_outputs() {
+  pending_.clear();
+  for (size_t k = 0, ke = outputs_.size(); k < ke; ++k) {
+    const auto* id = outputs_[k].first;
+    read_var(id);
+    if (eval_.get_value(id) != published_[k]) {
+      pending_.push_back(k);
+    }
+  }
+}
+
+void NativeLogic::handle_tasks() {
+  if (tasks_index_.empty()) {
+    return;
+  }
+  // Replay tasks in the order in which they fired. Tasks which fired after
+  // the log was full weren't recorded, so all we can do is report them.
+  const auto n = harness_.tasks();
+  const auto ne = min(n, NativeRewrite::log_depth_);
+  for (size_t e = 0; e < ne; ++e) {
+    const auto k = harness_.task(e);
+    assert(k < tasks_index_.size());
+    const auto* task = tasks_index_[k];
+    switch (task->get_tag()) {
+      case Node::Tag::debug_statement: {
+        const auto* ds = static_cast<const DebugStatement*>(task);
+        stringstream ss;
+        ss << ds->get_arg();
+        interface()->debug(eval_.get_value(ds->get_action()).to_uint(), ss.str());
+        break;
+      }
+      case Node::Tag::finish_statement: {
+        const auto* fs = static_cast<const FinishStatement*>(task);
+        fs->accept_arg(&sync_);
+        interface()->finish(eval_.get_value(fs->get_arg()).to_uint());
+        there_were_tasks_ = true;
+        break;
+      }
+      case Node::Tag::put_statement: {
+        const auto* ps = static_cast<const PutStatement*>(task);
+        ps->accept_fd(&sync_);
+        put(k, e, ps);
+        break;
+      }
+      case Node::Tag::restart_statement: {
+        const auto* rs = static_cast<const RestartStatement*>(task);
+        interface()->restart(rs->get_arg()->get_readable_val());
+        there_were_tasks_ = true;
+        break;
+      }
+      case Node::Tag::retarget_statement: {
+        const auto* rs = static_cast<const RetargetStatement*>(task);
+        interface()->retarget(rs->get_arg()->get_readable_val());
+        there_were_tasks_ = true;
+        break;
+      }
+      case Node::Tag::save_statement: {
+        const auto* ss = static_cast<const SaveStatement*>(task);
+        interface()->save(ss->get_arg()->get_readable_val());
+        there_were_tasks_ = true;
+        break;
+      }
+      case Node::Tag::yield_statement: {
+        interface()->yield();
+        there_were_tasks_ = true;
+        break;
+      }
+      default:
+        assert(false);
+        break;
+    }
+  }
+  if (n > ne) {
+    *get_stream(Runtime::stdwarn_) << "Native task log overflowed, " << (n - ne) << " system task(s) were dropped!" << endl;
+  }
+}
+
+interfacestream* NativeLogic::get_stream(FId fd) {
+  const auto itr = streams_.find(fd);
+  if (itr != streams_.end()) {
+    return itr->second;
+  }
+  auto* is = new interfacestream(interface(), fd);
+  streams_[fd] = is;
+  return is;
+}
+
+void NativeLogic::put(size_t task, size_t entry, const PutStatement* ps) {
+  auto* is = get_stream(eval_.get_value(ps->get_fd()).to_uint());
+  if (!ps->is_non_null_expr()) {
+    printf_.write(*is, &eval_, ps);
+    return;
+  }
+
+  // The argument was captured by the model when the put executed, and may no
+  // longer match the values of the variables it refers to. Each execution is
+  // recorded separately, alongside its entry in the task log.
+  const auto width = get_put_width(task);
+  const auto words = (width + 31) / 32;
+  if (buffer_.size() < words) {
+    buffer_.resize(words);
+  }
+  harness_.put(task, entry, buffer_.data());
+  Bits val(width, eval_.get_type(ps->get_expr()));
+  for (size_t j = 0; j < words; ++j) {
+    val.write_word<uint32_t>(j, buffer_[j]);
+  }
+  printf_.write(*is, val, ps);
+}
+
+NativeLogic::Inserter::Inserter(NativeLogic* nl) : Visitor() {
+  nl_ = nl;
+  in_args_ = false;
+}
+
+void NativeLogic::Inserter::visit(const Identifier* id) {
+  Visitor::visit(id);
+  const auto* r = Resolve().get_resolution(id);
+  if (in_args_ && (r != nullptr)) {
+    nl_->insert(r);
+  }
+}
+
+void NativeLogic::Inserter::visit(const DebugStatement* ds) {
+  nl_->tasks_index_.push_back(ds);
+  // Don't descend, there aren't any expressions below here
+}
+
+void NativeLogic::Inserter::visit(const FinishStatement* fs) {
+  nl_->tasks_index_.push_back(fs);
+  in_args_ = true;
+  fs->accept_arg(this);
+  in_args_ = false;
+}
+
+void NativeLogic::Inserter::visit(const PutStatement* ps) {
+  nl_->tasks_index_.push_back(ps);
+  // Only the file descriptor is read back from the model, the argument is
+  // captured by the rewritten code
+  in_args_ = true;
+  ps->accept_fd(this);
+  in_args_ = false;
+}
+
+void NativeLogic::Inserter::visit(const RestartStatement* rs) {
+  nl_->tasks_index_.push_back(rs);
+  // Don't descend, there aren't any expressions below here
+}
+
+void NativeLogic::Inserter::visit(const RetargetStatement* rs) {
+  nl_->tasks_index_.push_back(rs);
+  // Don't descend, there aren't any expressions below here
+}
+
+void NativeLogic::Inserter::visit(const SaveStatement* ss) {
+  nl_->tasks_index_.push_back(ss);
+  // Don't descend, there aren't any expressions below here
+}
+
+void NativeLogic::Inserter::visit(const YieldStatement* ys) {
+  nl_->tasks_index_.push_back(ys);
+  // Don't descend, there aren't any expressions below here
+}
+
+NativeLogic::ValSync::ValSync(NativeLogic* nl) : Visitor() {
+  nl_ = nl;
+}
+
+void NativeLogic::ValSync::visit(const Identifier* id) {
+  id->accept_dim(this);
+  const auto* r = Resolve().get_resolution(id);
+  assert(r != nullptr);
+  assert(nl_->var_index_.find(r) != nl_->var_index_.end());
+  nl_->read_var(r);
+}
+
+} // namespace cascade::native
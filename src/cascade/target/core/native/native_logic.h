@@ -0,0 +1,195 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_LOGIC_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_LOGIC_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/bits.h"
+#include "target/core.h"
+#include "target/core/common/interfacestream.h"
+#include "target/core/common/printf.h"
+#include "verilog/analyze/evaluate.h"
+#include "verilog/ast/ast.h"
+#include "verilog/ast/visitors/visitor.h"
+
+namespace cascade::native {
+
+// A logic core which is backed by a verilator model of its source. Unlike the
+// avmm backends, which emulate a memory-mapped device, this core reads and
+// writes the model's ports and state directly through a generated harness
+// which is loaded from a shared library.
+
+class NativeLogic : public Logic {
+  public:
+    // Variable Index:
+    //
+    // Every variable which the harness can access is assigned a sequential
+    // index. Values are transferred as little-endian sequences of 32-bit
+    // words, one element at a time.
+    struct Var {
+      const Identifier* id;
+      bool is_port;
+      size_t width;
+      std::vector<size_t> arity;
+      size_t elements;
+      size_t words;
+    };
+
+    // Constructors:
+    NativeLogic(Interface* interface, ModuleDeclaration* md);
+    ~NativeLogic() override;
+
+    // Configuration Methods:
+    NativeLogic& set_input(const Identifier* id, VId vid);
+    NativeLogic& set_state(bool is_volatile, const Identifier* id, VId vid);
+    NativeLogic& set_output(const Identifier* id, VId vid);
+    NativeLogic& index_tasks();
+    // Attaches this core to the harness in the shared library at path and
+    // initializes its model. Returns false if the library can't be loaded.
+    bool set_library(const std::string& path);
+
+    // Configuration Properties:
+    const ModuleDeclaration* get_src() const;
+    const std::vector<Var>& get_vars() const;
+    size_t get_num_tasks() const;
+    // Returns the width of the argument of a put, or 0 if task isn't a put or
+    // doesn't have an argument
+    size_t get_put_width(size_t task) const;
+    const Identifier* get_open_loop_clock() const;
+
+    // Core Interface:
+    State* get_state() override;
+    void set_state(const State* s) override;
+    Input* get_input() override;
+    void set_input(const Input* i) override;
+    void finalize() override;
+
+    void read(VId id, const Bits* b) override;
+    void evaluate() override;
+    bool there_are_updates() const override;
+    void update() override;
+    bool there_were_tasks() const override;
+
+    size_t open_loop(VId clk, bool val, size_t itr) override;
+
+  private:
+    // Harness Interface:
+    struct Harness {
+      void (*final)();
+      void (*read)(size_t, size_t, uint32_t*);
+      void (*write)(size_t, size_t, const uint32_t*);
+      bool (*eval)();
+      size_t (*tasks)();
+      size_t (*task)(size_t);
+      void (*put)(size_t, size_t, uint32_t*);
+      size_t (*open_loop)(bool, size_t);
+    };
+    void* handle_;
+    Harness harness_;
+
+    // Source Management:
+    ModuleDeclaration* src_;
+    std::vector<const Identifier*> inputs_;
+    std::unordered_map<VId, const Identifier*> state_;
+    std::vector<std::pair<const Identifier*, VId>> outputs_;
+    std::vector<const SystemTaskEnableStatement*> tasks_index_;
+    const Identifier* clock_;
+
+    // Variable Index:
+    std::vector<Var> vars_;
+    std::unordered_map<const Identifier*, size_t> var_index_;
+    std::vector<uint32_t> buffer_;
+
+    // File I/O State:
+    std::unordered_map<FId, interfacestream*> streams_;
+
+    // Control State:
+    //
+    // Verilator applies non-blocking assignments as part of evaluation. To
+    // preserve the order in which the runtime makes updates visible, changes
+    // to outputs are held back until the next call to update().
+    bool there_were_tasks_;
+    std::vector<Bits> published_;
+    std::vector<size_t> pending_;
+
+    // Variable Helpers:
+    void insert(const Identifier* id);
+    void read_var(const Identifier* id);
+    void write_var(const Identifier* id, const Bits& val);
+    void write_var(const Identifier* id, const Vector<Bits>& val);
+
+    // Control Helpers:
+    void check_outputs();
+    void handle_tasks();
+    interfacestream* get_stream(FId fd);
+    void put(size_t task, size_t entry, const PutStatement* ps);
+
+    // Indexes control tasks and inserts the identifiers which appear in their
+    // arguments into the variable index.
+    class Inserter : public Visitor {
+      public:
+        explicit Inserter(NativeLogic* nl);
+        ~Inserter() override = default;
+      private:
+        NativeLogic* nl_;
+        bool in_args_;
+        void visit(const Identifier* id) override;
+        void visit(const DebugStatement* ds) override;
+        void visit(const FinishStatement* fs) override;
+        void visit(const PutStatement* ps) override;
+        void visit(const RestartStatement* rs) override;
+        void visit(const RetargetStatement* rs) override;
+        void visit(const SaveStatement* ss) override;
+        void visit(const YieldStatement* ys) override;
+    };
+
+    // Synchronizes the values of the identifiers which appear in an AST
+    // subtree with the model.
+    class ValSync : public Visitor {
+      public:
+        explicit ValSync(NativeLogic* nl);
+        ~ValSync() override = default;
+      private:
+        NativeLogic* nl_;
+        void visit(const Identifier* id) override;
+    };
+
+    // Evaluation Helpers:
+    Evaluate eval_;
+    ValSync sync_;
+    Printf printf_;
+};
+
+} // namespace cascade::native
+
+#endif
@@ -0,0 +1,219 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "target/core/native/native_rewrite.h"
+
+#include <cassert>
+#include "verilog/analyze/evaluate.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/build/ast_builder.h"
+
+using namespace std;
+
+namespace cascade::native {
+
+NativeRewrite::NativeRewrite() : Builder() { }
+
+ModuleDeclaration* NativeRewrite::run(const ModuleDeclaration* md) {
+  tasks_.clear();
+  TaskIndex ti(this);
+  md->accept(&ti);
+  auto* res = md->accept(this);
+
+  // Declare the task log if any tasks were replaced, along with an array for
+  // each put which holds the values of its argument
+  if (!tasks_.empty()) {
+    ItemBuilder ib;
+    ib << "reg[31:0] ntasks = 0;" << endl;
+    ib << "reg[31:0] tasks[" << (log_depth_-1) << ":0];" << endl;
+    for (const auto& t : tasks_) {
+      if (t.first->is(Node::Tag::put_statement) && static_cast<const PutStatement*>(t.first)->is_non_null_expr()) {
+        const auto w = Evaluate().get_width(static_cast<const PutStatement*>(t.first)->get_expr());
+        ib << "reg[" << (w-1) << ":0] " << get_put_name(t.second) << "[" << (log_depth_-1) << ":0];" << endl;
+      }
+    }
+    for (auto i = ib.begin(), ie = ib.end(); i != ie; ++i) {
+      res->push_front_items(*i);
+    }
+  }
+  return res;
+}
+
+string NativeRewrite::get_put_name(size_t task) const {
+  return "p" + to_string(task);
+}
+
+const string& NativeRewrite::get_name(const Identifier* id) {
+  auto itr = names_.find(id);
+  if (itr == names_.end()) {
+    itr = names_.insert(make_pair(id, "v" + to_string(names_.size()))).first;
+  }
+  return itr->second;
+}
+
+Attributes* NativeRewrite::build(const Attributes* as) {
+  (void) as;
+  return new Attributes();
+}
+
+Expression* NativeRewrite::build(const Identifier* id) {
+  const auto* r = Resolve().get_resolution(id);
+  if (r == nullptr) {
+    return Builder::build(id);
+  }
+  auto* res = new Identifier(get_name(r));
+  id->accept_dim(this, res->back_inserter_dim());
+  return res;
+}
+
+ModuleDeclaration* NativeRewrite::build(const ModuleDeclaration* md) {
+  // Index port declarations by name so that the port list can be renamed
+  // consistently with the declarations it refers to.
+  unordered_map<string, const Identifier*> ports;
+  for (auto i = md->begin_items(), ie = md->end_items(); i != ie; ++i) {
+    if ((*i)->is(Node::Tag::port_declaration)) {
+      const auto* id = static_cast<const PortDeclaration*>(*i)->get_decl()->get_id();
+      ports[id->front_ids()->get_readable_sid()] = id;
+    }
+  }
+
+  auto* res = new ModuleDeclaration(new Attributes(), new Identifier("program_logic"));
+  for (auto i = md->begin_ports(), ie = md->end_ports(); i != ie; ++i) {
+    const auto itr = (*i)->is_non_null_exp() ? ports.find((*i)->get_exp()->front_ids()->get_readable_sid()) : ports.end();
+    if (itr != ports.end()) {
+      res->push_back_ports(new ArgAssign(new Identifier(get_name(itr->second)), nullptr));
+    } else {
+      res->push_back_ports((*i)->accept(this));
+    }
+  }
+  md->accept_items(this, res->back_inserter_items());
+  return res;
+}
+
+Statement* NativeRewrite::build(const DebugStatement* ds) {
+  return log_task(ds);
+}
+
+Statement* NativeRewrite::build(const FinishStatement* fs) {
+  return log_task(fs);
+}
+
+Statement* NativeRewrite::build(const PutStatement* ps) {
+  // Verilator runs to the end of the time step before the host sees the task
+  // log, so capture the value of the argument while it's still current.
+  return ps->is_non_null_expr() ? log_task(ps, ps->get_expr()->accept(this)) : log_task(ps);
+}
+
+Statement* NativeRewrite::build(const RestartStatement* rs) {
+  return log_task(rs);
+}
+
+Statement* NativeRewrite::build(const RetargetStatement* rs) {
+  return log_task(rs);
+}
+
+Statement* NativeRewrite::build(const SaveStatement* ss) {
+  return log_task(ss);
+}
+
+Statement* NativeRewrite::build(const YieldStatement* ys) {
+  return log_task(ys);
+}
+
+Statement* NativeRewrite::log_task(const Node* s, Expression* arg) {
+  const auto itr = tasks_.find(s);
+  assert(itr != tasks_.end());
+
+  auto* append = new SeqBlock();
+  append->push_back_stmts(new BlockingAssign(
+    new Identifier(new Id("tasks"), new Identifier("ntasks")),
+    new Number(Bits(32, itr->second))
+  ));
+  if (arg != nullptr) {
+    append->push_back_stmts(new BlockingAssign(
+      new Identifier(new Id(get_put_name(itr->second)), new Identifier("ntasks")),
+      arg
+    ));
+  }
+
+  auto* res = new SeqBlock();
+  res->push_back_stmts(new ConditionalStatement(
+    new BinaryExpression(
+      new Identifier("ntasks"),
+      BinaryExpression::Op::LT,
+      new Number(Bits(32, log_depth_))
+    ),
+    append,
+    new SeqBlock()
+  ));
+  res->push_back_stmts(new BlockingAssign(
+    new Identifier("ntasks"),
+    new BinaryExpression(
+      new Identifier("ntasks"),
+      BinaryExpression::Op::PLUS,
+      new Number(Bits(32, 1))
+    )
+  ));
+  return res;
+}
+
+NativeRewrite::TaskIndex::TaskIndex(NativeRewrite* nr) : Visitor() {
+  nr_ = nr;
+}
+
+void NativeRewrite::TaskIndex::visit(const DebugStatement* ds) {
+  nr_->tasks_.insert(make_pair(ds, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const FinishStatement* fs) {
+  nr_->tasks_.insert(make_pair(fs, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const PutStatement* ps) {
+  nr_->tasks_.insert(make_pair(ps, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const RestartStatement* rs) {
+  nr_->tasks_.insert(make_pair(rs, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const RetargetStatement* rs) {
+  nr_->tasks_.insert(make_pair(rs, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const SaveStatement* ss) {
+  nr_->tasks_.insert(make_pair(ss, nr_->tasks_.size()));
+}
+
+void NativeRewrite::TaskIndex::visit(const YieldStatement* ys) {
+  nr_->tasks_.insert(make_pair(ys, nr_->tasks_.size()));
+}
+
+} // namespace cascade::native
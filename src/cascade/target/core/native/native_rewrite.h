@@ -0,0 +1,114 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_REWRITE_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_REWRITE_H
+
+#include <string>
+#include <unordered_map>
+#include "verilog/ast/ast.h"
+#include "verilog/ast/visitors/builder.h"
+#include "verilog/ast/visitors/visitor.h"
+
+namespace cascade::native {
+
+// This pass prepares a module declaration for compilation by verilator. It
+// performs the following text transformations:
+// 1. The module is renamed program_logic.
+// 2. Attribute annotations are deleted.
+// 3. Every variable is given a short name which is safe to reference from C++.
+// 4. Control tasks ($debug, $finish, $restart, $retarget, $save, $yield) and
+//    output tasks ($display, $write) are replaced by appends to a task log,
+//    tasks, whose length is held in ntasks. Tasks are numbered in the order
+//    in which they're encountered by a recursive descent of the AST, as in
+//    NativeLogic::index_tasks(), and logged in the order in which they fire.
+// 5. The argument of each output task is copied into the entry of the array
+//    named by get_put_name() which corresponds to its entry in the log.
+//
+// The log holds at most log_depth_ entries. Tasks which fire after the log is
+// full are counted, but not recorded.
+
+class NativeRewrite : public Builder {
+  public:
+    // Constexprs:
+    static constexpr size_t log_depth_ = 1024;
+
+    // Constructors:
+    NativeRewrite();
+    ~NativeRewrite() override = default;
+
+    // Returns a rewritten copy of md
+    ModuleDeclaration* run(const ModuleDeclaration* md);
+    // Returns the name assigned to a variable in rewritten code
+    const std::string& get_name(const Identifier* id);
+    // Returns the name of the array which holds the arguments of a put
+    std::string get_put_name(size_t task) const;
+
+  private:
+    std::unordered_map<const Identifier*, std::string> names_;
+    std::unordered_map<const Node*, size_t> tasks_;
+
+    // Numbers control tasks. This is done ahead of time rather than while
+    // building, as the order in which a builder visits sibling nodes isn't
+    // guaranteed to be lexicographic.
+    class TaskIndex : public Visitor {
+      public:
+        explicit TaskIndex(NativeRewrite* nr);
+        ~TaskIndex() override = default;
+      private:
+        NativeRewrite* nr_;
+        void visit(const DebugStatement* ds) override;
+        void visit(const FinishStatement* fs) override;
+        void visit(const PutStatement* ps) override;
+        void visit(const RestartStatement* rs) override;
+        void visit(const RetargetStatement* rs) override;
+        void visit(const SaveStatement* ss) override;
+        void visit(const YieldStatement* ys) override;
+    };
+
+    Attributes* build(const Attributes* as) override;
+    Expression* build(const Identifier* id) override;
+    ModuleDeclaration* build(const ModuleDeclaration* md) override;
+    Statement* build(const DebugStatement* ds) override;
+    Statement* build(const FinishStatement* fs) override;
+    Statement* build(const PutStatement* ps) override;
+    Statement* build(const RestartStatement* rs) override;
+    Statement* build(const RetargetStatement* rs) override;
+    Statement* build(const SaveStatement* ss) override;
+    Statement* build(const YieldStatement* ys) override;
+
+    // Returns a statement which appends s to the task log, along with the
+    // value of its argument if it has one
+    Statement* log_task(const Node* s, Expression* arg = nullptr);
+};
+
+} // namespace cascade::native
+
+#endif
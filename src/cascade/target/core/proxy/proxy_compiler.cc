@@ -30,12 +30,24 @@
 
 #include "target/core/proxy/proxy_compiler.h"
 
+#include <atomic>
 #include <sstream>
+#include <string>
+#include <unistd.h>
+#include "common/shmring.h"
 
 using namespace std;
 
 namespace cascade::proxy {
 
+namespace {
+
+// Shared memory segments are named by pid and a counter which is shared by
+// every proxy compiler in this process.
+atomic<size_t> next_segment_(0);
+
+} // namespace
+
 ProxyCompiler::ProxyCompiler() : CoreCompiler() { 
   pool_.set_num_threads(4);
   pool_.run();
@@ -52,6 +64,13 @@ ProxyCompiler::~ProxyCompiler() {
     delete c.second.async_sock;
     delete c.second.sync_sock;
   }
+  // Closing pooled sockets is enough to notify the remote compiler that it can
+  // release them as well.
+  for (auto& i : idle_) {
+    for (auto* s : i.second) {
+      delete s;
+    }
+  }
 }
 
 void ProxyCompiler::stop_async() {
@@ -130,14 +149,14 @@ void ProxyCompiler::stop_compile(Engine::Id id) {
   // connection was opened, all further communication will succeed.
 
   for (auto& c : conns_) {
-    auto* sock = get_sock(c.first);
+    auto* sock = acquire_sock(c.first, c.second);
     assert(sock != nullptr);
     Rpc(Rpc::Type::STOP_COMPILE, c.second.pid, id, 0).serialize(*sock);
     sock->flush();
     Rpc rpc;
     rpc.deserialize(*sock);
     assert(rpc.type_ == Rpc::Type::OKAY);
-    delete sock;
+    release_sock(c.first, c.second, sock);
   }
 }
 
@@ -162,28 +181,53 @@ bool ProxyCompiler::open(const string& loc) {
   // first connection attempt succeded, then all subsequent parts of the
   // handshake will succeed as well.
 
-  // Step 1: Open the asynchronous socket and sent a register request.  The
-  // reply will contain the id the remote compiler associates with this
-  // compiler.
+  // Step 1: Open the asynchronous socket and sent a register request along
+  // with the protocol extensions we support. The reply will contain the id the
+  // remote compiler associates with this compiler and the subset of those
+  // extensions that it supports as well.
   ci.async_sock = get_sock(loc);
   if (ci.async_sock == nullptr) {
     return false;
   }
-  Rpc(Rpc::Type::OPEN_CONN_1, 0, 0, 0).serialize(*ci.async_sock);
+  // Shared memory is only an option for remote compilers on this host.
+  const auto local = loc.find(':') == string::npos;
+  const auto caps = local ? Rpc::capabilities : (Rpc::capabilities & ~Rpc::SHARED_MEMORY);
+  Rpc(Rpc::Type::OPEN_CONN_1, 0, 0, caps).serialize(*ci.async_sock);
   ci.async_sock->flush();
   rpc.deserialize(*ci.async_sock);
   assert(rpc.type_ == Rpc::Type::OKAY);
   ci.pid = rpc.pid_;
+  ci.caps = rpc.n_ & caps;
 
   // Step 2: Open the synchronous socket and send a register request. This
   // time around, send the pid so that the new socket can be associated with
-  // this connection in the remote compiler.
+  // this connection in the remote compiler. If the remote compiler supports
+  // it, follow the request with the name of a shared memory segment. If it
+  // can attach to the segment, all subsequent payloads on this socket are
+  // passed through shared memory. This socket is only ever read while waiting
+  // for a reply, so replies are polled for rather than announced.
   ci.sync_sock = get_sock(loc);
   assert(ci.sync_sock != nullptr);
-  Rpc(Rpc::Type::OPEN_CONN_2, ci.pid, 0, 0).serialize(*ci.sync_sock);
+  shmsegment* seg = nullptr;
+  const auto name = "/cascade." + to_string(::getpid()) + "." + to_string(next_segment_++);
+  if (ci.caps & Rpc::SHARED_MEMORY) {
+    seg = shmsegment::create(name);
+  }
+  Rpc(Rpc::Type::OPEN_CONN_2, ci.pid, 0, (seg != nullptr) ? 1 : 0).serialize(*ci.sync_sock);
+  if (seg != nullptr) {
+    ci.sync_sock->write(name.c_str(), name.length()+1);
+  }
   ci.sync_sock->flush();
   rpc.deserialize(*ci.sync_sock);
   assert(rpc.type_ == Rpc::Type::OKAY);
+  if (seg != nullptr) {
+    seg->unlink();
+    if (rpc.n_ == 1) {
+      ci.sync_sock->share(seg, true);
+    } else {
+      delete seg;
+    }
+  }
 
   // Step 3: Create a thread to listen for asynchronous messages 
   pool_.insert([this, ci]{async_loop(ci.async_sock);});
@@ -193,6 +237,28 @@ bool ProxyCompiler::open(const string& loc) {
   return true;
 }
 
+sockstream* ProxyCompiler::acquire_sock(const string& loc, const ConnInfo& ci) {
+  if (ci.caps & Rpc::POOLED_SOCKETS) {
+    lock_guard<mutex> lg(lock_);
+    auto& idle = idle_[loc];
+    if (!idle.empty()) {
+      auto* sock = idle.back();
+      idle.pop_back();
+      return sock;
+    }
+  }
+  return get_sock(loc);
+}
+
+void ProxyCompiler::release_sock(const string& loc, const ConnInfo& ci, sockstream* sock) {
+  if (ci.caps & Rpc::POOLED_SOCKETS) {
+    lock_guard<mutex> lg(lock_);
+    idle_[loc].push_back(sock);
+  } else {
+    delete sock;
+  }
+}
+
 sockstream* ProxyCompiler::get_sock(const string& loc) {
   auto* sock = (loc.find(':') != string::npos) ? get_tcp_sock(loc) : get_unix_sock(loc);
   if (sock->error()) {
@@ -34,6 +34,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "common/sockstream.h"
 #include "common/thread_pool.h"
 #include "target/compiler.h"
@@ -54,12 +55,20 @@ class ProxyCompiler : public CoreCompiler {
     // Connection State:
     struct ConnInfo {
       uint32_t pid;
+      uint32_t caps;
       sockstream* async_sock;
       sockstream* sync_sock;
     };
     std::unordered_map<std::string, ConnInfo> conns_;
     std::mutex lock_;
 
+    // Pooled Compilation Sockets:
+    //
+    // Remote compilers which support the POOLED_SOCKETS extension keep
+    // compilation sockets open between requests. Idle sockets are indexed by
+    // location and are guarded by the same lock as connection state.
+    std::unordered_map<std::string, std::vector<sockstream*>> idle_;
+
     // Asynchronous Control for State-Safe Requests:
     ThreadPool pool_;
     bool running_;
@@ -86,6 +95,9 @@ class ProxyCompiler : public CoreCompiler {
     bool open(const std::string& loc);
     bool close(const ConnInfo& ci);
 
+    sockstream* acquire_sock(const std::string& loc, const ConnInfo& ci);
+    void release_sock(const std::string& loc, const ConnInfo& ci, sockstream* sock);
+
     sockstream* get_sock(const std::string& loc);
     sockstream* get_tcp_sock(const std::string& loc);
     sockstream* get_unix_sock(const std::string& loc);
@@ -104,7 +116,7 @@ inline ProxyCore<T>* ProxyCompiler::generic_compile(Engine::Id id, ModuleDeclara
 
   // Change __loc to "remote" and send a compile request via a temp socket.  
   md->get_attrs()->set_or_replace("__loc", new String("remote"));
-  auto* sock = get_sock(loc);
+  auto* sock = acquire_sock(loc, conn);
   if (sock == nullptr) {
     get_compiler()->error("Unable to establish connection with remote compiler");
     delete md;
@@ -121,12 +133,12 @@ inline ProxyCore<T>* ProxyCompiler::generic_compile(Engine::Id id, ModuleDeclara
   // remote compiler's engine table
   Rpc res;
   res.deserialize(*sock);
-  delete sock;
+  release_sock(loc, conn, sock);
   if (res.type_ == Rpc::Type::FAIL) {
     get_compiler()->error("An unhandled error occured during compilation in the remote compiler");
     return nullptr;
   }
-  return new ProxyCore<T>(interface, conn.pid, id, res.n_, conn.sync_sock);
+  return new ProxyCore<T>(interface, conn.pid, id, res.n_, conn.caps, conn.sync_sock);
 }
 
 } // namespace cascade::proxy
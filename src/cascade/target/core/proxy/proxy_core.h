@@ -32,9 +32,11 @@
 #define CASCADE_SRC_TARGET_CORE_PROXY_PROXY_CORE_H
 
 #include <string>
+#include <vector>
 #include "common/bits.h"
 #include "common/sockstream.h"
 #include "target/compiler/rpc.h"
+#include "target/compiler/write_batch.h"
 #include "target/core.h"
 #include "target/input.h"
 #include "target/interface.h"
@@ -45,11 +47,13 @@ namespace cascade::proxy {
 template <typename T>
 class ProxyCore : public T {
   public:
-    ProxyCore(Interface* interface, uint32_t pid, uint32_t eid, uint32_t n, sockstream* sock);
+    ProxyCore(Interface* interface, uint32_t pid, uint32_t eid, uint32_t n, uint32_t caps, sockstream* sock);
     ~ProxyCore() override;
 
     State* get_state() override;
     void set_state(const State* s) override;
+    State* get_state_delta(Core::Delta d) override;
+    void clear_state_delta(Core::Delta d) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
     void finalize() override;
@@ -72,17 +76,36 @@ class ProxyCore : public T {
     uint32_t pid_;
     uint32_t eid_;
     uint32_t n_;
+    uint32_t caps_;
     sockstream* sock_;
 
-    void recv();
+    // Batched Step State:
+    //
+    // If the remote compiler supports batched steps, the responses to
+    // evaluate() and update() carry the values of there_are_updates() and
+    // there_were_tasks(). These are cached here until the remote engine's
+    // state is modified by some other means.
+    bool batched_;
+    bool flags_valid_;
+    uint32_t flags_;
+
+    // Batched Write State:
+    std::vector<char> batch_;
+
+    uint32_t recv();
 }; 
 
 template <typename T>
-inline ProxyCore<T>::ProxyCore(Interface* interface, uint32_t pid, uint32_t eid, uint32_t n, sockstream* sock) : T(interface) {
+inline ProxyCore<T>::ProxyCore(Interface* interface, uint32_t pid, uint32_t eid, uint32_t n, uint32_t caps, sockstream* sock) : T(interface) {
   pid_ = pid;
   eid_ = eid;
   n_ = n;
+  caps_ = caps;
   sock_ = sock;
+
+  batched_ = (caps_ & Rpc::BATCHED_STEP) != 0;
+  flags_valid_ = false;
+  flags_ = 0;
 }
 
 template <typename T>
@@ -105,8 +128,38 @@ inline State* ProxyCore<T>::get_state() {
 template <typename T>
 inline void ProxyCore<T>::set_state(const State* s) {
   Rpc(Rpc::Type::SET_STATE, pid_, eid_, n_).serialize(*sock_);
-  s->serialize(*sock_);
+  if ((caps_ & Rpc::TAGGED_STATE) != 0) {
+    s->serialize(*sock_);
+  } else {
+    s->serialize_legacy(*sock_);
+  }
+  sock_->flush();
+  flags_valid_ = false;
+}
+
+template <typename T>
+inline State* ProxyCore<T>::get_state_delta(Core::Delta d) {
+  if ((caps_ & Rpc::STATE_DELTA) == 0) {
+    return get_state();
+  }
+  Rpc(Rpc::Type::GET_STATE_DELTA, pid_, eid_, n_).serialize(*sock_);
+  sock_->put(static_cast<char>(d));
+  sock_->flush();
+
+  auto* s = new State();
+  s->deserialize(*sock_);
+  return s;
+}
+
+template <typename T>
+inline void ProxyCore<T>::clear_state_delta(Core::Delta d) {
+  if ((caps_ & Rpc::STATE_DELTA) == 0) {
+    return;
+  }
+  Rpc(Rpc::Type::CLEAR_STATE_DELTA, pid_, eid_, n_).serialize(*sock_);
+  sock_->put(static_cast<char>(d));
   sock_->flush();
+  recv();
 }
 
 template <typename T>
@@ -122,8 +175,13 @@ inline Input* ProxyCore<T>::get_input() {
 template <typename T>
 inline void ProxyCore<T>::set_input(const Input* i) {
   Rpc(Rpc::Type::SET_INPUT, pid_, eid_, n_).serialize(*sock_);
-  i->serialize(*sock_);
+  if ((caps_ & Rpc::TAGGED_STATE) != 0) {
+    i->serialize(*sock_);
+  } else {
+    i->serialize_legacy(*sock_);
+  }
   sock_->flush();
+  flags_valid_ = false;
 }
 
 template <typename T>
@@ -131,6 +189,7 @@ inline void ProxyCore<T>::finalize() {
   Rpc(Rpc::Type::FINALIZE, pid_, eid_, n_).serialize(*sock_);
   sock_->flush();
   recv();
+  flags_valid_ = false;
 }
 
 template <typename T>
@@ -144,6 +203,7 @@ template <typename T>
 inline void ProxyCore<T>::done_step() {
   Rpc(Rpc::Type::DONE_STEP, pid_, eid_, n_).serialize(*sock_);
   sock_->flush();
+  flags_valid_ = false;
 }
 
 template <typename T>
@@ -171,14 +231,18 @@ inline void ProxyCore<T>::read(VId id, const Bits* b) {
 
 template <typename T>
 inline void ProxyCore<T>::evaluate() {
-  Rpc(Rpc::Type::EVALUATE, pid_, eid_, n_).serialize(*sock_);
+  Rpc(batched_ ? Rpc::Type::BATCH_EVALUATE : Rpc::Type::EVALUATE, pid_, eid_, n_).serialize(*sock_);
   // This call to flush dumps any reads which have been enqueued
   sock_->flush();
-  recv();
+  flags_ = recv();
+  flags_valid_ = batched_;
 }
 
 template <typename T>
 inline bool ProxyCore<T>::there_are_updates() const {
+  if (flags_valid_) {
+    return (flags_ & Rpc::UPDATES) != 0;
+  }
   Rpc(Rpc::Type::THERE_ARE_UPDATES, pid_, eid_, n_).serialize(*sock_);
   sock_->flush();
   return (sock_->get() == 1);
@@ -186,14 +250,18 @@ inline bool ProxyCore<T>::there_are_updates() const {
 
 template <typename T>
 inline void ProxyCore<T>::update() {
-  Rpc(Rpc::Type::UPDATE, pid_, eid_, n_).serialize(*sock_);
+  Rpc(batched_ ? Rpc::Type::BATCH_UPDATE : Rpc::Type::UPDATE, pid_, eid_, n_).serialize(*sock_);
   // This call to flush dumps any reads which have been enqueued
   sock_->flush();
-  recv();
+  flags_ = recv();
+  flags_valid_ = batched_;
 }
 
 template <typename T>
 inline bool ProxyCore<T>::there_were_tasks() const {
+  if (flags_valid_) {
+    return (flags_ & Rpc::TASKS) != 0;
+  }
   Rpc(Rpc::Type::THERE_WERE_TASKS, pid_, eid_, n_).serialize(*sock_);
   sock_->flush();
   return (sock_->get() == 1);
@@ -201,6 +269,20 @@ inline bool ProxyCore<T>::there_were_tasks() const {
 
 template <typename T>
 inline bool ProxyCore<T>::conditional_update() {
+  // Fast Path: We know there aren't any updates, so there's no need to go
+  // over the wire. Any enqueued reads will go out with the next request.
+  if (flags_valid_ && ((flags_ & Rpc::UPDATES) == 0)) {
+    return false;
+  }
+  // Batched Path: The response carries the result along with fresh flags.
+  if (batched_) {
+    Rpc(Rpc::Type::BATCH_CONDITIONAL_UPDATE, pid_, eid_, n_).serialize(*sock_);
+    sock_->flush();
+    flags_ = recv();
+    flags_valid_ = true;
+    return (flags_ & Rpc::RESULT) != 0;
+  }
+  // Slow Path: Old-style request
   Rpc(Rpc::Type::CONDITIONAL_UPDATE, pid_, eid_, n_).serialize(*sock_);
   // This call to flush dumps any reads which have been enqueued
   sock_->flush();
@@ -219,11 +301,12 @@ inline size_t ProxyCore<T>::open_loop(VId clk, bool val, size_t itr) {
   recv();
   uint32_t res = 0;
   sock_->read(reinterpret_cast<char*>(&res), 4);
+  flags_valid_ = false;
   return res;
 }
 
 template <typename T>
-inline void ProxyCore<T>::recv() {
+inline uint32_t ProxyCore<T>::recv() {
   Rpc rpc;
   while (rpc.deserialize(*sock_)) {
     switch(rpc.type_) {
@@ -243,6 +326,18 @@ inline void ProxyCore<T>::recv() {
         T::interface()->write(id, b);
         break;
       }
+      case Rpc::Type::WRITE_BATCH: {
+        uint32_t len = 0;
+        sock_->read(reinterpret_cast<char*>(&len), sizeof(len));
+        batch_.resize(len);
+        sock_->read(batch_.data(), len);
+        const auto res = WriteBatch::decode(batch_.data(), len, [this](VId id, auto b) {
+          T::interface()->write(id, b);
+        });
+        assert(res);
+        (void) res;
+        break;
+      }
 
       case Rpc::Type::DEBUG: {
         uint32_t action = 0;
@@ -396,10 +491,12 @@ inline void ProxyCore<T>::recv() {
       }
 
       case Rpc::Type::OKAY:
+        return rpc.n_;
       default:
-        return;
+        return 0;
     }
   }
+  return 0;
 }
 
 } // namespace cascade::proxy
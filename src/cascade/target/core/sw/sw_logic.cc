@@ -52,6 +52,8 @@ SwLogic::SwLogic(Interface* interface, ModuleDeclaration* md) : Logic(interface)
   // Record pointer to source code and provision update pool
   src_ = md;
   update_pool_.resize(1);
+  track_changes_.fill(false);
+  tracking_ = false;
 
   // Initialize monitors and system tasks
   for (auto i = src_->begin_items(), ie = src_->end_items(); i != ie; ++i) {
@@ -121,6 +123,27 @@ void SwLogic::set_state(const State* s) {
   silent_evaluate();
 }
 
+State* SwLogic::get_state_delta(Delta d) {
+  const auto c = static_cast<size_t>(d);
+  if (!track_changes_[c]) {
+    return get_state();
+  }
+  auto* s = new State();
+  for (const auto& sv : state_) {
+    if (changes_[c].find(sv.second) != changes_[c].end()) {
+      s->insert(sv.first, eval_.get_array_value(sv.second));
+    }
+  }
+  return s;
+}
+
+void SwLogic::clear_state_delta(Delta d) {
+  const auto c = static_cast<size_t>(d);
+  track_changes_[c] = true;
+  changes_[c].clear();
+  tracking_ = true;
+}
+
 Input* SwLogic::get_input() {
   auto* i = new Input();
   for (size_t v = 0, ve = inputs_.size(); v < ve; ++v) {
@@ -264,6 +287,13 @@ void SwLogic::schedule_active(const Node* n) {
 void SwLogic::notify(const Node* n) {
   switch (n->get_tag()) {
     case Node::Tag::identifier:
+      if (tracking_) {
+        for (size_t c = 0; c < num_deltas; ++c) {
+          if (track_changes_[c]) {
+            changes_[c].insert(n);
+          }
+        }
+      }
       for (auto* m : static_cast<const Identifier*>(n)->monitor_) {
         schedule_active(m);
       }
@@ -393,6 +423,26 @@ void SwLogic::visit(const ConditionalStatement* cs) {
   }
 }
 
+void SwLogic::visit(const ForStatement* fs) {
+  // Loops are only present in software if they were too large to unroll.
+  for (schedule_now(fs->get_init()); eval_.get_value(fs->get_cond()).to_bool(); schedule_now(fs->get_update())) {
+    schedule_now(fs->get_stmt());
+  }
+}
+
+void SwLogic::visit(const RepeatStatement* rs) {
+  const auto n = eval_.get_value(rs->get_cond()).to_uint();
+  for (size_t i = 0; i < n; ++i) {
+    schedule_now(rs->get_stmt());
+  }
+}
+
+void SwLogic::visit(const WhileStatement* ws) {
+  while (eval_.get_value(ws->get_cond()).to_bool()) {
+    schedule_now(ws->get_stmt());
+  }
+}
+
 void SwLogic::visit(const FflushStatement* fs) {
   if (!silent_) {
     const auto fd = eval_.get_value(fs->get_fd()).to_uint();
@@ -487,6 +537,13 @@ void SwLogic::visit(const YieldStatement* ys) {
   }
 }
 
+void SwLogic::visit(const VariableAssign* va) {
+  const auto& res = eval_.get_value(va->get_rhs());
+  if (eval_.assign_value(va->get_lhs(), res)) {
+    notify(Resolve().get_resolution(va->get_lhs()));
+  }
+}
+
 void SwLogic::log(const string& op, const Node* n) {
   cout << "[" << src_->get_id() << "] " << op << " " << n << endl;
 }
@@ -31,9 +31,11 @@
 #ifndef CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 
+#include <array>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "common/bits.h"
 #include "target/core.h"
@@ -59,6 +61,8 @@ class SwLogic : public Logic, public Visitor {
     // Core Interface:
     State* get_state() override;
     void set_state(const State* s) override;
+    State* get_state_delta(Delta d) override;
+    void clear_state_delta(Delta d) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
     void finalize() override; 
@@ -94,6 +98,14 @@ class SwLogic : public Logic, public Visitor {
     Evaluate eval_;
     std::unordered_map<FId, interfacestream*> streams_;
 
+    // Change Tracking:
+    //
+    // Once clear_state_delta(d) has been called, every variable which is
+    // notified of a change is recorded in changes_[d] until the next call.
+    std::array<bool, num_deltas> track_changes_;
+    std::array<std::unordered_set<const Node*>, num_deltas> changes_;
+    bool tracking_;
+
     // Scheduling: 
     void schedule_now(const Node* n);
     void schedule_active(const Node* n);
@@ -114,6 +126,9 @@ class SwLogic : public Logic, public Visitor {
     void visit(const SeqBlock* sb) override;
     void visit(const CaseStatement* cs) override;
     void visit(const ConditionalStatement* cs) override;
+    void visit(const ForStatement* fs) override;
+    void visit(const RepeatStatement* rs) override;
+    void visit(const WhileStatement* ws) override;
     void visit(const FflushStatement* fs) override;
     void visit(const FinishStatement* fs) override;
     void visit(const FseekStatement* fs) override;
@@ -124,6 +139,7 @@ class SwLogic : public Logic, public Visitor {
     void visit(const RetargetStatement* rs) override;
     void visit(const SaveStatement* ss) override;
     void visit(const YieldStatement* ys) override;
+    void visit(const VariableAssign* va) override;
 
     // Debug Printing:
     void log(const std::string& op, const Node* n);
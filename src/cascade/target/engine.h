@@ -51,9 +51,11 @@ class Engine {
 
     // Query Interface:
     bool is_clock() const;
+    bool is_led() const;
     bool is_logic() const;
     bool is_stub() const;
     Id get_id() const;
+    Interface* get_interface();
 
     // Scheduling Interface:
     bool overrides_done_step() const;
@@ -77,6 +79,8 @@ class Engine {
     // State Management Interface:
     State* get_state();
     void set_state(const State* s);
+    State* get_state_delta(Core::Delta d);
+    void clear_state_delta(Core::Delta d);
     Input* get_input();
     void set_input(const Input* i);
     void finalize();
@@ -88,6 +92,13 @@ class Engine {
 
     // Compiler Interface:
     void replace_with(Engine* e);
+    // Copies the state of this engine into e and begins tracking the changes
+    // which this engine makes from this point on. This engine continues to
+    // run normally.
+    void precopy_to(Engine* e);
+    // Identical to replace_with(), but only moves the state which has changed
+    // since the previous call to precopy_to().
+    void migrate_to(Engine* e);
 
   private:
     Id id_;
@@ -95,6 +106,9 @@ class Engine {
     Core* c_;
 
     bool there_are_reads_;
+
+    // Compiler Helpers:
+    void move_to(Engine* e);
 };
 
 inline Engine::Engine(Id id, Interface* i, Core* c) {
@@ -119,6 +133,10 @@ inline bool Engine::is_clock() const {
   return c_->is_clock();
 }
 
+inline bool Engine::is_led() const {
+  return c_->is_led();
+}
+
 inline bool Engine::is_logic() const {
   return c_->is_logic();
 }
@@ -127,6 +145,10 @@ inline bool Engine::is_stub() const {
   return c_->is_stub();
 }
 
+inline Interface* Engine::get_interface() {
+  return i_;
+}
+
 inline Engine::Id Engine::get_id() const {
   return id_;
 }
@@ -198,6 +220,14 @@ inline void Engine::set_state(const State* s) {
   c_->set_state(s);
 }
 
+inline State* Engine::get_state_delta(Core::Delta d) {
+  return c_->get_state_delta(d);
+}
+
+inline void Engine::clear_state_delta(Core::Delta d) {
+  c_->clear_state_delta(d);
+}
+
 inline Input* Engine::get_input() {
   return c_->get_input();
 }
@@ -233,6 +263,26 @@ inline void Engine::replace_with(Engine* e) {
   const auto* s = c_->get_state();
   e->c_->set_state(s);
   delete s;
+  move_to(e);
+}
+
+inline void Engine::precopy_to(Engine* e) {
+  const auto* s = c_->get_state();
+  e->c_->set_state(s);
+  delete s;
+  c_->clear_state_delta(Core::Delta::MIGRATION);
+}
+
+inline void Engine::migrate_to(Engine* e) {
+  // Move only the state which has changed since the precopy
+  const auto* s = c_->get_state_delta(Core::Delta::MIGRATION);
+  e->c_->set_state(s);
+  delete s;
+  move_to(e);
+}
+
+inline void Engine::move_to(Engine* e) {
+  // Move inputs from this engine into the new engine
   const auto* i = c_->get_input();
   e->c_->set_input(i);
   delete i;
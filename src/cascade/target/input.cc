@@ -72,10 +72,14 @@ void Input::write(ostream& os, size_t base) const {
 size_t Input::deserialize(istream& is) {
   input_.clear();
 
-  // How many elements are in this input?
+  // Check the format tag. Legacy inputs begin with an element count instead.
   uint32_t n = 0;
   is.read(reinterpret_cast<char*>(&n), 4);
   size_t res = 4;
+  if (n == version_) {
+    is.read(reinterpret_cast<char*>(&n), 4);
+    res += 4;
+  }
 
   // Read that many id / bit pairs
   for (size_t i = 0; i < n; ++i) {
@@ -89,10 +93,10 @@ size_t Input::deserialize(istream& is) {
 }
 
 size_t Input::serialize(ostream& os) const {
-  // How many elements are in this input?
-  uint32_t n = input_.size();
-  os.write(reinterpret_cast<char*>(&n), 4);
-  size_t res = 4;
+  // Format tag and number of elements
+  const uint32_t header[2] = {version_, static_cast<uint32_t>(input_.size())};
+  os.write(reinterpret_cast<const char*>(header), 8);
+  size_t res = 8;
 
   // Write that many id / bit pairs
   for (const auto& i : input_) {
@@ -102,4 +106,17 @@ size_t Input::serialize(ostream& os) const {
   return res;
 }
 
+size_t Input::serialize_legacy(ostream& os) const {
+  // Number of elements, followed by that many id / bit pairs
+  const uint32_t n = input_.size();
+  os.write(reinterpret_cast<const char*>(&n), 4);
+  size_t res = 4;
+
+  for (const auto& i : input_) {
+    os.write(reinterpret_cast<const char*>(&i.first), 4);
+    res += (4 + i.second.serialize(os));
+  }
+  return res;
+}
+
 } // namespace cascade
@@ -58,8 +58,14 @@ class Input : public Serializable {
     void write(std::ostream& os, size_t base) const;
     size_t deserialize(std::istream& is) override;
     size_t serialize(std::ostream& os) const override;
+    // Writes this input in the legacy format, for peers which haven't
+    // advertised the Rpc::TAGGED_STATE capability.
+    size_t serialize_legacy(std::ostream& os) const;
 
   private:
+    // Binary Format: See State::version_
+    static constexpr uint32_t version_ = 0xca5c0001;
+
     std::unordered_map<VId, Bits> input_; 
 };
 
@@ -30,6 +30,8 @@
 
 #include "target/state.h"
 
+#include <vector>
+
 using namespace std;
 
 namespace cascade {
@@ -75,45 +77,87 @@ void State::write(ostream& os, size_t base) const {
 size_t State::deserialize(istream& is) {
   state_.clear();
 
-  // How many elements are in this state?
+  // Check the format tag. Legacy states begin with an element count instead.
+  uint32_t tag = 0;
+  is.read(reinterpret_cast<char*>(&tag), 4);
+  if (tag != version_) {
+    return 4 + deserialize_legacy(is, tag);
+  }
   uint32_t n = 0;
   is.read(reinterpret_cast<char*>(&n), 4);
-  size_t res = 4;
+  size_t res = 8;
 
-  // Read that many id / bit pairs
+  // Read that many entries. Each entry is an id, an arity, a header which
+  // holds the width and type of every element, and then the contiguous bytes
+  // for every element.
+  vector<char> buf;
   for (size_t i = 0; i < n; ++i) {
-    VId id; 
-    is.read(reinterpret_cast<char*>(&id), 4);
-    res += 4;
-
-    uint32_t arity = 0;
-    is.read(reinterpret_cast<char*>(&arity), 4);
-    res += 4;
+    uint32_t entry[3];
+    is.read(reinterpret_cast<char*>(entry), 12);
+    res += 12;
 
+    const auto arity = entry[1];
+    if (arity == 0) {
+      continue;
+    }
+    const auto width = entry[2] & 0x3fffffffu;
+    const auto type = static_cast<Bits::Type>(entry[2] >> 30);
+    const auto stride = (width+7) / 8;
+    buf.resize(arity*stride);
+    is.read(buf.data(), buf.size());
+    res += buf.size();
+
+    auto& bs = state_[entry[0]];
+    bs.resize(arity);
     for (size_t j = 0; j < arity; ++j) {
-      Bits bits;
-      res += bits.deserialize(is);
-      state_[id].push_back(bits);
+      bs[j].read_bytes(buf.data() + j*stride, width, type);
     }
   }
   return res;
 }
 
 size_t State::serialize(ostream& os) const {
-  // How many elements are in this state?
-  uint32_t n = state_.size();
-  os.write(reinterpret_cast<char*>(&n), 4);
+  // Format tag and number of elements
+  const uint32_t header[2] = {version_, static_cast<uint32_t>(state_.size())};
+  os.write(reinterpret_cast<const char*>(header), 8);
+  size_t res = 8;
+
+  // Write that many entries. See deserialize() for a description of the
+  // format. Every element in an array has the same width and type.
+  vector<char> buf;
+  for (const auto& s : state_) {
+    const auto arity = s.second.size();
+    const auto width = (arity > 0) ? s.second[0].size() : 0;
+    const auto type = (arity > 0) ? static_cast<uint32_t>(s.second[0].get_type()) : 0;
+    const uint32_t entry[3] = {s.first, static_cast<uint32_t>(arity), static_cast<uint32_t>(width | (type << 30))};
+    os.write(reinterpret_cast<const char*>(entry), 12);
+    res += 12;
+
+    const auto stride = (width+7) / 8;
+    buf.resize(arity*stride);
+    for (size_t j = 0; j < arity; ++j) {
+      s.second[j].write_bytes(buf.data() + j*stride);
+    }
+    os.write(buf.data(), buf.size());
+    res += buf.size();
+  }
+  return res;
+}
+
+size_t State::serialize_legacy(ostream& os) const {
+  // Number of elements, followed by that many id / arity / bits tuples
+  const uint32_t n = state_.size();
+  os.write(reinterpret_cast<const char*>(&n), 4);
   size_t res = 4;
 
-  // Write that many id / bit pairs
   for (const auto& s : state_) {
-    os.write(const_cast<char*>(reinterpret_cast<const char*>(&s.first)), 4);
+    os.write(reinterpret_cast<const char*>(&s.first), 4);
     res += 4;
-    
-    uint32_t arity = s.second.size();
-    os.write(reinterpret_cast<char*>(&arity), 4);
-    res += 4; 
-           
+
+    const uint32_t arity = s.second.size();
+    os.write(reinterpret_cast<const char*>(&arity), 4);
+    res += 4;
+
     for (const auto& b : s.second) {
       res += b.serialize(os);
     }
@@ -121,5 +165,27 @@ size_t State::serialize(ostream& os) const {
   return res;
 }
 
+size_t State::deserialize_legacy(istream& is, uint32_t n) {
+  size_t res = 0;
+
+  // Read n id / bit pairs
+  for (size_t i = 0; i < n; ++i) {
+    VId id; 
+    is.read(reinterpret_cast<char*>(&id), 4);
+    res += 4;
+
+    uint32_t arity = 0;
+    is.read(reinterpret_cast<char*>(&arity), 4);
+    res += 4;
+
+    auto& bs = state_[id];
+    bs.resize(arity);
+    for (size_t j = 0; j < arity; ++j) {
+      res += bs[j].deserialize(is);
+    }
+  }
+  return res;
+}
+
 } // namespace cascade
 
@@ -61,9 +61,22 @@ class State : public Serializable {
     void write(std::ostream& os, size_t base) const;
     size_t deserialize(std::istream& is) override;
     size_t serialize(std::ostream& os) const override;
+    // Writes this state in the legacy format, for peers which haven't
+    // advertised the Rpc::TAGGED_STATE capability.
+    size_t serialize_legacy(std::ostream& os) const;
 
   private:
+    // Binary Format:
+    //
+    // Serialized states begin with this tag, which identifies the format
+    // version in its low order bits. Remote peers only exchange this format
+    // once both sides have advertised Rpc::TAGGED_STATE. Legacy states, which
+    // begin with an element count, are still accepted by deserialize().
+    static constexpr uint32_t version_ = 0xca5c0001;
+
     std::unordered_map<VId, Vector<Bits>> state_; 
+
+    size_t deserialize_legacy(std::istream& is, uint32_t n);
 };
 
 inline void State::insert(VId id, const Bits& b) {
@@ -305,6 +305,11 @@ void Evaluate::invalidate(const Expression* e) {
   const_cast<Node*>(root)->accept(&i);
 }
 
+void Evaluate::invalidate_subtree(const Node* n) {
+  InvalidateAll ia;
+  const_cast<Node*>(n)->accept(&ia);
+}
+
 void Evaluate::edit(BinaryExpression* be) {
   switch (be->get_op()) {
     case BinaryExpression::Op::PLUS:
@@ -670,6 +675,32 @@ void Evaluate::Invalidate::edit(RegDeclaration* rd) {
   rd->accept_val(this);
 }
 
+void Evaluate::InvalidateAll::edit(Identifier* id) {
+  Invalidate::edit(id);
+  Editor::edit(id);
+}
+
+void Evaluate::InvalidateAll::edit(MultipleConcatenation* mc) {
+  Invalidate::edit(mc);
+  mc->accept_expr(this);
+}
+
+void Evaluate::InvalidateAll::edit(LocalparamDeclaration* ld) {
+  Editor::edit(ld);
+}
+
+void Evaluate::InvalidateAll::edit(NetDeclaration* nd) {
+  Editor::edit(nd);
+}
+
+void Evaluate::InvalidateAll::edit(ParameterDeclaration* pd) {
+  Editor::edit(pd);
+}
+
+void Evaluate::InvalidateAll::edit(RegDeclaration* rd) {
+  Editor::edit(rd);
+}
+
 Evaluate::SelfDetermine::SelfDetermine(Evaluate* eval) {
   eval_ = eval;
 }
@@ -135,6 +135,10 @@ class Evaluate : public Editor {
     // Invalidates bits, size, and type for this expression and the
     // sub-expressions that it consists of.
     void invalidate(const Expression* e);
+    // Invalidates bits, size, and type for every expression in this subtree,
+    // including those in subscripts and declarations which invalidate() treats
+    // as belonging to different expression trees.
+    void invalidate_subtree(const Node* n);
 
   private:
     // Target-specific handlers:
@@ -183,6 +187,17 @@ class Evaluate : public Editor {
       void edit(ParameterDeclaration* pd) override;
       void edit(RegDeclaration* rd) override;
     };
+    // Invalidates bit, size, and type info for every expression in this
+    // subtree, without stopping at expression tree boundaries
+    struct InvalidateAll : Invalidate {
+      ~InvalidateAll() override = default;
+      void edit(Identifier* id) override;
+      void edit(MultipleConcatenation* mc) override;
+      void edit(LocalparamDeclaration* ld) override;
+      void edit(NetDeclaration* nd) override; 
+      void edit(ParameterDeclaration* pd) override;
+      void edit(RegDeclaration* rd) override;
+    };
     // Uses self-determination to allocate bits, sizes, and types.
     struct SelfDetermine : Editor {
       SelfDetermine(Evaluate* eval);
@@ -194,6 +194,7 @@
     auto res = PRIVATE(t)->accept(r); \
     if (res != PRIVATE(t)) { \
       replace_##t(res); \
+      Rewriter::count_replacement(); \
     } \
     return PRIVATE(t); \
   }
@@ -266,6 +267,7 @@
       auto res = PRIVATE(t)->accept(r); \
       if (res != PRIVATE(t)) { \
         replace_##t(res); \
+        Rewriter::count_replacement(); \
       } \
     } \
     return PRIVATE(t); \
@@ -475,6 +477,7 @@
         delete n; \
         n = res; \
         n->parent_ = this; \
+        Rewriter::count_replacement(); \
       } \
     } \
   }
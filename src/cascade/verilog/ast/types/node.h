@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_VERILOG_AST_NODE_H
 #define CASCADE_SRC_VERILOG_AST_NODE_H
 
+#include "common/slab.h"
 #include "verilog/ast/types/macro.h"
 #include "verilog/ast/visitors/builder.h"
 #include "verilog/ast/visitors/editor.h"
@@ -138,6 +139,14 @@ class Node {
     Node(Tag tag);
     virtual ~Node() = default;
 
+    // Memory Management:
+    //
+    // Nodes are allocated and freed in very large numbers (particularly by
+    // transformations like loop unrolling). They're recycled through a slab
+    // allocator rather than returned to the system allocator.
+    static void* operator new(size_t n);
+    static void operator delete(void* p, size_t n);
+
     // Node Interface:
     virtual Node* clone() const = 0;
     virtual void accept(Visitor* v) const = 0;
@@ -189,6 +198,14 @@ inline Node::Node(Tag tag) {
   tag_ = tag;
 }
 
+inline void* Node::operator new(size_t n) {
+  return Slab<>::allocate(n);
+}
+
+inline void Node::operator delete(void* p, size_t n) {
+  Slab<>::deallocate(p, n);
+}
+
 inline Node* Node::get_parent() {
   return parent_;
 }
@@ -34,6 +34,12 @@
 
 namespace cascade {
 
+namespace {
+
+thread_local size_t replacements_ = 0;
+
+} // namespace
+
 ArgAssign* Rewriter::rewrite(ArgAssign* aa) {
   aa->accept_exp(this);
   aa->accept_imp(this);
@@ -387,4 +393,12 @@ VariableAssign* Rewriter::rewrite(VariableAssign* va) {
   return va;
 }
 
+size_t Rewriter::replacements() {
+  return replacements_;
+}
+
+void Rewriter::count_replacement() {
+  ++replacements_;
+}
+
 } // namespace cascade
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_VERILOG_AST_VISITORS_REWRITER_H
 #define CASCADE_SRC_VERILOG_AST_VISITORS_REWRITER_H
 
+#include <stddef.h>
 #include "verilog/ast/ast_fwd.h"
 
 namespace cascade {
@@ -102,6 +103,13 @@ struct Rewriter {
   virtual Statement* rewrite(WhileStatement* ws);
   virtual TimingControl* rewrite(EventControl* ec);
   virtual VariableAssign* rewrite(VariableAssign* va);
+
+  // Returns the number of nodes which have been replaced by rewriters on this
+  // thread.
+  static size_t replacements();
+  // Records the replacement of a node. This method is invoked by the AST and
+  // shouldn't be called directly.
+  static void count_replacement();
 };
 
 } // namespace cascade
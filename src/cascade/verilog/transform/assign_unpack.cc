@@ -39,20 +39,40 @@ AssignUnpack::AssignUnpack() : Rewriter() {
 }
 
 void AssignUnpack::run(ModuleDeclaration* md) {
+  begin(md);
   md->accept(this);
-  if (next_id_ == 0) {
-    return;
-  }
+  end(md);
+}
+
+void AssignUnpack::begin(ModuleDeclaration* md) {
+  (void) md;
+  decls_.clear();
+  cas_.clear();
+  next_id_ = 0;
+}
 
+void AssignUnpack::end(ModuleDeclaration* md) {
   for (auto i = decls_.begin(), ie = decls_.end(); i != ie; ++i) {
     md->push_front_items(*i);
   }
   for (auto i = cas_.begin(), ie = cas_.end(); i != ie; ++i) {
     md->push_back_items(*i);
   }
-  Resolve().invalidate(md);
-  Navigate(md).invalidate();
-  ModuleInfo(md).invalidate();
+  decls_.clear();
+  cas_.clear();
+}
+
+Node* AssignUnpack::rewrite_local(Node* n) {
+  switch (n->get_tag()) {
+    case Node::Tag::continuous_assign:
+      return rewrite(static_cast<ContinuousAssign*>(n));
+    case Node::Tag::blocking_assign:
+      return rewrite(static_cast<BlockingAssign*>(n));
+    case Node::Tag::nonblocking_assign:
+      return rewrite(static_cast<NonblockingAssign*>(n));
+    default:
+      return n;
+  }
 }
 
 ModuleItem* AssignUnpack::rewrite(ContinuousAssign* ca) {
@@ -34,24 +34,28 @@
 #include <cassert>
 #include <vector>
 #include "verilog/analyze/evaluate.h"
-#include "verilog/analyze/module_info.h"
-#include "verilog/analyze/navigate.h"
 #include "verilog/analyze/resolve.h"
 #include "verilog/ast/ast.h"
 #include "verilog/ast/visitors/rewriter.h"
 #include "verilog/ast/visitors/visitor.h"
 #include "verilog/build/ast_builder.h"
 #include "verilog/print/print.h"
+#include "verilog/transform/pass_manager.h"
 
 namespace cascade {
 
-class AssignUnpack : public Rewriter {
+class AssignUnpack : public Rewriter, public PassManager::LocalPass {
   public:
     AssignUnpack();
     ~AssignUnpack() override = default;
 
     void run(ModuleDeclaration* md);
 
+    // PassManager::LocalPass Interface:
+    void begin(ModuleDeclaration* md) override;
+    void end(ModuleDeclaration* md) override;
+    Node* rewrite_local(Node* n) override;
+
   private:
     ModuleItem* rewrite(ContinuousAssign* ca) override;
     Statement* rewrite(BlockingAssign* ba) override;
@@ -32,7 +32,6 @@
 
 #include "verilog/analyze/constant.h"
 #include "verilog/analyze/evaluate.h"
-#include "verilog/analyze/module_info.h"
 #include "verilog/analyze/resolve.h"
 #include "verilog/ast/ast.h"
 
@@ -86,11 +85,6 @@ void ConstantProp::run(ModuleDeclaration* md) {
     } 
     ++i;
   }
-
-  // Invalidate cached state (we haven't added or deleted declarations, so
-  // there's no need to invalidate the scope tree).
-  Resolve().invalidate(md);
-  ModuleInfo(md).invalidate();
 }
 
 bool ConstantProp::is_assign_target(const Identifier* i) const {
@@ -34,9 +34,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
-#include "verilog/analyze/module_info.h"
-#include "verilog/analyze/navigate.h"
-#include "verilog/analyze/resolve.h"
+#include "verilog/analyze/evaluate.h"
 #include "verilog/ast/ast.h"
 #include "verilog/print/print.h"
 
@@ -46,19 +44,19 @@ namespace cascade {
 
 void ControlMerge::run(ModuleDeclaration* md) {
   // Index initial and always blocks
-  vector<const Statement*> initial_index;
-  unordered_map<string, vector<const TimingControlStatement*>> always_index;
+  vector<InitialConstruct*> initial_index;
+  unordered_map<string, vector<TimingControlStatement*>> always_index;
   for (auto i = md->begin_items(); i != md->end_items(); ++i) {
     switch ((*i)->get_tag()) {
       case Node::Tag::initial_construct: {
-        const auto* ic = static_cast<const InitialConstruct*>(*i);
-        initial_index.push_back(ic->get_stmt());
+        auto* ic = static_cast<InitialConstruct*>(*i);
+        initial_index.push_back(ic);
         break;
       }
       case Node::Tag::always_construct: {
-        const auto* ac = static_cast<const AlwaysConstruct*>(*i);
+        auto* ac = static_cast<AlwaysConstruct*>(*i);
         assert(ac->get_stmt()->is_subclass_of(Node::Tag::timing_control_statement));
-        const auto* tcs = static_cast<const TimingControlStatement*>(ac->get_stmt());
+        auto* tcs = static_cast<TimingControlStatement*>(ac->get_stmt());
         stringstream ss;
         ss << tcs->get_ctrl();
         always_index[ss.str()].push_back(tcs);
@@ -69,10 +67,16 @@ void ControlMerge::run(ModuleDeclaration* md) {
     }
   }
 
-  // Create canonical initial block
+  // Create canonical initial block. Rather than cloning the bodies of the
+  // original control statements, we move them into place and leave empty
+  // blocks behind. The originals are deleted below. Evaluate's decorations
+  // don't survive being moved to a new parent, so we invalidate them here.
   auto* sb = new SeqBlock();
-  for (auto* s : initial_index) {
-    sb->push_back_stmts(s->clone());
+  for (auto* ic : initial_index) {
+    auto* s = ic->get_stmt();
+    ic->set_stmt(new SeqBlock());
+    Evaluate().invalidate_subtree(s);
+    sb->push_back_stmts(s);
   }
   auto* initial = new InitialConstruct(new Attributes(), sb); 
 
@@ -81,7 +85,10 @@ void ControlMerge::run(ModuleDeclaration* md) {
   for (const auto& a : always_index) {
     auto* sb = new SeqBlock();
     for (auto* tcs : a.second) {
-      sb->push_back_stmts(tcs->get_stmt()->clone());
+      auto* s = tcs->get_stmt();
+      tcs->set_stmt(new SeqBlock());
+      Evaluate().invalidate_subtree(s);
+      sb->push_back_stmts(s);
     }
     auto* tcs = new TimingControlStatement(a.second[0]->get_ctrl()->clone(), sb);
     always.push_back(new AlwaysConstruct(tcs));
@@ -105,10 +112,6 @@ void ControlMerge::run(ModuleDeclaration* md) {
   for (auto* a : always) {
     md->push_back_items(a); 
   }
-
-  Resolve().invalidate(md);
-  Navigate(md).invalidate();
-  ModuleInfo(md).invalidate();
 }
 
 } // namespace cascade
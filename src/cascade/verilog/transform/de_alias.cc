@@ -33,7 +33,6 @@
 #include <cassert>
 #include "verilog/analyze/constant.h"
 #include "verilog/analyze/evaluate.h"
-#include "verilog/analyze/module_info.h"
 #include "verilog/analyze/resolve.h"
 #include "verilog/ast/ast.h"
 
@@ -46,8 +45,11 @@ DeAlias::DeAlias() : Rewriter() { }
 void DeAlias::run(ModuleDeclaration* md) {
   // Build the alias table 
   table_ = new AliasTable(md);
-  // Replace aliases and delete zero-time self-assignments 
-  md->accept(this);
+  // Replace aliases and delete zero-time self-assignments. There's no need to
+  // walk the module if there aren't any aliases.
+  if (!table_->empty()) {
+    md->accept(this);
+  }
   for (auto i = md->begin_items(); i != md->end_items(); ) {
     if ((*i)->is(Node::Tag::continuous_assign)) {
       auto* ca = static_cast<ContinuousAssign*>(*i);
@@ -60,11 +62,6 @@ void DeAlias::run(ModuleDeclaration* md) {
   }
   // Delete the table
   delete table_;
-
-  // Invalidate cached state (we haven't added or removed any declarations so
-  // there's no need to invalidate the scope tree).
-  Resolve().invalidate(md);
-  ModuleInfo(md).invalidate();
 }
 
 DeAlias::AliasTable::AliasTable(const ModuleDeclaration* md) : Visitor() { 
@@ -96,6 +93,10 @@ DeAlias::AliasTable::~AliasTable() {
   }
 }
 
+bool DeAlias::AliasTable::empty() const {
+  return aliases_.empty();
+}
+
 Identifier* DeAlias::AliasTable::dealias(const Identifier* id) {
   // Nothing to do if we can't find this identifier in the alias table
   const auto* r = Resolve().get_resolution(id);
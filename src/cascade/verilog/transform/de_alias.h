@@ -51,6 +51,8 @@ class DeAlias : public Rewriter {
         explicit AliasTable(const ModuleDeclaration* md);
         ~AliasTable() override;
 
+        // Returns true if there are no aliases in this table.
+        bool empty() const;
         // Dealiases a variable or returns nullptr on failure. It is the
         // responsibility of the caller to deallocate any resulting memory.
         Identifier* dealias(const Identifier* id);
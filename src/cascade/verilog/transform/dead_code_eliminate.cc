@@ -31,7 +31,6 @@
 #include "verilog/transform/dead_code_eliminate.h"
 
 #include "verilog/ast/ast.h"
-#include "verilog/analyze/module_info.h"
 #include "verilog/analyze/navigate.h"
 #include "verilog/analyze/resolve.h"
 
@@ -43,7 +42,6 @@ void DeadCodeEliminate::run(ModuleDeclaration* md) {
   Index idx(this);
   md->accept(&idx);
   md->accept(this);
-  ModuleInfo(md).invalidate();
 }
 
 DeadCodeEliminate::Index::Index(DeadCodeEliminate* dce) {
@@ -45,9 +45,6 @@ void IndexNormalize::run(ModuleDeclaration* md) {
   md->accept(&fu);
   FixDecls fd;
   md->accept(&fd);
-
-  // We may have deleted some static constant variables inside declarations.
-  Resolve().invalidate(md);
 }
 
 IndexNormalize::FixDecls::FixDecls() : Editor() { }
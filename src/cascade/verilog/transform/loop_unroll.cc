@@ -31,7 +31,6 @@
 #include "verilog/transform/loop_unroll.h"
 
 #include "verilog/analyze/evaluate.h"
-#include "verilog/analyze/module_info.h"
 #include "verilog/analyze/navigate.h"
 #include "verilog/analyze/resolve.h"
 
@@ -39,18 +38,43 @@ using namespace std;
 
 namespace cascade {
 
-LoopUnroll::LoopUnroll() : Rewriter() { }
+LoopUnroll::LoopUnroll() : Rewriter() { 
+  set_max_unroll(0);
+}
+
+LoopUnroll& LoopUnroll::set_max_unroll(size_t n) {
+  max_unroll_ = n;
+  return *this;
+}
 
 void LoopUnroll::run(ModuleDeclaration* md) {
   md_ = md;
   md->accept_items(this);
-  ModuleInfo(md).invalidate();
 
   Reset r;
   md->accept_items(&r);
 }
 
-LoopUnroll::Unroll::Unroll() : Builder() { }
+bool LoopUnroll::uses_loops(const ModuleDeclaration* md) {
+  return LoopCheck().run(md);
+}
+
+LoopUnroll::Unroll::Unroll(size_t max_unroll) : Builder() { 
+  max_unroll_ = max_unroll;
+  itrs_ = 0;
+  aborted_ = false;
+}
+
+bool LoopUnroll::Unroll::next_itr() {
+  if (aborted_) {
+    return false;
+  }
+  if ((max_unroll_ > 0) && (++itrs_ > max_unroll_)) {
+    aborted_ = true;
+    return false;
+  }
+  return true;
+}
 
 Statement* LoopUnroll::Unroll::build(const BlockingAssign* ba) {
   const auto& val = Evaluate().get_value(ba->get_rhs());
@@ -66,7 +90,7 @@ Statement* LoopUnroll::Unroll::build(const ForStatement* fs) {
   Evaluate().assign_value(fs->get_init()->get_lhs(), ival);
   sb->push_back_stmts(new BlockingAssign(fs->get_init()->get_lhs()->clone(), fs->get_init()->get_rhs()->clone()));
 
-  while (Evaluate().get_value(fs->get_cond()).to_bool()) {
+  while (Evaluate().get_value(fs->get_cond()).to_bool() && next_itr()) {
     auto* s = fs->get_stmt()->accept(this);
     sb->push_back_stmts(s);
 
@@ -81,7 +105,7 @@ Statement* LoopUnroll::Unroll::build(const ForStatement* fs) {
 Statement* LoopUnroll::Unroll::build(const RepeatStatement* rs) {
   const auto n = Evaluate().get_value(rs->get_cond()).to_uint();
   auto* sb = new SeqBlock();
-  for (size_t i = 0; i < n; ++i) {
+  for (size_t i = 0; (i < n) && next_itr(); ++i) {
     auto* s = rs->get_stmt()->accept(this);
     sb->push_back_stmts(s);
   }
@@ -90,7 +114,7 @@ Statement* LoopUnroll::Unroll::build(const RepeatStatement* rs) {
 
 Statement* LoopUnroll::Unroll::build(const WhileStatement* ws) {
   auto* sb = new SeqBlock();
-  while (Evaluate().get_value(ws->get_cond()).to_bool()) {
+  while (Evaluate().get_value(ws->get_cond()).to_bool() && next_itr()) {
     auto* s = ws->get_stmt()->accept(this);
     sb->push_back_stmts(s);
   }
@@ -106,23 +130,55 @@ void LoopUnroll::Reset::visit(const RegDeclaration* rd) {
   }
 }
 
+LoopUnroll::LoopCheck::LoopCheck() : Visitor() { }
+
+bool LoopUnroll::LoopCheck::run(const Node* n) {
+  res_ = false;
+  n->accept(this);
+  return res_;
+}
+
+void LoopUnroll::LoopCheck::visit(const ForStatement* fs) {
+  res_ = true;
+}
+
+void LoopUnroll::LoopCheck::visit(const RepeatStatement* rs) {
+  res_ = true;
+}
+
+void LoopUnroll::LoopCheck::visit(const WhileStatement* ws) {
+  res_ = true;
+}
+
 Statement* LoopUnroll::rewrite(ForStatement* fs) {
-  Unroll u;
+  Unroll u(max_unroll_);
   auto* res = fs->accept(&u);
+  if (u.aborted_) {
+    delete res;
+    return fs;
+  }
   Resolve().invalidate(md_);
   return res;
 }
 
 Statement* LoopUnroll::rewrite(RepeatStatement* rs) {
-  Unroll u;
+  Unroll u(max_unroll_);
   auto* res = rs->accept(&u);
+  if (u.aborted_) {
+    delete res;
+    return rs;
+  }
   Resolve().invalidate(md_);
   return res;
 }
 
 Statement* LoopUnroll::rewrite(WhileStatement* ws) {
-  Unroll u;
+  Unroll u(max_unroll_);
   auto* res = ws->accept(&u);
+  if (u.aborted_) {
+    delete res;
+    return ws;
+  }
   Resolve().invalidate(md_);
   return res;
 }
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_VERILOG_TRANSFORM_LOOP_UNROLL_H
 #define CASCADE_SRC_VERILOG_TRANSFORM_LOOP_UNROLL_H
 
+#include <stddef.h>
 #include "verilog/ast/visitors/builder.h"
 #include "verilog/ast/visitors/rewriter.h"
 #include "verilog/ast/visitors/visitor.h"
@@ -42,13 +43,29 @@ class LoopUnroll : public Rewriter {
     LoopUnroll();
     ~LoopUnroll() override = default;
 
+    // Configuration Interface:
+    //
+    // Sets the maximum number of iterations which will be unrolled for any
+    // loop statement (including the iterations of any loops nested inside of
+    // it). Loops which exceed this limit are left in place. Setting n to zero
+    // places no limit on unrolling. This is the default behavior.
+    LoopUnroll& set_max_unroll(size_t n);
+
     void run(ModuleDeclaration* md);
+    // Returns true if this module contains any loop statements.
+    bool uses_loops(const ModuleDeclaration* md);
 
   private:
     struct Unroll : public Builder {
-      Unroll();
+      explicit Unroll(size_t max_unroll);
       ~Unroll() override = default;
 
+      size_t max_unroll_;
+      size_t itrs_;
+      bool aborted_;
+
+      bool next_itr();
+
       Statement* build(const BlockingAssign* ba) override;
       Statement* build(const ForStatement* fs) override;
       Statement* build(const RepeatStatement* rs) override;
@@ -61,11 +78,22 @@ class LoopUnroll : public Rewriter {
       void visit(const RegDeclaration* rd) override;
     };
 
+    struct LoopCheck : public Visitor {
+      LoopCheck();
+      ~LoopCheck() override = default;
+      bool run(const Node* n);
+      void visit(const ForStatement* fs) override;
+      void visit(const RepeatStatement* rs) override;
+      void visit(const WhileStatement* ws) override;
+      bool res_;
+    };
+
     Statement* rewrite(ForStatement* fs) override;
     Statement* rewrite(RepeatStatement* rs) override;
     Statement* rewrite(WhileStatement* ws) override;
 
     ModuleDeclaration* md_;
+    size_t max_unroll_;
 };
 
 } // namespace cascade
@@ -0,0 +1,381 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/pass_manager.h"
+
+#include <cassert>
+#include <chrono>
+#include "common/slab.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/navigate.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+#include "verilog/ast/visitors/rewriter.h"
+#include "verilog/ast/visitors/visitor.h"
+
+using namespace std;
+
+namespace cascade {
+
+// Every rewrite descends into a node's children before presenting the node
+// itself to each of the fused transforms in turn.
+#define FUSE(R, T) \
+  R* rewrite(T* n) override { \
+    return static_cast<R*>(apply(Rewriter::rewrite(n))); \
+  }
+
+class PassManager::Fuse : public Rewriter {
+  public:
+    explicit Fuse(const vector<LocalPass*>& passes) : Rewriter(), passes_(passes) { }
+    ~Fuse() override = default;
+
+    void run(ModuleDeclaration* md) {
+      for (auto* p : passes_) {
+        p->begin(md);
+      }
+      md->accept_items(this);
+      for (auto* p : passes_) {
+        p->end(md);
+      }
+    }
+
+  private:
+    const vector<LocalPass*>& passes_;
+
+    Node* apply(Node* n) {
+      // Replacements which are themselves replaced by a later transform were
+      // never attached to the AST, so we're responsible for deleting them.
+      auto* orig = n;
+      for (auto* p : passes_) {
+        auto* res = p->rewrite_local(n);
+        if ((res != n) && (n != orig)) {
+          delete n;
+        }
+        n = res;
+      }
+      return n;
+    }
+
+    FUSE(ArgAssign, ArgAssign)
+    FUSE(Attributes, Attributes)
+    FUSE(AttrSpec, AttrSpec)
+    FUSE(CaseGenerateItem, CaseGenerateItem)
+    FUSE(CaseItem, CaseItem)
+    FUSE(Event, Event)
+    FUSE(Expression, BinaryExpression)
+    FUSE(Expression, ConditionalExpression)
+    FUSE(Expression, FeofExpression)
+    FUSE(Expression, FopenExpression)
+    FUSE(Expression, TargetExpression)
+    FUSE(Expression, Concatenation)
+    FUSE(Expression, Identifier)
+    FUSE(Expression, MultipleConcatenation)
+    FUSE(Expression, Number)
+    FUSE(Expression, String)
+    FUSE(Expression, RangeExpression)
+    FUSE(Expression, UnaryExpression)
+    FUSE(GenerateBlock, GenerateBlock)
+    FUSE(Id, Id)
+    FUSE(IfGenerateClause, IfGenerateClause)
+    FUSE(ModuleItem, AlwaysConstruct)
+    FUSE(ModuleItem, IfGenerateConstruct)
+    FUSE(ModuleItem, CaseGenerateConstruct)
+    FUSE(ModuleItem, LoopGenerateConstruct)
+    FUSE(ModuleItem, InitialConstruct)
+    FUSE(ModuleItem, ContinuousAssign)
+    FUSE(ModuleItem, GenvarDeclaration)
+    FUSE(ModuleItem, LocalparamDeclaration)
+    FUSE(ModuleItem, NetDeclaration)
+    FUSE(ModuleItem, ParameterDeclaration)
+    FUSE(ModuleItem, RegDeclaration)
+    FUSE(ModuleItem, GenerateRegion)
+    FUSE(ModuleItem, ModuleInstantiation)
+    FUSE(ModuleItem, PortDeclaration)
+    FUSE(Statement, BlockingAssign)
+    FUSE(Statement, NonblockingAssign)
+    FUSE(Statement, CaseStatement)
+    FUSE(Statement, ConditionalStatement)
+    FUSE(Statement, ForStatement)
+    FUSE(Statement, RepeatStatement)
+    FUSE(Statement, ParBlock)
+    FUSE(Statement, SeqBlock)
+    FUSE(Statement, TimingControlStatement)
+    FUSE(Statement, DebugStatement)
+    FUSE(Statement, FflushStatement)
+    FUSE(Statement, FinishStatement)
+    FUSE(Statement, FseekStatement)
+    FUSE(Statement, GetStatement)
+    FUSE(Statement, PutStatement)
+    FUSE(Statement, RestartStatement)
+    FUSE(Statement, RetargetStatement)
+    FUSE(Statement, SaveStatement)
+    FUSE(Statement, YieldStatement)
+    FUSE(Statement, WhileStatement)
+    FUSE(TimingControl, EventControl)
+    FUSE(VariableAssign, VariableAssign)
+};
+
+#undef FUSE
+
+#define COUNT(T) \
+  void visit(const T* n) override { \
+    ++count_; \
+    Visitor::visit(n); \
+  }
+
+class PassManager::Count : public Visitor {
+  public:
+    Count() : Visitor() { }
+    ~Count() override = default;
+
+    size_t run(const ModuleDeclaration* md) {
+      count_ = 0;
+      md->accept(this);
+      return count_;
+    }
+
+  private:
+    size_t count_;
+
+    COUNT(ArgAssign)
+    COUNT(Attributes)
+    COUNT(AttrSpec)
+    COUNT(CaseGenerateItem)
+    COUNT(CaseItem)
+    COUNT(Event)
+    COUNT(BinaryExpression)
+    COUNT(ConditionalExpression)
+    COUNT(FeofExpression)
+    COUNT(FopenExpression)
+    COUNT(TargetExpression)
+    COUNT(Concatenation)
+    COUNT(Identifier)
+    COUNT(MultipleConcatenation)
+    COUNT(Number)
+    COUNT(String)
+    COUNT(RangeExpression)
+    COUNT(UnaryExpression)
+    COUNT(GenerateBlock)
+    COUNT(Id)
+    COUNT(IfGenerateClause)
+    COUNT(ModuleDeclaration)
+    COUNT(AlwaysConstruct)
+    COUNT(IfGenerateConstruct)
+    COUNT(CaseGenerateConstruct)
+    COUNT(LoopGenerateConstruct)
+    COUNT(InitialConstruct)
+    COUNT(ContinuousAssign)
+    COUNT(GenvarDeclaration)
+    COUNT(LocalparamDeclaration)
+    COUNT(NetDeclaration)
+    COUNT(ParameterDeclaration)
+    COUNT(RegDeclaration)
+    COUNT(GenerateRegion)
+    COUNT(ModuleInstantiation)
+    COUNT(PortDeclaration)
+    COUNT(BlockingAssign)
+    COUNT(NonblockingAssign)
+    COUNT(CaseStatement)
+    COUNT(ConditionalStatement)
+    COUNT(ForStatement)
+    COUNT(RepeatStatement)
+    COUNT(ParBlock)
+    COUNT(SeqBlock)
+    COUNT(TimingControlStatement)
+    COUNT(DebugStatement)
+    COUNT(FflushStatement)
+    COUNT(FinishStatement)
+    COUNT(FseekStatement)
+    COUNT(GetStatement)
+    COUNT(PutStatement)
+    COUNT(RestartStatement)
+    COUNT(RetargetStatement)
+    COUNT(SaveStatement)
+    COUNT(YieldStatement)
+    COUNT(WhileStatement)
+    COUNT(EventControl)
+    COUNT(VariableAssign)
+};
+
+#undef COUNT
+
+void PassManager::LocalPass::begin(ModuleDeclaration* md) {
+  // Does nothing.
+  (void) md;
+}
+
+void PassManager::LocalPass::end(ModuleDeclaration* md) {
+  // Does nothing.
+  (void) md;
+}
+
+PassManager::PassManager() {
+  profile_ = false;
+}
+
+PassManager::~PassManager() {
+  for (auto& e : entries_) {
+    delete e.local;
+  }
+}
+
+PassManager& PassManager::set_profile(bool profile) {
+  profile_ = profile;
+  return *this;
+}
+
+PassManager& PassManager::add(const char* name, function<void(ModuleDeclaration*)> pass, uint8_t preserves) {
+  entries_.push_back({name, pass, nullptr, NONE, preserves});
+  return *this;
+}
+
+PassManager& PassManager::add_local(const char* name, LocalPass* pass, uint8_t needs, uint8_t preserves) {
+  entries_.push_back({name, nullptr, pass, needs, preserves});
+  return *this;
+}
+
+PassManager& PassManager::begin_fixed_point(size_t max_itrs) {
+  groups_.push_back({entries_.size(), entries_.size(), max_itrs});
+  return *this;
+}
+
+PassManager& PassManager::end_fixed_point() {
+  assert(!groups_.empty());
+  groups_.back().end = entries_.size();
+  return *this;
+}
+
+void PassManager::run(ModuleDeclaration* md) {
+  stats_.clear();
+  auto g = groups_.begin();
+  for (size_t i = 0, ie = entries_.size(); i < ie; ) {
+    if ((g != groups_.end()) && (g->begin == i)) {
+      run_fixed_point(md, *g);
+      i = g->end;
+      ++g;
+      continue;
+    }
+    const auto next = step_end(i, (g != groups_.end()) ? g->begin : ie);
+    run_step(md, i, next);
+    i = next;
+  }
+}
+
+const vector<PassManager::Stats>& PassManager::get_stats() const {
+  return stats_;
+}
+
+size_t PassManager::step_end(size_t idx, size_t end) const {
+  // Extend this step with as many local transforms as we can. Each one has to
+  // be able to rely on everything that it needs in spite of the transforms
+  // which precede it.
+  auto next = idx + 1;
+  if (entries_[idx].local == nullptr) {
+    return next;
+  }
+  auto preserves = entries_[idx].preserves;
+  for (; (next < end) && (entries_[next].local != nullptr); ++next) {
+    if ((entries_[next].needs & preserves) != entries_[next].needs) {
+      break;
+    }
+    preserves &= entries_[next].preserves;
+  }
+  return next;
+}
+
+bool PassManager::run_step(ModuleDeclaration* md, size_t idx, size_t next) {
+  Stats s;
+  s.name = entries_[idx].name;
+  auto preserves = entries_[idx].preserves;
+  vector<LocalPass*> fused;
+  for (auto i = idx; i < next; ++i) {
+    if (i > idx) {
+      s.name += "+" + entries_[i].name;
+      preserves &= entries_[i].preserves;
+    }
+    if (entries_[i].local != nullptr) {
+      fused.push_back(entries_[i].local);
+    }
+  }
+
+  s.visited = profile_ ? Count().run(md) : 0;
+  const auto begin = chrono::steady_clock::now();
+  const auto rewrites = Rewriter::replacements();
+  const auto allocs = Slab<>::allocations();
+  const auto deallocs = Slab<>::deallocations();
+  if (fused.empty()) {
+    entries_[idx].pass(md);
+  } else {
+    Fuse(fused).run(md);
+  }
+  s.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+  s.rewritten = Rewriter::replacements() - rewrites;
+  s.created = Slab<>::allocations() - allocs;
+  s.deleted = Slab<>::deallocations() - deallocs;
+  stats_.push_back(s);
+
+  const auto changed = (s.created > 0) || (s.deleted > 0);
+  if (changed) {
+    invalidate(md, preserves);
+  }
+  return changed;
+}
+
+void PassManager::run_fixed_point(ModuleDeclaration* md, const Group& g) {
+  size_t steps = 0;
+  for (auto i = g.begin; i < g.end; i = step_end(i, g.end)) {
+    ++steps;
+  }
+  // Count the steps which have run without changing the module since the
+  // last one which did. Once that count covers every step in the group,
+  // running any of them again won't make a difference.
+  size_t clean = 0;
+  for (size_t itr = 0; (itr < g.max_itrs) && (clean < steps); ++itr) {
+    for (auto i = g.begin; (i < g.end) && (clean < steps); ) {
+      const auto next = step_end(i, g.end);
+      clean = run_step(md, i, next) ? 0 : (clean + 1);
+      i = next;
+    }
+  }
+}
+
+void PassManager::invalidate(ModuleDeclaration* md, uint8_t preserves) const {
+  if ((preserves & NAVIGATE) == 0) {
+    Navigate(md).invalidate();
+  }
+  if ((preserves & RESOLVE) == 0) {
+    Resolve().invalidate(md);
+  }
+  if ((preserves & MODULE_INFO) == 0) {
+    ModuleInfo(md).invalidate();
+  }
+}
+
+} // namespace cascade
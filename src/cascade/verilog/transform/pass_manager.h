@@ -0,0 +1,162 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_PASS_MANAGER_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_PASS_MANAGER_H
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "verilog/ast/ast_fwd.h"
+
+namespace cascade {
+
+// Runs a sequence of transforms over a module declaration.
+//
+// Every transform declares which of the analyses that decorate the AST (see
+// verilog/analyze/) it leaves intact. Transforms are only responsible for
+// keeping those decorations consistent while they run. Once a transform has
+// finished, this class invalidates every analysis which that transform
+// doesn't preserve, but only if it actually changed the module. Changes are
+// detected by counting the AST nodes which a transform creates and deletes,
+// so transforms must not restructure a module by moving nodes alone.
+//
+// Local transforms (see LocalPass below) which appear consecutively are fused
+// into a single traversal of the module, as long as none of them requires an
+// analysis which an earlier transform in the group fails to preserve.
+//
+// Transforms which are added between calls to begin_fixed_point() and
+// end_fixed_point() are run repeatedly, in order, until every one of them has
+// run once without changing the module since the last one which did.
+
+class PassManager {
+  public:
+    // Analyses which are attached to the AST as decorations
+    enum Analysis : uint8_t {
+      NONE        = 0x0,
+      NAVIGATE    = 0x1,
+      RESOLVE     = 0x2,
+      MODULE_INFO = 0x4,
+      ALL         = 0x7
+    };
+
+    // A transform which only ever replaces a node on the basis of that node
+    // and the nodes below it. Nodes are presented bottom-up, so a node's
+    // children have already been rewritten by every transform it's fused
+    // with. Replacements are only presented to the transforms which follow
+    // this one, and must be of the same kind as the node they replace.
+    class LocalPass {
+      public:
+        virtual ~LocalPass() = default;
+
+        // Called once before and after the module's items are traversed.
+        virtual void begin(ModuleDeclaration* md);
+        virtual void end(ModuleDeclaration* md);
+        // Returns a replacement for n, or n if it should be left in place.
+        // Replaced nodes are deleted by the caller.
+        virtual Node* rewrite_local(Node* n) = 0;
+    };
+
+    // Statistics for a single step of the pipeline. Fused transforms share a
+    // single entry, and transforms which are run to a fixed point produce an
+    // entry for every iteration. Visited holds the number of nodes in the
+    // module when the step began, which is the number of nodes a single
+    // traversal visits. It's only computed when profiling is enabled.
+    // Rewritten holds the number of nodes which a rewriter replaced.
+    struct Stats {
+      std::string name;
+      double ms;
+      size_t visited;
+      size_t rewritten;
+      size_t created;
+      size_t deleted;
+    };
+
+    PassManager();
+    ~PassManager();
+
+    // Enables statistics which require an extra traversal of the module.
+    PassManager& set_profile(bool profile);
+
+    // Appends a transform which traverses the module on its own.
+    PassManager& add(const char* name, std::function<void(ModuleDeclaration*)> pass, uint8_t preserves);
+    // Appends a local transform. This class takes ownership of pass.
+    PassManager& add_local(const char* name, LocalPass* pass, uint8_t needs, uint8_t preserves);
+    // Transforms added between these calls are run to a fixed point, or until
+    // they've been run max_itrs times, whichever comes first.
+    PassManager& begin_fixed_point(size_t max_itrs);
+    PassManager& end_fixed_point();
+
+    // Runs every transform, in order, over this module.
+    void run(ModuleDeclaration* md);
+    // Returns statistics for the most recent call to run().
+    const std::vector<Stats>& get_stats() const;
+
+  private:
+    struct Entry {
+      std::string name;
+      std::function<void(ModuleDeclaration*)> pass;
+      LocalPass* local;
+      uint8_t needs;
+      uint8_t preserves;
+    };
+    struct Group {
+      size_t begin;
+      size_t end;
+      size_t max_itrs;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<Group> groups_;
+    std::vector<Stats> stats_;
+    bool profile_;
+
+    // Returns the index of the entry which follows the step that begins at
+    // entries_[idx]. Steps never extend past entries_[end].
+    size_t step_end(size_t idx, size_t end) const;
+    // Runs entries_[idx] through entries_[next-1] as a single step. Returns
+    // true if doing so changed the module.
+    bool run_step(ModuleDeclaration* md, size_t idx, size_t next);
+    // Runs the transforms in this group to a fixed point
+    void run_fixed_point(ModuleDeclaration* md, const Group& g);
+    // Invalidates every analysis not in preserves
+    void invalidate(ModuleDeclaration* md, uint8_t preserves) const;
+
+    // Traverses a module on behalf of a group of fused local transforms
+    class Fuse;
+    // Counts the nodes in a module
+    class Count;
+};
+
+} // namespace cascade
+
+#endif
@@ -39,15 +39,39 @@ namespace cascade {
 ReplaceIntrospectionExprs::ReplaceIntrospectionExprs() : Rewriter() { }
 
 void ReplaceIntrospectionExprs::run(ModuleDeclaration* md) {
+  begin(md);
+  md->accept_items(this);
+}
+
+bool ReplaceIntrospectionExprs::uses_introspection(const ModuleDeclaration* md) {
+  return IntrospectionCheck().run(md);
+}
+
+void ReplaceIntrospectionExprs::begin(ModuleDeclaration* md) {
   const auto* std = md->get_attrs()->get<String>("__target");
   assert(std != nullptr);
   target_ = std->get_readable_val();
-  md->accept_items(this);
+}
+
+Node* ReplaceIntrospectionExprs::rewrite_local(Node* n) {
+  return n->is(Node::Tag::target_expression) ? new String(target_) : n;
 }
 
 Expression* ReplaceIntrospectionExprs::rewrite(TargetExpression* te) {
   return new String(target_);
 }
 
+ReplaceIntrospectionExprs::IntrospectionCheck::IntrospectionCheck() : Visitor() { }
+
+bool ReplaceIntrospectionExprs::IntrospectionCheck::run(const Node* n) {
+  res_ = false;
+  n->accept(this);
+  return res_;
+}
+
+void ReplaceIntrospectionExprs::IntrospectionCheck::visit(const TargetExpression* te) {
+  res_ = true;
+}
+
 } // namespace cascade
 
@@ -33,20 +33,41 @@
 
 #include <string>
 #include "verilog/ast/visitors/rewriter.h"
+#include "verilog/ast/visitors/visitor.h"
+#include "verilog/transform/pass_manager.h"
 
 namespace cascade {
 
-class ReplaceIntrospectionExprs : public Rewriter {
+class ReplaceIntrospectionExprs : public Rewriter, public PassManager::LocalPass {
   public:
     ReplaceIntrospectionExprs();
     ~ReplaceIntrospectionExprs() override = default;
 
     void run(ModuleDeclaration* md);
+    // Returns true if this module contains any expressions which would be
+    // rewritten by run(). The result of running this pass on such modules
+    // depends on their __target annotation.
+    bool uses_introspection(const ModuleDeclaration* md);
+
+    // PassManager::LocalPass Interface:
+    void begin(ModuleDeclaration* md) override;
+    Node* rewrite_local(Node* n) override;
 
   private:
     Expression* rewrite(TargetExpression* te) override;
 
     std::string target_;
+
+    // Checks for introspection expressions below this node
+    class IntrospectionCheck : Visitor {
+      public:
+        IntrospectionCheck();
+        ~IntrospectionCheck() override = default;
+        bool run(const Node* n);
+      private:
+        void visit(const TargetExpression* te) override;
+        bool res_;
+    };
 };
 
 } // namespace cascade
@@ -34,6 +34,7 @@
 #include "target/core/avmm/de10/de10_compiler.h"
 #include "target/core/aos/amorphos/amorphos_compiler.h"
 #include "target/core/aos/f1/f1_compiler.h"
+#include "target/core/native/native_compiler.h"
 #include "target/core/avmm/ulx3s/ulx3s_compiler.h"
 #include "target/core/avmm/verilator/verilator_compiler.h"
 #include "target/core/sw/sw_compiler.h"
@@ -43,13 +44,14 @@ using namespace std;
 
 namespace cascade {
 
-CascadeSlave::CascadeSlave() {
+CascadeSlave::CascadeSlave() : led_(8, 0) {
   set_listeners("./cascade_sock", 8800);
 
   remote_compiler_.set("avalon32", new avmm::Avalon32Compiler());
   remote_compiler_.set("de10", new avmm::De10Compiler());
   remote_compiler_.set("amorphos", new aos::AmorphosCompiler());
   remote_compiler_.set("f1", new aos::F1Compiler());
+  remote_compiler_.set("native", new native::NativeCompiler());
   remote_compiler_.set("proxy", new proxy::ProxyCompiler());
   remote_compiler_.set("sw", new sw::SwCompiler());
   remote_compiler_.set("ulx3s32", new avmm::Ulx3s32Compiler());
@@ -59,6 +61,10 @@ CascadeSlave::CascadeSlave() {
   remote_compiler_.set("verilator64", new avmm::Verilator64Compiler());
   #endif
 
+  auto* sc = remote_compiler_.get("sw");
+  assert(sc != nullptr);
+  static_cast<sw::SwCompiler*>(sc)->set_led(&led_, &led_lock_);
+
   set_quartus_server("localhost", 9900);
   set_vivado_server("localhost", 9900, 0);
 }
@@ -90,6 +96,16 @@ CascadeSlave& CascadeSlave::set_vivado_server(const string& host, size_t port, s
   return *this;
 }
 
+CascadeSlave& CascadeSlave::set_num_workers(size_t n) {
+  remote_compiler_.set_num_workers(n);
+  return *this;
+}
+
+CascadeSlave& CascadeSlave::set_num_dispatchers(size_t n) {
+  remote_compiler_.set_num_dispatchers(n);
+  return *this;
+}
+
 CascadeSlave& CascadeSlave::run() {
   remote_compiler_.run();
   return *this;
@@ -110,4 +126,8 @@ CascadeSlave& CascadeSlave::stop_now() {
   return *this;
 }
 
+RemoteCompiler::Stats CascadeSlave::get_stats() {
+  return remote_compiler_.get_stats();
+}
+
 } // namespace cascade
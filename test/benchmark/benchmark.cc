@@ -28,11 +28,24 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <sstream>
 #include <string>
 #include "benchmark/benchmark.h"
 #include "cl/cl.h"
+#include "common/bits.h"
+#include "common/log.h"
+#include "common/system.h"
 #include "gtest/gtest.h"
+#include "include/cascade_slave.h"
+#include "runtime/isolate.h"
+#include "runtime/module.h"
+#include "target/state.h"
 #include "test/harness.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/ast/ast.h"
+#include "verilog/parse/parser.h"
+#include "verilog/program/program.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace cascade;
 using namespace cascade::cl;
@@ -79,3 +92,171 @@ static void BM_Nw(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_Nw)->Unit(benchmark::kMillisecond);
+
+// Parses path on top of the minimal march, inlines everything, and returns
+// the isolated source of the root module. This is the code which the runtime
+// hands to the transform pipeline when it compiles the inlined logic module.
+static ModuleDeclaration* isolate_root(const string& path) {
+  Log log;
+  Parser parser(&log);
+  parser.set_include_dirs(System::src_root());
+  Program program;
+
+  stringstream ss;
+  ss << "`include \"share/cascade/march/regression/minimal.v\"\n"
+     << "`include \"" << path << "\"" << endl;
+  for (auto eof = false; !eof; ) {
+    eof = parser.parse(ss);
+    for (auto i = parser.begin(), ie = parser.end(); !log.error() && (i != ie); ++i) {
+      if ((*i)->is(Node::Tag::module_declaration)) {
+        program.declare(static_cast<ModuleDeclaration*>(*i), &log, &parser);
+      } else {
+        program.eval(static_cast<ModuleItem*>(*i), &log, &parser);
+      }
+    }
+    if (log.error()) {
+      return nullptr;
+    }
+  }
+
+  program.inline_all();
+  return Isolate().isolate(program.root_elab()->second, 0);
+}
+
+// Times the transform pipeline alone. Parsing, elaboration, and isolation
+// happen once up front, and each iteration runs over a fresh copy.
+static void transform(benchmark::State& state, const string& path) {
+  auto* src = isolate_root(path);
+  if (src == nullptr) {
+    state.SkipWithError("Unable to parse benchmark");
+    return;
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto* md = src->clone();
+    ModuleInfo(md).invalidate();
+    PassManager pm;
+    Module::add_transforms(pm, true);
+    state.ResumeTiming();
+
+    pm.run(md);
+
+    state.PauseTiming();
+    delete md;
+    state.ResumeTiming();
+  }
+  delete src;
+}
+
+static void BM_Compile_Array(benchmark::State& state) {
+  transform(state, "share/cascade/test/benchmark/array/run_7.v");
+}
+BENCHMARK(BM_Compile_Array)->Unit(benchmark::kMillisecond);
+
+static void BM_Compile_Bitcoin(benchmark::State& state) {
+  transform(state, "share/cascade/test/benchmark/bitcoin/run_25.v");
+}
+BENCHMARK(BM_Compile_Bitcoin)->Unit(benchmark::kMillisecond);
+
+static void BM_Compile_Mips32(benchmark::State& state) {
+  transform(state, "share/cascade/test/benchmark/mips32/run_bubble_128_1024.v");
+}
+BENCHMARK(BM_Compile_Mips32)->Unit(benchmark::kMillisecond);
+
+static void BM_Compile_Regex(benchmark::State& state) {
+  transform(state, "share/cascade/test/benchmark/regex/run_disjunct_64.v");
+}
+BENCHMARK(BM_Compile_Regex)->Unit(benchmark::kMillisecond);
+
+static void BM_Compile_Nw(benchmark::State& state) {
+  transform(state, "share/cascade/test/benchmark/nw/run_8.v");
+}
+BENCHMARK(BM_Compile_Nw)->Unit(benchmark::kMillisecond);
+
+static void BM_Remote_Clients(benchmark::State& state) {
+  // A single slave is shared by every run of this benchmark. It's started
+  // outside of the timing loop so that only client traffic is measured.
+  static CascadeSlave* slave = nullptr;
+  if (slave == nullptr) {
+    slave = new CascadeSlave();
+    slave->set_listeners("/tmp/fpga_socket", 8800);
+    slave->run();
+  }
+  for (auto _ : state) {
+    run_concurrent("regression/concurrent", "share/cascade/test/benchmark/regex/run_disjunct_1.v", "424", false, state.range(0));
+  }
+}
+BENCHMARK(BM_Remote_Clients)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static State* make_state(size_t width, size_t arity) {
+  Vector<Bits> bs;
+  bs.resize(arity);
+  for (size_t i = 0; i < arity; ++i) {
+    bs[i] = Bits(width, static_cast<uint32_t>(i));
+  }
+  auto* s = new State();
+  s->insert(0, bs);
+  return s;
+}
+
+static void BM_Serialize_State(benchmark::State& state) {
+  auto* s = make_state(state.range(0), state.range(1));
+  for (auto _ : state) {
+    stringstream ss;
+    s->serialize(ss);
+    benchmark::DoNotOptimize(ss);
+  }
+  delete s;
+}
+BENCHMARK(BM_Serialize_State)->Args({8, 1 << 15})->Args({32, 1 << 15})->Args({128, 1 << 14});
+
+static void BM_Deserialize_State(benchmark::State& state) {
+  auto* s = make_state(state.range(0), state.range(1));
+  stringstream ss;
+  s->serialize(ss);
+  const auto data = ss.str();
+  delete s;
+  for (auto _ : state) {
+    stringstream ss(data);
+    State s2;
+    s2.deserialize(ss);
+    benchmark::DoNotOptimize(s2);
+  }
+}
+BENCHMARK(BM_Deserialize_State)->Args({8, 1 << 15})->Args({32, 1 << 15})->Args({128, 1 << 14});
+
+static void BM_Serialize_State_Legacy(benchmark::State& state) {
+  auto* s = make_state(state.range(0), state.range(1));
+  for (auto _ : state) {
+    stringstream ss;
+    s->serialize_legacy(ss);
+    benchmark::DoNotOptimize(ss);
+  }
+  delete s;
+}
+BENCHMARK(BM_Serialize_State_Legacy)->Args({8, 1 << 15})->Args({32, 1 << 15})->Args({128, 1 << 14});
+
+static void BM_Deserialize_State_Legacy(benchmark::State& state) {
+  auto* s = make_state(state.range(0), state.range(1));
+  stringstream ss;
+  s->serialize_legacy(ss);
+  const auto data = ss.str();
+  delete s;
+  for (auto _ : state) {
+    stringstream ss(data);
+    State s2;
+    s2.deserialize(ss);
+    benchmark::DoNotOptimize(s2);
+  }
+}
+BENCHMARK(BM_Deserialize_State_Legacy)->Args({8, 1 << 15})->Args({32, 1 << 15})->Args({128, 1 << 14});
+
+static void BM_Serialize_Bits(benchmark::State& state) {
+  Bits b(state.range(0), static_cast<uint32_t>(0x5a5a5a5a));
+  for (auto _ : state) {
+    stringstream ss;
+    b.serialize(ss);
+    benchmark::DoNotOptimize(ss);
+  }
+}
+BENCHMARK(BM_Serialize_Bits)->Arg(64)->Arg(4096)->Arg(1 << 20);
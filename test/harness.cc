@@ -30,6 +30,8 @@
 
 #include "harness.h"
 
+#include <thread>
+#include <vector>
 #include "cl/cl.h"
 #include "common/system.h"
 #include "gtest/gtest.h"
@@ -51,11 +53,52 @@ auto& compiler_port = StrArg<uint32_t>::create("--compiler_port")
   .initial(9900);
 auto& compiler_fpga = StrArg<uint32_t>::create("--compiler_fpga")
   .initial(0);
+auto& profile = StrArg<uint32_t>::create("--profile")
+  .initial(0);
 
 } // namespace
 
 namespace cascade {
 
+size_t EventBuf::count(const string& s) {
+  lock_guard<recursive_mutex> lg(lock_);
+  return count_locked(s);
+}
+
+bool EventBuf::wait_for(const string& s, size_t n) {
+  unique_lock<recursive_mutex> ul(lock_);
+  while (count_locked(s) < n) {
+    if (count_locked("Finished logical simulation") > 0) {
+      return false;
+    }
+    cv_.wait(ul);
+  }
+  return true;
+}
+
+streamsize EventBuf::xsputn(const char_type* s, streamsize n) {
+  lock_guard<recursive_mutex> lg(lock_);
+  const auto res = stringbuf::xsputn(s, n);
+  cv_.notify_all();
+  return res;
+}
+
+EventBuf::int_type EventBuf::overflow(int_type c) {
+  lock_guard<recursive_mutex> lg(lock_);
+  const auto res = stringbuf::overflow(c);
+  cv_.notify_all();
+  return res;
+}
+
+size_t EventBuf::count_locked(const string& s) const {
+  const auto text = str();
+  size_t res = 0;
+  for (auto i = text.find(s); i != string::npos; i = text.find(s, i + s.length())) {
+    ++res;
+  }
+  return res;
+}
+
 void run_parse(const string& path, bool expected) {
   run_typecheck("regression/minimal", path, expected);
 }
@@ -99,14 +142,97 @@ void run_code(const string& march, const string& path, const string& expected, b
   EXPECT_EQ(sb->str(), expected);
 }
 
-void run_concurrent(const string& march, const string& path, const string& expected, bool omit_from_coverage) {
+void run_jit(const string& march, const string& path, const string& expected) {
+  auto* sb = new stringbuf();
+  auto* ib = new stringbuf();
+
+  Cascade c;
+  c.set_fopen_dirs(System::src_root());
+  c.set_stdout(sb);
+  c.set_stderr(cout.rdbuf());
+  c.set_stdinfo(ib);
+  c.run();
+
+  c << "`include \"share/cascade/march/" << march << ".v\"\n"
+    << "`include \"" << path << "\"" << endl;
+
+  c.stop_now();
+  ASSERT_FALSE(c.bad());
+
+  c.run();
+  c.wait_for_stop();
+  EXPECT_EQ(sb->str(), expected);
+  EXPECT_NE(ib->str().find("Finished pass 2 compilation"), string::npos);
+}
+
+void run_concurrent(const string& march, const string& path, const string& expected, bool omit_from_coverage, size_t clients) {
   if (::coverage && omit_from_coverage) {
     return;
   }
-  std::thread t1(run_code, march, path, expected, false);
-  std::thread t2(run_code, march, path, expected, false);
-  t1.join();
-  t2.join();
+  vector<thread> ts;
+  for (size_t i = 0; i < clients; ++i) {
+    ts.emplace_back(run_code, march, path, expected, false);
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+}
+
+void run_partition(const string& march, const string& path, const string& locs, const string& expected) {
+  auto* sb = new stringbuf();
+  auto* ib = new EventBuf();
+
+  Cascade c;
+  c.set_fopen_dirs(System::src_root());
+  c.set_stdout(sb);
+  c.set_stderr(cout.rdbuf());
+  c.set_stdinfo(ib);
+  c.set_enable_inlining(false);
+  c.set_partition_locs(locs);
+  c.set_partition_interval(1);
+  c.run();
+
+  c << "`include \"share/cascade/march/" << march << ".v\"\n"
+    << "`include \"" << path << "\"" << endl;
+
+  c.stop_now();
+  ASSERT_FALSE(c.bad());
+
+  // The program's own completion bounds the wait. If it finishes first, the
+  // migration never happened.
+  c.run();
+  const auto migrated = ib->wait_for("Finished migration");
+  c.wait_for_stop();
+  EXPECT_EQ(sb->str(), expected);
+  EXPECT_TRUE(migrated);
+  EXPECT_NE(ib->str().find("Repartitioned logic"), string::npos);
+}
+
+void run_migrate(const string& march, const string& path, const string& loc, const string& expected) {
+  auto* sb = new stringbuf();
+  auto* ib = new EventBuf();
+
+  Cascade c;
+  c.set_fopen_dirs(System::src_root());
+  c.set_stdout(sb);
+  c.set_stderr(cout.rdbuf());
+  c.set_stdinfo(ib);
+  c.run();
+
+  c << "`include \"share/cascade/march/" << march << ".v\"\n"
+    << "`include \"" << path << "\"" << endl;
+
+  c.stop_now();
+  ASSERT_FALSE(c.bad());
+
+  c.migrate(loc);
+  // The program's own completion bounds the wait. If it finishes first, the
+  // migration never happened.
+  c.run();
+  const auto migrated = ib->wait_for("Finished migration");
+  c.wait_for_stop();
+  EXPECT_EQ(sb->str(), expected);
+  EXPECT_TRUE(migrated);
 }
 
 void run_benchmark(const string& path, const string& expected) {
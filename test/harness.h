@@ -31,14 +31,43 @@
 #ifndef TEST_HARNESS_H
 #define TEST_HARNESS_H
 
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
 #include <string>
 
 namespace cascade {
 
+// A string buffer which lets a test block until a message has been written to
+// it, rather than sleeping and polling. Writes may come from any thread.
+class EventBuf : public std::stringbuf {
+  public:
+    // Returns the number of times s has been written so far
+    size_t count(const std::string& s);
+    // Blocks until s has been written at least n times, or until the program
+    // reports that it has finished. Returns true in the former case.
+    bool wait_for(const std::string& s, size_t n = 1);
+
+  protected:
+    std::streamsize xsputn(const char_type* s, std::streamsize n) override;
+    int_type overflow(int_type c) override;
+
+  private:
+    std::recursive_mutex lock_;
+    std::condition_variable_any cv_;
+
+    size_t count_locked(const std::string& s) const;
+};
+
 void run_parse(const std::string& path, bool expected);
 void run_typecheck(const std::string& march, const std::string& path, bool expected);
 void run_code(const std::string& march, const std::string& path, const std::string& expected, bool omit_from_coverage = false);
-void run_concurrent(const std::string& march, const std::string& path, const std::string& expected, bool omit_from_coverage = false);
+// Like run_code(), but also requires that the program finished its second jit
+// pass, that is, that it ran at least in part on its second target.
+void run_jit(const std::string& march, const std::string& path, const std::string& expected);
+void run_concurrent(const std::string& march, const std::string& path, const std::string& expected, bool omit_from_coverage = false, size_t clients = 2);
+void run_partition(const std::string& march, const std::string& path, const std::string& locs, const std::string& expected);
+void run_migrate(const std::string& march, const std::string& path, const std::string& loc, const std::string& expected);
 void run_benchmark(const std::string& path, const std::string& expected);
 
 } // namespace cascade
@@ -0,0 +1,164 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "include/cascade.h"
+#include "common/system.h"
+#include "gtest/gtest.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Runs a program to completion and returns what it wrote to stdout. Anything
+// it wrote to stderr is returned in err.
+string run_ckpt(const string& path, bool text, string& err) {
+  auto* sb = new stringbuf();
+  auto* eb = new stringbuf();
+
+  Cascade c;
+  c.set_fopen_dirs(System::src_root());
+  c.set_stdout(sb);
+  c.set_stderr(eb);
+  c.set_enable_text_checkpoints(text);
+  c.run();
+
+  c << "`include \"share/cascade/march/regression/minimal.v\"\n"
+    << "`include \"" << path << "\"" << endl;
+
+  c.stop_now();
+  EXPECT_FALSE(c.bad());
+
+  c.run();
+  c.wait_for_stop();
+  err = eb->str();
+  return sb->str();
+}
+
+void run_round_trip(bool text) {
+  ::remove("/tmp/cascade_count.ckpt");
+  string err;
+  EXPECT_EQ(run_ckpt("share/cascade/test/regression/ckpt/count_save.v", text, err), "");
+  EXPECT_EQ(err, "");
+  EXPECT_EQ(run_ckpt("share/cascade/test/regression/ckpt/count_restart.v", false, err), "1");
+  EXPECT_EQ(err, "");
+}
+
+void run_delta_chain(const string& march) {
+  const string path = "/tmp/cascade_lockstep.ckpt";
+  ::remove(path.c_str());
+  for (size_t i = 0; i < 16; ++i) {
+    ::remove((path + "." + to_string(i)).c_str());
+  }
+  { auto* sb = new stringbuf();
+
+    Cascade c;
+    c.set_fopen_dirs(System::src_root());
+    c.set_stdout(sb);
+    c.set_stderr(cout.rdbuf());
+    c.set_checkpoint_interval(1);
+    c.set_checkpoint_path(path);
+    c.run();
+
+    c << "`include \"share/cascade/march/regression/" << march << ".v\"\n"
+      << "`include \"share/cascade/test/regression/ckpt/lockstep.v\"" << endl;
+
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+
+    c.run();
+    this_thread::sleep_for(chrono::seconds(4));
+    c.stop_now();
+    EXPECT_EQ(sb->str(), "");
+  }
+
+  // The chain begins with a full checkpoint and continues with incremental
+  // ones. Restoring it has to apply all of them in order.
+  EXPECT_TRUE(ifstream(path + ".0").good());
+  EXPECT_TRUE(ifstream(path + ".1").good());
+  string err;
+  EXPECT_EQ(run_ckpt("share/cascade/test/regression/ckpt/lockstep_restart.v", false, err), "1");
+  EXPECT_EQ(err, "");
+}
+
+} // namespace
+
+TEST(ckpt, binary_round_trip) {
+  run_round_trip(false);
+}
+TEST(ckpt, text_round_trip) {
+  run_round_trip(true);
+}
+TEST(ckpt, empty_file) {
+  { ofstream ofs("/tmp/cascade_count.ckpt", ios::binary);
+  }
+  string err;
+  EXPECT_EQ(run_ckpt("share/cascade/test/regression/ckpt/count_restart.v", false, err), "");
+  EXPECT_NE(err.find("Unable to open save file"), string::npos);
+}
+TEST(ckpt, corrupt_file) {
+  // A well-formed header and trailer, but an index entry whose state section
+  // runs far past the end of the file. This mirrors the layout in module.cc.
+  const char magic[8] = {'C', 'A', 'S', 'C', 'K', 'P', 'T', '\0'};
+  const uint32_t header[2] = {1, 0};
+  const uint32_t entry_ids[2] = {0, 0};
+  const uint64_t entry_secs[4] = {16, 0, 16, static_cast<uint64_t>(1) << 40};
+  const uint64_t index_off = 16;
+  const uint32_t trailer[2] = {1, 1};
+  { ofstream ofs("/tmp/cascade_count.ckpt", ios::binary);
+    ofs.write(magic, sizeof(magic));
+    ofs.write(reinterpret_cast<const char*>(header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(entry_ids), sizeof(entry_ids));
+    ofs.write(reinterpret_cast<const char*>(entry_secs), sizeof(entry_secs));
+    ofs.write(reinterpret_cast<const char*>(&index_off), sizeof(index_off));
+    ofs.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+  }
+
+  // The file is rejected and the program carries on from its initial state
+  string err;
+  EXPECT_EQ(run_ckpt("share/cascade/test/regression/ckpt/count_restart.v", false, err), "0");
+  EXPECT_NE(err.find("Save file is corrupt!"), string::npos);
+}
+TEST(ckpt, delta_chain) {
+  run_delta_chain("minimal");
+}
+TEST(ckpt, avalon_delta_chain) {
+  // Deltas on this target are built from the state mask that the device
+  // reports, rather than by software change tracking.
+  run_delta_chain("avalon32");
+}
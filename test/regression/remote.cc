@@ -28,13 +28,26 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include "include/cascade.h"
 #include "include/cascade_slave.h"
 #include "cl/cl.h"
+#include "common/system.h"
 #include "gtest/gtest.h"
 #include "test/harness.h"
 
 using namespace cascade;
 using namespace cascade::cl;
+using namespace std;
+
+namespace {
+
+CascadeSlave* slave_ = nullptr;
+
+} // namespace
 
 int main(int argc, char** argv) {
   Simple::read(argc, argv);
@@ -43,6 +56,10 @@ int main(int argc, char** argv) {
   CascadeSlave slave;
   slave.set_listeners("/tmp/fpga_socket", 8800);
   slave.run();
+  slave_ = &slave;
+  CascadeSlave slave2;
+  slave2.set_listeners("/tmp/fpga_socket_2", 8801);
+  slave2.run();
 
   return RUN_ALL_TESTS();
 }
@@ -78,3 +95,102 @@ TEST(many_to_one, regex) {
 TEST(many_to_one, array) {
   run_concurrent("regression/concurrent", "share/cascade/test/benchmark/array/run_5.v", "1048577\n", true);
 }
+TEST(many_to_one, many_clients) {
+  run_concurrent("regression/concurrent", "share/cascade/test/benchmark/regex/run_disjunct_1.v", "424", true, 8);
+}
+TEST(many_to_one, shared_device) {
+  run_concurrent("regression/concurrent_avalon32", "share/cascade/test/benchmark/mips32/run_bubble_32.v", "1", true);
+}
+
+TEST(migrate, unix_to_unix) {
+  run_migrate("regression/remote", "share/cascade/test/benchmark/bitcoin/run_12.v", "/tmp/fpga_socket_2", "00001314 00001398\n");
+}
+TEST(migrate, unix_to_tcp) {
+  run_migrate("regression/remote", "share/cascade/test/benchmark/mips32/run_bubble_128_1024.v", "localhost:8801", "1");
+}
+TEST(migrate, unix_to_local) {
+  run_migrate("regression/remote", "share/cascade/test/benchmark/regex/run_disjunct_1.v", "local", "424");
+}
+
+TEST(migrate, while_checkpointing) {
+  ::remove("/tmp/cascade_lockstep.ckpt");
+  { auto* sb = new stringbuf();
+    auto* ib = new EventBuf();
+
+    Cascade c;
+    c.set_fopen_dirs(System::src_root());
+    c.set_stdout(sb);
+    c.set_stderr(cout.rdbuf());
+    c.set_stdinfo(ib);
+    c.set_checkpoint_interval(1);
+    c.set_checkpoint_path("/tmp/cascade_lockstep.ckpt");
+    c.run();
+
+    c << "`include \"share/cascade/march/regression/minimal.v\"\n"
+      << "`include \"share/cascade/test/regression/ckpt/lockstep_bounded.v\"" << endl;
+
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+
+    // Take a few checkpoints, then keep taking them while the program moves to
+    // a remote slave and after it gets there. Every checkpoint saves the root
+    // module first, and the program finishes on its own after a fixed amount
+    // of logical time, which bounds each of these waits.
+    const string save = "<save> root\n";
+    c.run();
+    EXPECT_TRUE(ib->wait_for(save, 2));
+    c.migrate("/tmp/fpga_socket_2");
+    EXPECT_TRUE(ib->wait_for("Finished migration"));
+    EXPECT_TRUE(ib->wait_for(save, ib->count(save) + 2));
+    c.stop_now();
+    EXPECT_EQ(sb->str(), "");
+  }
+
+  // Restoring the chain must put the program back in a consistent state
+  run_code("regression/minimal", "share/cascade/test/regression/ckpt/lockstep_restart.v", "1");
+}
+
+TEST(partition, unix_to_unix) {
+  run_partition("regression/partition", "share/cascade/test/regression/partition/pairs_1.v", "/tmp/fpga_socket,/tmp/fpga_socket_2", "19999900000 19999900000");
+}
+TEST(partition, unix_to_tcp) {
+  run_partition("regression/partition", "share/cascade/test/regression/partition/pairs_2.v", "/tmp/fpga_socket,localhost:8801", "19999900000 19999900000");
+}
+
+TEST(pooled_sockets, reuse_and_release) {
+  const auto before = slave_->get_stats();
+  { auto* sb = new stringbuf();
+
+    Cascade c;
+    c.set_fopen_dirs(System::src_root());
+    c.set_stdout(sb);
+    c.set_stderr(cout.rdbuf());
+    c.set_enable_inlining(false);
+    c.run();
+
+    c << "`include \"share/cascade/march/regression/remote.v\"\n"
+      << "`include \"share/cascade/test/regression/simple/pipeline_1.v\"" << endl;
+
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+
+    c.run();
+    c.wait_for_stop();
+    EXPECT_EQ(sb->str(), "0123456789");
+
+    // Without inlining, every module in the pipeline is compiled separately.
+    // Every compilation after the first should have arrived on a pooled
+    // connection, and those connections stay open while the client does.
+    const auto after = slave_->get_stats();
+    EXPECT_GT(after.compiles, before.compiles+1);
+    EXPECT_GT(after.socket_hits, before.socket_hits);
+    EXPECT_GT(after.pooled_sockets, 0u);
+  }
+
+  // Destroying the client closes its pooled connections. The slave should
+  // notice and release its end of them.
+  for (size_t i = 0; (i < 100) && (slave_->get_stats().pooled_sockets > 0); ++i) {
+    this_thread::sleep_for(chrono::milliseconds(10));
+  }
+  EXPECT_EQ(slave_->get_stats().pooled_sockets, 0u);
+}
@@ -0,0 +1,220 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "common/fdstream.h"
+#include "common/shmring.h"
+#include "gtest/gtest.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Rings are too large to put on the stack. Value initialization zero-fills
+// them, which is a valid empty ring.
+unique_ptr<shmring[]> make_rings() {
+  return unique_ptr<shmring[]>(new shmring[2]());
+}
+
+string make_message(size_t n, char seed) {
+  string s(n, '\0');
+  for (size_t i = 0; i < n; ++i) {
+    s[i] = static_cast<char>(seed + i);
+  }
+  return s;
+}
+
+// Sends a message and flushes it, which is what delimits messages
+void send(fdstream& fs, const string& s) {
+  fs.write(s.data(), s.length());
+  fs.flush();
+}
+
+string recv(fdstream& fs, size_t n) {
+  string s(n, '\0');
+  fs.read(&s[0], n);
+  return s;
+}
+
+// Exchanges messages of several sizes in both directions between a reader
+// which polls its ring and a writer which doesn't. Messages larger than the
+// ring are sent inline, and must still arrive in order.
+void run_exchange(bool poll) {
+  int fds[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  auto rings = make_rings();
+  fdstream client(fds[0]);
+  fdstream server(fds[1]);
+  client.attach(&rings[1], &rings[0], poll);
+  server.attach(&rings[0], &rings[1]);
+
+  const vector<size_t> sizes = {1, 64, 4096, shmring::capacity + 1, 64, shmring::capacity - 4, 7};
+  thread t([&server, &sizes]{
+    for (auto n : sizes) {
+      const auto s = recv(server, n);
+      // Give a polling client a chance to give up and block
+      this_thread::sleep_for(chrono::milliseconds(1));
+      send(server, s);
+    }
+  });
+  for (size_t i = 0, ie = sizes.size(); i < ie; ++i) {
+    const auto s = make_message(sizes[i], static_cast<char>(i));
+    send(client, s);
+    EXPECT_EQ(recv(client, sizes[i]), s);
+  }
+  t.join();
+
+  EXPECT_EQ(rings[0].size(), 0u);
+  EXPECT_EQ(rings[1].size(), 0u);
+  EXPECT_EQ(rings[1].polled(), poll);
+  EXPECT_FALSE(rings[0].polled());
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+} // namespace
+
+TEST(shmring, empty) {
+  auto rings = make_rings();
+  EXPECT_EQ(rings[0].size(), 0u);
+  EXPECT_FALSE(rings[0].polled());
+  EXPECT_FALSE(rings[0].sleeping());
+}
+
+TEST(shmring, wraparound) {
+  // Messages whose sizes don't divide the capacity eventually straddle the
+  // end of the ring
+  auto rings = make_rings();
+  const size_t n = 65537;
+  for (size_t i = 0; i < 64; ++i) {
+    const auto s = make_message(n, static_cast<char>(i));
+    ASSERT_TRUE(rings[0].push(s.data(), n));
+    string t(n, '\0');
+    rings[0].pop(&t[0], n);
+    ASSERT_EQ(s, t);
+  }
+  EXPECT_EQ(rings[0].size(), 0u);
+}
+
+TEST(shmring, wraparound_record) {
+  // Records whose headers and payloads straddle the end of the ring
+  auto rings = make_rings();
+  const size_t n = 65531;
+  for (size_t i = 0; i < 64; ++i) {
+    const auto s = make_message(n, static_cast<char>(i));
+    ASSERT_TRUE(rings[0].push(static_cast<uint32_t>(i), s.data(), n));
+    uint32_t h = 0;
+    rings[0].pop((char*)&h, sizeof(h));
+    string t(n, '\0');
+    rings[0].pop(&t[0], n);
+    ASSERT_EQ(h, i);
+    ASSERT_EQ(s, t);
+  }
+}
+
+TEST(shmring, full) {
+  auto rings = make_rings();
+  const auto s = make_message(shmring::capacity, 0);
+  EXPECT_FALSE(rings[0].push(s.data(), shmring::capacity + 1));
+  EXPECT_EQ(rings[0].size(), 0u);
+  ASSERT_TRUE(rings[0].push(s.data(), shmring::capacity));
+  EXPECT_EQ(rings[0].size(), shmring::capacity);
+
+  // Nothing else fits, including an empty record
+  EXPECT_FALSE(rings[0].push(s.data(), 1));
+  EXPECT_FALSE(rings[0].push(0, nullptr, 0));
+
+  // Space is only reclaimed once it's been popped
+  string t(4, '\0');
+  rings[0].pop(&t[0], 4);
+  EXPECT_FALSE(rings[0].push(s.data(), 5));
+  EXPECT_TRUE(rings[0].push(0, nullptr, 0));
+  EXPECT_EQ(rings[0].size(), shmring::capacity);
+}
+
+TEST(shmsegment, create_and_attach) {
+  const auto name = "/cascade.test." + to_string(::getpid());
+  auto* c = shmsegment::create(name);
+  ASSERT_NE(c, nullptr);
+  // Names are exclusive
+  EXPECT_EQ(shmsegment::create(name), nullptr);
+  auto* a = shmsegment::attach(name);
+  ASSERT_NE(a, nullptr);
+
+  // Each end writes to the ring the other reads from
+  const auto s = make_message(16, 0);
+  ASSERT_TRUE(c->put()->push(s.data(), 16));
+  EXPECT_EQ(a->get()->size(), 16u);
+  EXPECT_EQ(c->get()->size(), 0u);
+  ASSERT_TRUE(a->put()->push(s.data(), 8));
+  EXPECT_EQ(c->get()->size(), 8u);
+
+  // Unlinking doesn't affect the ends which are already attached
+  c->unlink();
+  EXPECT_EQ(shmsegment::attach(name), nullptr);
+  EXPECT_EQ(a->get()->size(), 16u);
+
+  delete a;
+  delete c;
+}
+
+TEST(shmsegment, attach_failure) {
+  EXPECT_EQ(shmsegment::attach("/cascade.test.does_not_exist"), nullptr);
+  EXPECT_EQ(shmsegment::attach("no_leading_slash/is_invalid"), nullptr);
+}
+
+TEST(fdstream, unattached_shared_header) {
+  // A header which refers to a ring that this end hasn't attached to is an
+  // error, rather than a dereference of a null ring.
+  int fds[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  fdstream fs(fds[1]);
+  const uint32_t h = 0x80000000 | 16;
+  ASSERT_EQ(::send(fds[0], &h, sizeof(h), 0), static_cast<ssize_t>(sizeof(h)));
+  char c[16];
+  fs.read(c, 16);
+  EXPECT_FALSE(fs.good());
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(fdstream, announced) {
+  run_exchange(false);
+}
+
+TEST(fdstream, polled) {
+  run_exchange(true);
+}
@@ -147,6 +147,9 @@ TEST(simple, for_1) {
 TEST(simple, for_2) {
   run_code("regression/minimal","share/cascade/test/regression/simple/for_2.v", "012458");
 }
+TEST(simple, for_3) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/for_3.v", "523776");
+}
 TEST(simple, generate_1) {
   run_code("regression/minimal","share/cascade/test/regression/simple/generate_1.v", "01234567");
 }
@@ -243,6 +246,9 @@ TEST(simple, issue_195) {
 TEST(simple, issue_228) {
   run_code("regression/minimal","share/cascade/test/regression/simple/issue_228.v", "");
 }
+TEST(simple, latch_1) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/latch_1.v", "88");
+}
 TEST(simple, logical_and) {
   run_code("regression/minimal","share/cascade/test/regression/simple/logical_and.v", "011");
 }
@@ -276,6 +282,15 @@ TEST(simple, mem_1) {
 TEST(simple, mem_2) {
   run_code("regression/minimal","share/cascade/test/regression/simple/mem_2.v", "0001020304050607");
 }
+TEST(simple, mixed_trigger_1) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/mixed_trigger_1.v", "199998");
+}
+TEST(simple, multi_clock_1) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/multi_clock_1.v", "50000");
+}
+TEST(simple, multi_clock_2) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/multi_clock_2.v", "14");
+}
 TEST(simple, nested_1) {
   run_code("regression/minimal","share/cascade/test/regression/simple/nested_1.v", "8");
 }
@@ -351,6 +366,12 @@ TEST(simple, sign_2) {
 TEST(simple, string) {
   run_code("regression/minimal","share/cascade/test/regression/simple/string.v", "   Hello world is stored as 00000048656c6c6f20776f726c64\nHello world!!! is stored as 48656c6c6f20776f726c64212121\n");
 }
+TEST(simple, task_fifo_1) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/task_fifo_1.v", "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789");
+}
+TEST(simple, unroll_limit) {
+  run_code("regression/minimal","share/cascade/test/regression/simple/unroll_limit.v", "2553:1000");
+}
 TEST(simple, while_1) {
   run_code("regression/minimal","share/cascade/test/regression/simple/while_1.v", "333");
 }
@@ -0,0 +1,153 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <sstream>
+#include "common/bits.h"
+#include "gtest/gtest.h"
+#include "target/input.h"
+#include "target/state.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+State make_state() {
+  State s;
+  s.insert(1, Bits(true));
+
+  Vector<Bits> bs;
+  for (size_t i = 0; i < 16; ++i) {
+    bs.push_back(Bits(12, static_cast<uint32_t>(i*257)));
+  }
+  s.insert(2, bs);
+
+  Bits wide(128, static_cast<uint32_t>(0xdeadbeef));
+  wide.set(70, true);
+  wide.set(127, true);
+  wide.reinterpret_type(Bits::Type::SIGNED);
+  s.insert(3, wide);
+
+  s.insert(4, Bits(3.25));
+  return s;
+}
+
+Input make_input() {
+  Input i;
+  i.insert(1, Bits(false));
+  i.insert(2, Bits(33, static_cast<uint32_t>(0x12345678)));
+  i.insert(3, Bits(-1.5));
+  return i;
+}
+
+void expect_eq(const Bits& b1, const Bits& b2) {
+  EXPECT_EQ(b1.size(), b2.size());
+  EXPECT_EQ(b1.get_type(), b2.get_type());
+  EXPECT_TRUE(b1 == b2);
+}
+
+void expect_eq(const State& s1, const State& s2) {
+  for (const auto& s : s1) {
+    const auto itr = s2.find(s.first);
+    ASSERT_TRUE(itr != s2.end());
+    ASSERT_EQ(s.second.size(), itr->second.size());
+    for (size_t i = 0, ie = s.second.size(); i < ie; ++i) {
+      expect_eq(s.second[i], itr->second[i]);
+    }
+  }
+  EXPECT_EQ(distance(s1.begin(), s1.end()), distance(s2.begin(), s2.end()));
+}
+
+void expect_eq(const Input& i1, const Input& i2) {
+  for (const auto& i : i1) {
+    const auto itr = i2.find(i.first);
+    ASSERT_TRUE(itr != i2.end());
+    expect_eq(i.second, itr->second);
+  }
+  EXPECT_EQ(distance(i1.begin(), i1.end()), distance(i2.begin(), i2.end()));
+}
+
+} // namespace
+
+TEST(state, tagged_round_trip) {
+  const auto s1 = make_state();
+  stringstream ss;
+  const auto n = s1.serialize(ss);
+  EXPECT_EQ(n, ss.str().length());
+
+  State s2;
+  EXPECT_EQ(s2.deserialize(ss), n);
+  expect_eq(s1, s2);
+}
+TEST(state, legacy_round_trip) {
+  const auto s1 = make_state();
+  stringstream ss;
+  const auto n = s1.serialize_legacy(ss);
+  EXPECT_EQ(n, ss.str().length());
+
+  State s2;
+  EXPECT_EQ(s2.deserialize(ss), n);
+  expect_eq(s1, s2);
+}
+TEST(state, empty_round_trip) {
+  State s1;
+  stringstream ss1;
+  s1.serialize(ss1);
+  stringstream ss2;
+  s1.serialize_legacy(ss2);
+
+  State s2;
+  s2.deserialize(ss1);
+  expect_eq(s1, s2);
+  State s3;
+  s3.deserialize(ss2);
+  expect_eq(s1, s3);
+}
+TEST(input, tagged_round_trip) {
+  const auto i1 = make_input();
+  stringstream ss;
+  const auto n = i1.serialize(ss);
+  EXPECT_EQ(n, ss.str().length());
+
+  Input i2;
+  EXPECT_EQ(i2.deserialize(ss), n);
+  expect_eq(i1, i2);
+}
+TEST(input, legacy_round_trip) {
+  const auto i1 = make_input();
+  stringstream ss;
+  const auto n = i1.serialize_legacy(ss);
+  EXPECT_EQ(n, ss.str().length());
+
+  Input i2;
+  EXPECT_EQ(i2.deserialize(ss), n);
+  expect_eq(i1, i2);
+}
@@ -28,10 +28,48 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "common/system.h"
 #include "gtest/gtest.h"
+#include "include/cascade.h"
 #include "test/harness.h"
 
 using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Moves a memory into a verilator model and back out again through a
+// checkpoint. State moves by bursts, or one word at a time if bursts is
+// false, and both must deliver the same contents.
+void run_burst(const string& march, bool bursts) {
+  ::remove("/tmp/cascade_burst.ckpt");
+  { auto* sb = new stringbuf();
+
+    Cascade c;
+    c.set_fopen_dirs(System::src_root());
+    c.set_stdout(sb);
+    c.set_stderr(cout.rdbuf());
+    c.set_verilator_bursts(bursts);
+    c.run();
+
+    c << "`include \"share/cascade/march/" << march << ".v\"\n"
+      << "`include \"share/cascade/test/regression/ckpt/burst_save.v\"" << endl;
+
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+
+    c.run();
+    c.wait_for_stop();
+    EXPECT_EQ(sb->str(), "1");
+  }
+  run_code("regression/minimal", "share/cascade/test/regression/ckpt/burst_restart.v", "1");
+}
+
+} // namespace
 
 TEST(verilator32, array) {
   run_code("regression/verilator32", "share/cascade/test/benchmark/array/run_5.v", "1048577\n");
@@ -39,15 +77,40 @@ TEST(verilator32, array) {
 TEST(verilator32, bitcoin) {
   run_code("regression/verilator32", "share/cascade/test/benchmark/bitcoin/run_13.v", "00002d21 00002da5\n", true);
 }
+TEST(verilator32, latch_1) {
+  run_jit("regression/verilator32", "share/cascade/test/regression/jit/latch_1.v", "88");
+}
+TEST(verilator32, mixed_trigger_1) {
+  run_jit("regression/verilator32", "share/cascade/test/regression/jit/mixed_trigger_1.v", "199998");
+}
+TEST(verilator32, multi_clock_1) {
+  run_jit("regression/verilator32", "share/cascade/test/regression/jit/multi_clock_1.v", "50000");
+}
+TEST(verilator32, multi_clock_2) {
+  run_jit("regression/verilator32", "share/cascade/test/regression/jit/multi_clock_2.v", "14");
+}
 TEST(verilator32, mips32) {
   run_code("regression/verilator32", "share/cascade/test/benchmark/mips32/run_bubble_128.v", "1", true);
 }
+TEST(verilator32, open_loop_1) {
+  run_jit("regression/verilator32_led", "share/cascade/test/regression/jit/open_loop_1.v", "999999");
+}
 TEST(verilator32, nw) {
   run_code("regression/verilator32", "share/cascade/test/benchmark/nw/run_4.v", "-1126", true);
 }
 TEST(verilator32, regex) {
   run_code("regression/verilator32", "share/cascade/test/benchmark/regex/run_disjunct_1.v", "424");
 }
+TEST(verilator32, put_1) {
+  run_jit("regression/verilator32", "share/cascade/test/regression/jit/put_1.v", "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789");
+}
+
+TEST(verilator32, burst_state) {
+  run_burst("regression/verilator32", true);
+}
+TEST(verilator32, word_state) {
+  run_burst("regression/verilator32", false);
+}
 
 #if __x86_64__ || __ppc64__
 TEST(verilator64, array) {
@@ -56,13 +119,37 @@ TEST(verilator64, array) {
 TEST(verilator64, bitcoin) {
   run_code("regression/verilator64", "share/cascade/test/benchmark/bitcoin/run_13.v", "00002d21 00002da5\n", true);
 }
+TEST(verilator64, latch_1) {
+  run_jit("regression/verilator64", "share/cascade/test/regression/jit/latch_1.v", "88");
+}
+TEST(verilator64, mixed_trigger_1) {
+  run_jit("regression/verilator64", "share/cascade/test/regression/jit/mixed_trigger_1.v", "199998");
+}
+TEST(verilator64, multi_clock_1) {
+  run_jit("regression/verilator64", "share/cascade/test/regression/jit/multi_clock_1.v", "50000");
+}
+TEST(verilator64, multi_clock_2) {
+  run_jit("regression/verilator64", "share/cascade/test/regression/jit/multi_clock_2.v", "14");
+}
 TEST(verilator64, mips32) {
   run_code("regression/verilator64", "share/cascade/test/benchmark/mips32/run_bubble_128.v", "1", true);
 }
+TEST(verilator64, open_loop_1) {
+  run_jit("regression/verilator64_led", "share/cascade/test/regression/jit/open_loop_1.v", "999999");
+}
 TEST(verilator64, nw) {
   run_code("regression/verilator64", "share/cascade/test/benchmark/nw/run_4.v", "-1126", true);
 }
 TEST(verilator64, regex) {
   run_code("regression/verilator64", "share/cascade/test/benchmark/regex/run_disjunct_1.v", "424");
 }
+TEST(verilator64, put_1) {
+  run_jit("regression/verilator64", "share/cascade/test/regression/jit/put_1.v", "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789");
+}
+TEST(verilator64, burst_state) {
+  run_burst("regression/verilator64", true);
+}
+TEST(verilator64, word_state) {
+  run_burst("regression/verilator64", false);
+}
 #endif
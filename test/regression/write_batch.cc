@@ -0,0 +1,166 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/bits.h"
+#include "gtest/gtest.h"
+#include "target/compiler/write_batch.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+struct Entry {
+  VId id;
+  bool is_bool;
+  bool b;
+  Bits bits;
+};
+
+bool decode(const string& s, vector<Entry>& es) {
+  es.clear();
+  return WriteBatch::decode(s.data(), s.length(), [&es](VId id, auto v) {
+    Entry e;
+    e.id = id;
+    if constexpr (is_same<decltype(v), bool>::value) {
+      e.is_bool = true;
+      e.b = v;
+    } else {
+      e.is_bool = false;
+      e.bits = *v;
+    }
+    es.push_back(e);
+  });
+}
+
+void expect_eq(const Bits& b1, const Bits& b2) {
+  EXPECT_EQ(b1.size(), b2.size());
+  EXPECT_EQ(b1.get_type(), b2.get_type());
+  EXPECT_TRUE(b1 == b2);
+}
+
+} // namespace
+
+TEST(write_batch, empty) {
+  WriteBatch wb;
+  EXPECT_TRUE(wb.empty());
+  EXPECT_EQ(wb.size(), 0u);
+
+  vector<Entry> es;
+  EXPECT_TRUE(decode(wb.data(), es));
+  EXPECT_TRUE(es.empty());
+}
+
+TEST(write_batch, bools) {
+  WriteBatch wb;
+  wb.push_back(1, true);
+  wb.push_back(2, false);
+  wb.push_back(1000, true);
+  EXPECT_EQ(wb.size(), 3u);
+  // One byte each for the first two ids and headers, two for the last id
+  EXPECT_EQ(wb.data().length(), 7u);
+
+  vector<Entry> es;
+  ASSERT_TRUE(decode(wb.data(), es));
+  ASSERT_EQ(es.size(), 3u);
+  EXPECT_EQ(es[0].id, 1u);
+  EXPECT_TRUE(es[0].is_bool && es[0].b);
+  EXPECT_EQ(es[1].id, 2u);
+  EXPECT_TRUE(es[1].is_bool && !es[1].b);
+  EXPECT_EQ(es[2].id, 1000u);
+  EXPECT_TRUE(es[2].is_bool && es[2].b);
+}
+
+TEST(write_batch, widths) {
+  Bits narrow(5, static_cast<uint32_t>(0x15));
+  Bits word(64, static_cast<uint32_t>(0x89abcdef));
+  word.set(63, true);
+  word.set(40, true);
+  Bits wide(130, static_cast<uint32_t>(0xdeadbeef));
+  wide.set(129, true);
+  wide.set(64, true);
+
+  WriteBatch wb;
+  wb.push_back(3, &narrow);
+  wb.push_back(4, &word);
+  wb.push_back(70000, &wide);
+  EXPECT_EQ(wb.size(), 3u);
+
+  vector<Entry> es;
+  ASSERT_TRUE(decode(wb.data(), es));
+  ASSERT_EQ(es.size(), 3u);
+  EXPECT_EQ(es[0].id, 3u);
+  EXPECT_FALSE(es[0].is_bool);
+  expect_eq(es[0].bits, narrow);
+  EXPECT_EQ(es[1].id, 4u);
+  EXPECT_FALSE(es[1].is_bool);
+  expect_eq(es[1].bits, word);
+  EXPECT_EQ(es[2].id, 70000u);
+  EXPECT_FALSE(es[2].is_bool);
+  expect_eq(es[2].bits, wide);
+}
+
+TEST(write_batch, types) {
+  Bits s(12, static_cast<uint32_t>(0xfff));
+  s.reinterpret_type(Bits::Type::SIGNED);
+  Bits r(-2.5);
+
+  WriteBatch wb;
+  wb.push_back(1, &s);
+  wb.push_back(2, true);
+  wb.push_back(3, &r);
+
+  vector<Entry> es;
+  ASSERT_TRUE(decode(wb.data(), es));
+  ASSERT_EQ(es.size(), 3u);
+  expect_eq(es[0].bits, s);
+  EXPECT_TRUE(es[0].bits.is_signed());
+  EXPECT_TRUE(es[1].is_bool && es[1].b);
+  expect_eq(es[2].bits, r);
+}
+
+TEST(write_batch, malformed) {
+  Bits b(32, static_cast<uint32_t>(0x12345678));
+  WriteBatch wb;
+  wb.push_back(200, &b);
+  const auto& d = wb.data();
+
+  vector<Entry> es;
+  // Truncated value
+  EXPECT_FALSE(decode(d.substr(0, d.length()-1), es));
+  // Truncated header
+  EXPECT_FALSE(decode(d.substr(0, 2), es));
+  // Truncated id
+  EXPECT_FALSE(decode(d.substr(0, 1), es));
+  // A varint which never terminates
+  EXPECT_FALSE(decode(string(11, '\xff'), es));
+}
@@ -71,11 +71,19 @@ auto& compiler_fpga = StrArg<uint32_t>::create("--compiler_fpga")
   .usage("<fpga>")
   .description("Index of target FPGA for deployment")
   .initial(0);
+auto& partition_locs = StrArg<string>::create("--partition")
+  .usage("<loc1,loc2,...>")
+  .description("Comma-separated list of cascade_slave locations (path or host:port) to automatically distribute logic across; modules which are inlined are treated as part of root")
+  .initial("");
+auto& partition_interval = StrArg<size_t>::create("--partition_interval")
+  .usage("<n>")
+  .description("Number of seconds to wait between attempts to improve the placement of logic; only effective with --partition")
+  .initial(10);
 
 __attribute__((unused)) auto& g3 = Group::create("Logging Options");
 auto& profile = StrArg<int>::create("--profile")
   .usage("<n>")
-  .description("Number of seconds to wait between profiling events; setting n to zero disables profiling; only effective with --enable_info")
+  .description("Number of seconds to wait between profiling events; setting n to zero disables profiling; also reports per-transform compilation statistics; only effective with --enable_info")
   .initial(0);
 auto& enable_info = FlagArg::create("--enable_info")
   .description("Turn on info messages");
@@ -93,11 +101,27 @@ auto& open_loop_target = StrArg<size_t>::create("--open_loop_target")
   .usage("<n>")
   .description("Maximum number of seconds to run in open loop for before transferring control back to runtime")
   .initial(1);
+auto& verilator_threads = StrArg<size_t>::create("--verilator_threads")
+  .usage("<n>")
+  .description("Number of threads to use when simulating modules on verilator backends; only worthwhile for large modules")
+  .initial(1);
 
 __attribute__((unused)) auto& g5 = Group::create("REPL Options");
 auto& disable_repl = FlagArg::create("--disable_repl")
   .description("Disables the REPL and treats user input as stdin");
 
+__attribute__((unused)) auto& g6 = Group::create("Checkpoint Options");
+auto& enable_text_checkpoints = FlagArg::create("--enable_text_checkpoints")
+  .description("Causes $save() to write a human-readable checkpoint rather than a binary one; $restart() accepts either");
+auto& checkpoint_interval = StrArg<size_t>::create("--checkpoint_interval")
+  .usage("<n>")
+  .description("Number of seconds to wait between periodic checkpoints; setting n to zero disables periodic checkpoints")
+  .initial(0);
+auto& checkpoint_path = StrArg<string>::create("--checkpoint_path")
+  .usage("<path>")
+  .description("Location of periodic checkpoints; $restart(<path>) restores the most recent one")
+  .initial("cascade.ckpt");
+
 class inbuf : public streambuf {
   public:
     inbuf(streambuf* sb) : streambuf() { 
@@ -207,7 +231,13 @@ int main(int argc, char** argv) {
   ::cascade_->set_open_loop_target(::open_loop_target.value());
   ::cascade_->set_quartus_server(::compiler_host.value(), ::compiler_port.value());
   ::cascade_->set_vivado_server(::compiler_host.value(), ::compiler_port.value(), ::compiler_fpga.value());
+  ::cascade_->set_verilator_threads(::verilator_threads.value());
   ::cascade_->set_profile_interval(::profile.value());
+  ::cascade_->set_enable_text_checkpoints(::enable_text_checkpoints.value());
+  ::cascade_->set_checkpoint_interval(::checkpoint_interval.value());
+  ::cascade_->set_checkpoint_path(::checkpoint_path.value());
+  ::cascade_->set_partition_locs(::partition_locs.value());
+  ::cascade_->set_partition_interval(::partition_interval.value());
 
   // Map standard streams to colored outbufs
   if (::disable_repl.value()) {
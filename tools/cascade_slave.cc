@@ -48,6 +48,16 @@ auto& slave_path = StrArg<string>::create("--slave_path")
   .usage("<path/to/socket>")
   .description("Path to listen for slave_connections on")
   .initial("/tmp/fpga_socket");
+auto& num_workers = StrArg<size_t>::create("--num_workers")
+  .usage("<int>")
+  .description("Number of worker threads to keep ready for compilation requests")
+  .initial(8);
+auto& num_dispatchers = StrArg<size_t>::create("--num_dispatchers")
+  .usage("<int>")
+  .description("Number of threads to handle requests from connected clients on")
+  .initial(4);
+auto& print_stats = FlagArg::create("--print_stats")
+  .description("Print engine startup statistics before exiting");
 
 __attribute__((unused)) auto& g2 = Group::create("Compiler Server Options");
 auto& compiler_host = StrArg<string>::create("--compiler_host")
@@ -98,8 +108,22 @@ int main(int argc, char** argv) {
   slave_.set_listeners(::slave_path.value(), ::slave_port.value());
   slave_.set_quartus_server(::compiler_host.value(), ::compiler_port.value());
   slave_.set_vivado_server(::compiler_host.value(), ::compiler_port.value(), ::compiler_fpga.value());
+  slave_.set_num_workers(::num_workers.value());
+  slave_.set_num_dispatchers(::num_dispatchers.value());
   slave_.run();
   slave_.wait_for_stop();
+
+  if (::print_stats.value()) {
+    const auto stats = slave_.get_stats();
+    const auto pct = [](size_t n, size_t d) { return (d == 0) ? 0.0 : (100.0 * n / d); };
+    cout << "Sessions: " << stats.sessions << endl;
+    cout << "Compilations: " << stats.compiles << endl;
+    cout << "Socket Hit Rate: " << pct(stats.socket_hits, stats.compiles) << "%" << endl;
+    cout << "Mean Queueing Delay: " << stats.mean_queue_ms << " ms" << endl;
+    cout << "Max Queueing Delay: " << stats.max_queue_ms << " ms" << endl;
+    cout << "Mean Time to First Cycle: " << stats.mean_first_cycle_ms << " ms" << endl;
+    cout << "Max Time to First Cycle: " << stats.max_first_cycle_ms << " ms" << endl;
+  }
   cout << "Goodbye!" << endl;
 
   return 0;